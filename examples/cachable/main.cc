@@ -7,7 +7,6 @@
 #include <cstdlib>
 #include <functional>
 #include <algorithm>
-#include <iterator>
 
 #include <herdstat/cachable.hh>
 #include <herdstat/util/file.hh>
@@ -15,6 +14,11 @@
 #include <herdstat/util/algorithm.hh>
 #include <herdstat/util/functional.hh>
 #include <herdstat/util/container_base.hh>
+#include <herdstat/io/serialize.hh>
+
+/* identifies (and versions) our cache file */
+static const uint32_t cache_magic = 0x4d444c53; /* "MDLS" */
+static const uint32_t cache_version = 1;
 
 class MetadataList : public herdstat::Cachable,
 		     public herdstat::util::VectorBase<std::string>
@@ -67,25 +71,33 @@ MetadataList::fill()
 void
 MetadataList::load()
 {
-	std::ifstream stream(this->path().c_str());
+	/* fails if the file isn't ours, is of another version, or is
+	 * corrupt */
+	herdstat::io::BinaryIStream stream(this->path(),
+		cache_magic, cache_version);
+
+	/* we're a VectorBase, so load (and dump) as one */
+	herdstat::io::deserialize<
+		herdstat::util::VectorBase<std::string> >(stream, *this);
+
 	if (not stream)
 		throw herdstat::FileException(this->path());
-
-	this->insert(this->end(),
-		std::istream_iterator<std::string>(stream),
-		std::istream_iterator<std::string>());
 }
 
 void
 MetadataList::dump()
 {
-	std::ofstream stream(this->path().c_str());
+	herdstat::io::BinaryOStream stream(this->path(),
+		cache_magic, cache_version);
 	if (not stream)
 		throw herdstat::FileException(this->path());
 
 	std::sort(this->begin(), this->end());
-	std::copy(this->begin(), this->end(),
-		std::ostream_iterator<std::string>(stream, "\n"));
+	herdstat::io::serialize<
+		herdstat::util::VectorBase<std::string> >(stream, *this);
+
+	if (not stream.close())
+		throw herdstat::FileException(this->path());
 }
 
 int
@@ -99,18 +111,18 @@ main(int argc, char **argv)
 
 	try
 	{
-		MetadataList m("metadata_list.txt", argv[1]);	
+		MetadataList m("metadata_list.bin", argv[1]);	
 
 		/* if cache is valid, load it */
 		if (m.valid())
 		{
-			std::cout << "metadata_list.txt exists... loading it."
+			std::cout << "metadata_list.bin exists... loading it."
 				<< std::endl;
 
 			/* load cache */
 			m.load();
 
-			std::cout << "Successfully loaded metadata_list.txt."
+			std::cout << "Successfully loaded metadata_list.bin."
 				<< std::endl;
 			std::cout << "Number of metadata.xml's in " << argv[1]
 				<< ": " << m.size() << std::endl;
@@ -131,7 +143,7 @@ main(int argc, char **argv)
 			/* dump container contents to disk */
 			m.dump();
 			
-			std::cout << "Dumped list to metadata_list.txt." << std::endl;
+			std::cout << "Dumped list to metadata_list.bin." << std::endl;
 		}
 	}
 	catch (const herdstat::BaseException& e)
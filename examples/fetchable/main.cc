@@ -4,48 +4,66 @@
 
 #include <iostream>
 #include <cstdlib>
+#include <vector>
 #include <herdstat/xml/init.hh>
 #include "rss_feed.hh"
 
 int
 main(int argc, char **argv)
 {
-	if (argc != 2)
+	if (argc < 2)
 	{
-		std::cerr << "usage: feed_reader <url>" << std::endl;
+		std::cerr << "usage: feed_reader <url>..." << std::endl;
 		return EXIT_FAILURE;
 	}
 
 	/// initialize underlying libxml2 things
 	herdstat::xml::GlobalInit();
 
-	try
+	/// start fetching all feeds at once...
+	std::vector<RSSFeed *> feeds;
+	std::vector<herdstat::FetchHandle> handles;
+	for (int i = 1 ; i < argc ; ++i)
 	{
-		RSSFeed feed(argv[1]);
-		feed.fetch();
-		feed.parse();
-		feed.display(std::cout);
+		feeds.push_back(new RSSFeed(argv[i]));
+		handles.push_back(feeds.back()->fetch_async());
 	}
-	catch (const herdstat::FetchException& e)
-	{
-		std::cerr << "Failed to fetch RSS feed: "
-			<< argv[1] << std::endl;
-		return EXIT_FAILURE;
-	}
-	catch (const herdstat::xml::ParserException& e)
-	{
-		std::cerr << "Error parsing RSS feed "
-			<< e.file() << ": " << e.error() << std::endl;
-		return EXIT_FAILURE;
-	}
-	catch (const herdstat::BaseException& e)
+
+	int result = EXIT_SUCCESS;
+
+	/// ...and display each as soon as it has been fetched
+	for (std::size_t i = 0 ; i < feeds.size() ; ++i)
 	{
-		std::cerr << "Oops!\n  * " << e.backtrace(":\n	* ")
-		    << e.what() << std::endl;
-		return EXIT_FAILURE;
+		try
+		{
+			handles[i].wait();
+			feeds[i]->parse();
+			feeds[i]->display(std::cout);
+		}
+		catch (const herdstat::FetchException& e)
+		{
+			std::cerr << "Failed to fetch RSS feed: "
+				<< argv[i+1] << std::endl;
+			result = EXIT_FAILURE;
+		}
+		catch (const herdstat::xml::ParserException& e)
+		{
+			std::cerr << "Error parsing RSS feed "
+				<< e.file() << ": " << e.error() << std::endl;
+			result = EXIT_FAILURE;
+		}
+		catch (const herdstat::BaseException& e)
+		{
+			std::cerr << "Oops!\n  * " << e.backtrace(":\n	* ")
+			    << e.what() << std::endl;
+			result = EXIT_FAILURE;
+		}
 	}
-	
-	return EXIT_SUCCESS;
+
+	for (std::size_t i = 0 ; i < feeds.size() ; ++i)
+		delete feeds[i];
+
+	return result;
 }
 
 /* vim: set tw=80 sw=8 ts=8 sts=8 fdm=marker noet : */
@@ -21,6 +21,8 @@ RSSFeed::RSSFeed(const std::string& url) throw()
 
 RSSFeed::~RSSFeed() throw()
 {
+	/* do_fetch() may still be running in the background */
+	this->wait_fetch();
 }
 
 void
@@ -65,22 +67,41 @@ RSSFeed::display(std::ostream& stream) const
 		std::bind2nd(DisplayRSSFeedEntry(), &stream));
 }
 
+const herdstat::xml::ElementTable&
+RSSFeed::elements() const
+{
+	static const herdstat::xml::ElementTableEntry entries[] = {
+		{ "title",		TITLE },
+		{ "description",	DESCRIPTION },
+		{ "dc:language",	LANGUAGE },
+		{ "dc:creator",		CREATOR },
+		{ "dc:date",		DATE },
+		{ "item",		ITEM },
+		{ "link",		LINK },
+		{ "dc:subject",		SUBJECT },
+		{ "content:encoded",	BODY }
+	};
+	static const herdstat::xml::ElementTable table(entries,
+		sizeof(entries) / sizeof(entries[0]));
+	return table;
+}
+
 bool
-RSSFeed::start_element(const std::string& name, const attrs_type& attrs)
+RSSFeed::start_element(herdstat::xml::element_id id, const attrs_type& attrs)
 {
 	/* ... */
 	return true;
 }
 
 bool
-RSSFeed::end_element(const std::string& name)
+RSSFeed::end_element(herdstat::xml::element_id id)
 {
 	/* ... */
 	return true;
 }
 
 bool
-RSSFeed::do_text(const std::string& str)
+RSSFeed::do_text(const herdstat::util::StringView& str)
 {
 	/* ... */
 	return true;
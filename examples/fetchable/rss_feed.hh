@@ -82,12 +82,17 @@ class RSSFeed : public herdstat::Fetchable,
 
                 ///@{
 		/// SAX2 callbacks
-		virtual bool start_element(const std::string&, const attrs_type&);
-		virtual bool end_element(const std::string&);
-		virtual bool do_text(const std::string&);
+		virtual const herdstat::xml::ElementTable& elements() const;
+		virtual bool start_element(herdstat::xml::element_id,
+					   const attrs_type&);
+		virtual bool end_element(herdstat::xml::element_id);
+		virtual bool do_text(const herdstat::util::StringView&);
 	        ///@}
 
 	private:
+		enum { TITLE = 1, DESCRIPTION, LANGUAGE, CREATOR, DATE, ITEM,
+		       LINK, SUBJECT, BODY };
+
 		const std::string _url;
 		std::vector<RSSFeedEntry> _entries;
 		std::string _desc;
@@ -44,8 +44,8 @@ namespace herdstat {
      *
      * Below is a simple example of using the Cachable base class.  Upon first
      * invocation, the below application caches the location of every
-     * metadata.xml in the specified PORTDIR in a file called metadata_list.txt.
-     * Upon subsequent invocations, it will simply load metadata_list.txt.
+     * metadata.xml in the specified PORTDIR in a file called metadata_list.bin.
+     * Upon subsequent invocations, it will simply load metadata_list.bin.
      *
      * @include cachable/main.cc
      */
@@ -25,15 +25,89 @@
 #endif
 
 #include <string>
+#include <new>
 #include <cerrno>
 #include <cstdarg>
+#include <pthread.h>
 #include <herdstat/exceptions.hh>
 
 namespace herdstat {
+/****************************************************************************
+ * Per-thread "contexts disabled" flag.
+ ****************************************************************************/
+static pthread_key_t backtrace_key;
+static pthread_once_t backtrace_once = PTHREAD_ONCE_INIT;
+
+static void
+backtrace_key_init()
+{
+    pthread_key_create(&backtrace_key, NULL);
+}
+/****************************************************************************
+ * Guards libebt's process-wide context list, which is modified by threads
+ * that record contexts and copied by every exception, in any thread.
+ ****************************************************************************/
+static pthread_mutex_t backtrace_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+class BacktraceLock
+{
+    public:
+        BacktraceLock() { pthread_mutex_lock(&backtrace_mutex); }
+        ~BacktraceLock() { pthread_mutex_unlock(&backtrace_mutex); }
+};
+/****************************************************************************
+ * A copy of the context list, taken with the list locked.  BaseException
+ * is copy-constructed from one rather than copying the list itself.
+ ****************************************************************************/
+class BacktraceSnapshot : public libebt::Backtraceable<ExceptionTag>
+{
+    public:
+        BacktraceSnapshot() : libebt::Backtraceable<ExceptionTag>() { }
+};
+
+static BacktraceSnapshot
+backtrace_snapshot()
+{
+    BacktraceLock lock;
+    return BacktraceSnapshot();
+}
+/****************************************************************************/
+BacktraceContext::BacktraceContext(const std::string& context) throw()
+    : _context(NULL)
+{
+    if (enabled())
+    {
+        BacktraceLock lock;
+        _context = new (_storage.buf) context_type(context);
+    }
+}
+/****************************************************************************/
+BacktraceContext::~BacktraceContext() throw()
+{
+    if (_context)
+    {
+        BacktraceLock lock;
+        _context->~context_type();
+    }
+}
+/****************************************************************************/
+void
+BacktraceContext::disable() throw()
+{
+    pthread_once(&backtrace_once, backtrace_key_init);
+    pthread_setspecific(backtrace_key, &backtrace_key);
+}
+/****************************************************************************/
+bool
+BacktraceContext::enabled() throw()
+{
+    pthread_once(&backtrace_once, backtrace_key_init);
+    return (pthread_getspecific(backtrace_key) == NULL);
+}
 /****************************************************************************/
 BaseException::BaseException() throw()
     : std::exception(),
-      libebt::Backtraceable<ExceptionTag>()
+      libebt::Backtraceable<ExceptionTag>(backtrace_snapshot())
 {
 }
 /****************************************************************************/
@@ -107,17 +181,17 @@ Exception::what() const throw()
 }
 /****************************************************************************/
 ErrnoException::ErrnoException() throw()
-    : Exception(), _code(errno)
+    : Exception(), _code(errno), _what()
 {
 }
 /****************************************************************************/
 ErrnoException::ErrnoException(const char *msg) throw()
-    : Exception(msg), _code(errno)
+    : Exception(msg), _code(errno), _what()
 {
 }
 /****************************************************************************/
 ErrnoException::ErrnoException(const std::string& msg) throw()
-    : Exception(msg), _code(errno)
+    : Exception(msg), _code(errno), _what()
 {
 }
 /****************************************************************************/
@@ -128,21 +202,22 @@ ErrnoException::~ErrnoException() throw()
 const char *
 ErrnoException::what() const throw()
 {
-    std::string s;
     std::string e(std::strerror(_code));
 
     if (this->message())
-        s.assign(this->message());
+        _what.assign(this->message());
+    else
+        _what.clear();
 
-    if (s.empty() and e.empty())
+    if (_what.empty() and e.empty())
         return "No error message.";
 
-    if (s.empty())
-        return e.c_str();
-    if (e.empty())
-        return s.c_str();
+    if (_what.empty())
+        _what.swap(e);
+    else if (not e.empty())
+        _what.append(": "+e);
 
-    return (s + ": " + e).c_str();
+    return _what.c_str();
 }
 /****************************************************************************/
 FileException::FileException() throw()
@@ -34,6 +34,7 @@
 
 #include <exception>
 #include <stdexcept>
+#include <string>
 #include <sys/types.h>
 #include <regex.h>
 #include <libebt/libebt.hh>
@@ -44,11 +45,51 @@ namespace herdstat {
     class ExceptionTag { };
 
     /**
-     * @typedef BacktraceContext
-     * @brief convenience typedef for backtrace contexts provided by libebt.
+     * @class BacktraceContext exceptions.hh herdstat/exceptions.hh
+     * @brief Wrapper around the backtrace contexts provided by libebt.
+     *
+     * libebt keeps a single, process-wide context stack, so contexts are
+     * only recorded by threads that haven't called disable() (which
+     * util::Thread does for every thread it starts).  In such threads,
+     * constructing a BacktraceContext is a no-op.  The stack is locked
+     * while contexts are pushed or popped and while an exception copies
+     * it, so exceptions can be thrown from any thread.
      */
 
-    typedef libebt::BacktraceContext<ExceptionTag> BacktraceContext;
+    class BacktraceContext
+    {
+        public:
+            /** Constructor.  Pushes @a context onto the context stack.
+             * @param context Context description.
+             */
+            explicit BacktraceContext(const std::string& context) throw();
+
+            /// Destructor.  Pops our context off of the context stack.
+            ~BacktraceContext() throw();
+
+            /// Stop recording contexts in the calling thread.
+            static void disable() throw();
+
+            /// Are contexts recorded in the calling thread?
+            static bool enabled() throw();
+
+        private:
+            typedef libebt::BacktraceContext<ExceptionTag> context_type;
+
+            /* not copyable */
+            BacktraceContext(const BacktraceContext&);
+            BacktraceContext& operator= (const BacktraceContext&);
+
+            context_type *_context;
+            /// Storage for _context, so no allocation is needed.
+            union
+            {
+                char buf[sizeof(context_type)];
+                long align_l;
+                double align_d;
+                void *align_p;
+            } _storage;
+    };
 
     /**
      * @class BaseException exceptions.hh herdstat/exceptions.hh
@@ -142,6 +183,8 @@ namespace herdstat {
 
         private:
             int _code;
+            /// Storage for the string returned by what().
+            mutable std::string _what;
     };
     
     /**
@@ -0,0 +1,266 @@
+/*
+ * libherdstat -- herdstat/fetchable.cc
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <iostream>
+#include <cstdlib>
+#include <herdstat/fetchable.hh>
+
+namespace herdstat {
+/****************************************************************************
+ * Runs do_fetch() in the background on behalf of fetch_async().
+ ****************************************************************************/
+class Fetchable::Task : public util::Thread
+{
+    public:
+        Task(const Fetchable& fetchable, const std::string& path)
+            : util::Thread(), _fetchable(fetchable), _path(path),
+              _done(false), _failed(false), _error() { }
+
+        virtual ~Task() throw() { }
+
+        /* only access these with the Fetchable's mutex locked */
+        bool done() const { return _done; }
+        bool failed() const { return _failed; }
+        const std::string& error() const { return _error; }
+
+    protected:
+        virtual void run()
+        {
+            bool failed = false;
+            std::string error;
+
+            try
+            {
+                _fetchable.do_fetch(_path);
+            }
+            catch (const BaseException& e)
+            {
+                failed = true;
+                if (e.what())
+                    error.assign(e.what());
+            }
+            catch (...)
+            {
+                failed = true;
+            }
+
+            util::MutexLock lock(_fetchable._mutex);
+            _done = true;
+            _failed = failed;
+            _error.swap(error);
+            _fetchable._cond.broadcast();
+        }
+
+    private:
+        const Fetchable& _fetchable;
+        const std::string _path;
+        bool _done;
+        bool _failed;
+        std::string _error;
+};
+/****************************************************************************/
+Fetchable::Fetchable() throw()
+    : _fetch(), _fetched(false), _fetching(false), _mutex(), _cond(),
+      _task(NULL), _error(), _failed(false)
+{
+}
+/****************************************************************************/
+Fetchable::~Fetchable()
+{
+    util::MutexLock lock(_mutex);
+
+    /* it's too late to wait by now, as the derived object do_fetch() is
+     * using is gone (see wait_fetch()) */
+    if (_fetching or (_task and not _task->done()))
+    {
+        std::cerr << "herdstat::Fetchable destroyed while fetching"
+            << std::endl;
+        std::abort();
+    }
+
+    /* finished, but nobody waited for it */
+    if (_task)
+    {
+        try
+        {
+            _task->join();
+        }
+        catch (const Exception&)
+        {
+        }
+
+        delete _task;
+    }
+}
+/****************************************************************************/
+void
+Fetchable::fetch(const std::string& path) const throw (FetchException)
+{
+    bool pending;
+
+    {
+        util::MutexLock lock(_mutex);
+
+        /* another thread is fetching in the foreground */
+        while (_fetching)
+            _cond.wait(_mutex);
+
+        if (_fetched and not _task)
+            return;
+        pending = (_task != NULL);
+        _fetching = not pending;
+    }
+
+    if (pending)
+    {
+        this->wait();
+        return;
+    }
+
+    try
+    {
+        this->do_fetch(path);
+    }
+    catch (const FetchException& e)
+    {
+        util::MutexLock lock(_mutex);
+        _fetching = false;
+        _failed = true;
+        _error.assign(e.what() ? e.what() : "");
+        _cond.broadcast();
+        throw;
+    }
+
+    util::MutexLock lock(_mutex);
+    _fetching = false;
+    _fetched = true;
+    _failed = false;
+    _error.clear();
+    _cond.broadcast();
+}
+/****************************************************************************/
+FetchHandle
+Fetchable::fetch_async(const std::string& path) const throw (FetchException)
+{
+    {
+        util::MutexLock lock(_mutex);
+        if (_fetched or _fetching or _task)
+            return FetchHandle(this);
+
+        _failed = false;
+        _error.clear();
+
+        _task = new Task(*this, path);
+        try
+        {
+            _task->start();
+            return FetchHandle(this);
+        }
+        catch (const ErrnoException&)
+        {
+            delete _task;
+            _task = NULL;
+        }
+    }
+
+    /* couldn't start a thread, so fetch in the foreground */
+    this->fetch(path);
+    return FetchHandle(this);
+}
+/****************************************************************************/
+bool
+Fetchable::fetched() const
+{
+    util::MutexLock lock(_mutex);
+    return _fetched;
+}
+/****************************************************************************/
+bool
+Fetchable::ready() const
+{
+    util::MutexLock lock(_mutex);
+    return (not _fetching and (not _task or _task->done()));
+}
+/****************************************************************************/
+void
+Fetchable::wait() const throw (FetchException)
+{
+    util::MutexLock lock(_mutex);
+
+    while (_fetching or (_task and not _task->done()))
+        _cond.wait(_mutex);
+
+    if (_task)
+    {
+        try
+        {
+            _task->join();
+            _failed = _task->failed();
+            _error = _task->error();
+        }
+        catch (const Exception& e)
+        {
+            _failed = true;
+            _error.assign(e.what());
+        }
+
+        _fetched = not _failed;
+        delete _task;
+        _task = NULL;
+    }
+
+    if (not _failed)
+        return;
+    if (_error.empty())
+        throw FetchException();
+
+    /* FetchException treats its message as a format string */
+    std::string msg;
+    std::string::const_iterator i;
+    for (i = _error.begin() ; i != _error.end() ; ++i)
+    {
+        msg.push_back(*i);
+        if (*i == '%')
+            msg.push_back('%');
+    }
+    throw FetchException(msg);
+}
+/****************************************************************************/
+void
+Fetchable::wait_fetch() const throw()
+{
+    try
+    {
+        this->wait();
+    }
+    catch (const FetchException&)
+    {
+    }
+}
+/****************************************************************************/
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -33,9 +33,47 @@
  */
 
 #include <herdstat/fetcher/fetcher.hh>
+#include <herdstat/util/thread.hh>
 
 namespace herdstat {
 
+    class Fetchable;
+
+    /**
+     * @class FetchHandle fetchable.hh herdstat/fetchable.hh
+     * @brief Refers to a fetch started with Fetchable::fetch_async().
+     *
+     * Handles are cheap to copy, and all copies refer to the same fetch.
+     * The fetch belongs to the Fetchable, which must outlive its handles.
+     */
+
+    class FetchHandle
+    {
+        public:
+            /// Default constructor (refers to no fetch).
+            FetchHandle() throw() : _fetchable(NULL) { }
+
+            /// Does this handle refer to a fetch?
+            bool valid() const { return (_fetchable != NULL); }
+
+            /** Has the fetch finished (so that wait() won't block)?
+             * @pre valid()
+             */
+            bool ready() const;
+
+            /** Wait for the fetch to finish.
+             * @pre valid()
+             * @exception FetchException if the fetch failed.
+             */
+            void wait() const throw (FetchException);
+
+        private:
+            friend class Fetchable;
+            explicit FetchHandle(const Fetchable *f) throw() : _fetchable(f) { }
+
+            const Fetchable *_fetchable;
+    };
+
     /**
      * @class Fetchable fetchable.hh herdstat/fetchable.hh
      * @brief Abstract base for fetchable things.
@@ -45,6 +83,23 @@ namespace herdstat {
      * uses the _fetch object (obtained via the fetcher() member function) to
      * fetch the needed file(s).
      *
+     * fetch() blocks until the fetch is complete.  fetch_async() instead
+     * runs do_fetch() in a new thread and returns a FetchHandle to wait for
+     * it with, so that several things can be fetched at once and each used
+     * as soon as it's ready.  Either way, do_fetch() never runs twice at
+     * once, and isn't called again once it has succeeded; other callers
+     * wait for the fetch in progress.
+     *
+     * do_fetch() may still be running in the background when the derived
+     * object is being destroyed, so derived destructors must call
+     * wait_fetch().  ~Fetchable() aborts the program if it finds a fetch
+     * still running.
+     *
+     * Note that the portage::DataSource's (portage::HerdsXML and friends)
+     * aren't Fetchable, so they can't be fetched this way.  Within the
+     * library, only portage::ProjectXML is, and portage::ProjectResolver
+     * already fetches those concurrently.
+     *
      * @section example Example
      *
      * Below is an example application that uses the Fetchable base class to
@@ -61,32 +116,48 @@ namespace herdstat {
      *
      * @include fetchable/main.cc
      *
-     * Defines main().
+     * Defines main(), which fetches all feeds given asynchronously.
      */
 
     class Fetchable
     {
         public:
             /// Destructor.
-            virtual ~Fetchable() { }
+            virtual ~Fetchable();
 
-            /** Fetch our file and save it to the specified path.
+            /** Fetch our file and save it to the specified path.  If an
+             * asynchronous fetch is in progress, wait for it instead.
              * @param path Path to file.
              * @exception FetchException
              */
-            inline void fetch(const std::string& path = "") const
+            void fetch(const std::string& path = "") const
+                throw (FetchException);
+
+            /** Start fetching our file in the background.  Nothing is
+             * started if we've already fetched (or are fetching).
+             * @param path Path to file.
+             * @returns handle to wait for the fetch with.
+             * @exception FetchException if no thread could be started and
+             * fetching in the foreground failed.
+             */
+            FetchHandle fetch_async(const std::string& path = "") const
                 throw (FetchException);
 
             /// Have we already fetch()'d?
-            bool fetched() const { return _fetched; }
+            bool fetched() const;
 
         protected:
             /// Default constructor.
-            Fetchable() throw() : _fetch(), _fetched(false) { }
+            Fetchable() throw();
 
             /// Return fetcher.
             const Fetcher& fetcher() const { return _fetch; }
 
+            /** Wait for a fetch in progress (if any) to finish, ignoring
+             * whether it failed.  For derived destructors.
+             */
+            void wait_fetch() const throw();
+
             /** Does the actual fetching.
              * @param path local path to save.
              * @exception FetchException
@@ -95,18 +166,33 @@ namespace herdstat {
                 throw (FetchException) = 0;
 
         private:
+            friend class FetchHandle;
+            class Task;
+            friend class Task;
+
+            /// Has the asynchronous fetch finished?
+            bool ready() const;
+            /// Wait for the asynchronous fetch (if any) to finish.
+            void wait() const throw (FetchException);
+
             mutable Fetcher _fetch;
             mutable bool _fetched;
+            /// is fetch() running do_fetch() (in the foreground)?
+            mutable bool _fetching;
+
+            mutable util::Mutex _mutex;
+            mutable util::Condition _cond;
+            /// asynchronous fetch (NULL if none is running).
+            mutable Task *_task;
+            /// why the asynchronous fetch failed (if it did).
+            mutable std::string _error;
+            mutable bool _failed;
     };
 
-    inline void
-    Fetchable::fetch(const std::string& path) const throw (FetchException)
-    {
-        if (_fetched)
-            return;
-        do_fetch(path);
-        _fetched = true;
-    }
+    inline bool FetchHandle::ready() const
+    { return _fetchable->ready(); }
+    inline void FetchHandle::wait() const throw (FetchException)
+    { _fetchable->wait(); }
 
 } // namespace herdstat
 
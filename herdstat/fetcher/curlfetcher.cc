@@ -27,18 +27,326 @@
 #ifdef HAVE_LIBCURL
 # include <cstdlib>
 # include <cstdio>
+# include <cstring>
+# include <strings.h>
+# include <cerrno>
 # include <cassert>
+# include <vector>
+# include <algorithm>
+# include <unistd.h>
+# include <pthread.h>
 # include <curl/curl.h>
+# include <herdstat/util/thread.hh>
 #endif
 
 #include <herdstat/fetcher/exceptions.hh>
+#include <herdstat/fetcher/output.hh>
 #include <herdstat/fetcher/curlfetcher.hh>
 
 namespace herdstat {
+#ifdef HAVE_LIBCURL
+/****************************************************************************
+ * curl_easy_init() calls curl_global_init() itself if needed, but that's not
+ * thread-safe, so make sure it's done exactly once before any fetching.
+ ****************************************************************************/
+static pthread_once_t curl_once = PTHREAD_ONCE_INIT;
+
+class CurlHandlePool;
+static CurlHandlePool *curl_pool = NULL;
+/****************************************************************************
+ * Process-wide pool of easy handles.  Every CurlFetcher (there's one per
+ * Fetcher, and so one per Fetchable) takes its handles from here, and all
+ * handles share one DNS cache, TLS session cache and connection cache, so
+ * consecutive fetches from the same host reuse an open connection rather
+ * than connecting (and handshaking) again.
+ ****************************************************************************/
+class CurlHandlePool
+{
+    public:
+        /// Maximum number of idle handles kept around.
+        static const std::size_t max_idle = 16;
+
+        CurlHandlePool() : _share(curl_share_init()), _mutex(), _idle()
+        {
+            if (not _share)
+                return;
+
+            curl_share_setopt(_share, CURLSHOPT_LOCKFUNC,
+                &CurlHandlePool::lock);
+            curl_share_setopt(_share, CURLSHOPT_UNLOCKFUNC,
+                &CurlHandlePool::unlock);
+            curl_share_setopt(_share, CURLSHOPT_USERDATA, this);
+            curl_share_setopt(_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            curl_share_setopt(_share, CURLSHOPT_SHARE,
+                CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900
+            curl_share_setopt(_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+        }
+
+        /// Get an idle handle or create a new one (NULL on failure).
+        CURL *acquire()
+        {
+            {
+                util::MutexLock lock(_mutex);
+                if (not _idle.empty())
+                {
+                    CURL *handle = _idle.back();
+                    _idle.pop_back();
+                    return handle;
+                }
+            }
+
+            CURL *handle = curl_easy_init();
+            if (handle and _share)
+                curl_easy_setopt(handle, CURLOPT_SHARE, _share);
+            return handle;
+        }
+
+        /// Give a handle back once its transfer is done.
+        void release(CURL *handle)
+        {
+            /* forget the previous transfer's options, but keep the share */
+            curl_easy_reset(handle);
+            if (_share)
+                curl_easy_setopt(handle, CURLOPT_SHARE, _share);
+
+            util::MutexLock lock(_mutex);
+            if (_idle.size() < max_idle)
+                _idle.push_back(handle);
+            else
+                curl_easy_cleanup(handle);
+        }
+
+    private:
+        static void lock(CURL *, curl_lock_data data, curl_lock_access,
+                         void *userp)
+        {
+            static_cast<CurlHandlePool *>(userp)->_locks[data].lock();
+        }
+
+        static void unlock(CURL *, curl_lock_data data, void *userp)
+        {
+            static_cast<CurlHandlePool *>(userp)->_locks[data].unlock();
+        }
+
+        CURLSH *_share;
+        util::Mutex _mutex;
+        /// One lock per kind of shared data.
+        util::Mutex _locks[CURL_LOCK_DATA_LAST];
+        std::vector<CURL *> _idle;
+};
+
+static void
+curl_init()
+{
+    curl_global_init(CURL_GLOBAL_ALL);
+
+    /* lives for as long as the process does */
+    curl_pool = new CurlHandlePool();
+}
+/****************************************************************************
+ * A single transfer.  The body goes through a FetchOutput, so a "304 Not
+ * Modified" response or a failure leaves the destination untouched.
+ ****************************************************************************/
+class CurlTransfer
+{
+    public:
+        CurlTransfer(FetchRequest& req, const FetcherOptions& opts)
+            : _req(req), _handle(curl_pool->acquire()), _out(req),
+              _headers(NULL), _validators()
+        {
+            if (not _handle)
+            {
+                _req.ok = false;
+                _req.error.assign("curl_easy_init() returned NULL");
+                return;
+            }
+
+            curl_easy_setopt(_handle, CURLOPT_URL, _req.url.c_str());
+            curl_easy_setopt(_handle, CURLOPT_WRITEFUNCTION,
+                &CurlTransfer::write);
+            curl_easy_setopt(_handle, CURLOPT_WRITEDATA, this);
+            curl_easy_setopt(_handle, CURLOPT_HEADERFUNCTION,
+                &CurlTransfer::header);
+            curl_easy_setopt(_handle, CURLOPT_HEADERDATA, this);
+            curl_easy_setopt(_handle, CURLOPT_NOPROGRESS, not opts.verbose());
+            curl_easy_setopt(_handle, CURLOPT_FAILONERROR, 1);
+            curl_easy_setopt(_handle, CURLOPT_FOLLOWLOCATION, 1L);
+            curl_easy_setopt(_handle, CURLOPT_MAXREDIRS, 5L);
+            /* ask for any encoding curl can decode (gzip, deflate) */
+#if LIBCURL_VERSION_NUM >= 0x071506
+            curl_easy_setopt(_handle, CURLOPT_ACCEPT_ENCODING, "");
+#else
+            curl_easy_setopt(_handle, CURLOPT_ENCODING, "");
+#endif
+            curl_easy_setopt(_handle, CURLOPT_VERBOSE, opts.debug());
+            curl_easy_setopt(_handle, CURLOPT_USERAGENT, PACKAGE);
+
+            /* make it conditional */
+            const Validators& v(_req.validators);
+            if (not v.etag.empty())
+                _headers = curl_slist_append(_headers,
+                    ("If-None-Match: "+v.etag).c_str());
+            if (not v.last_modified.empty())
+                _headers = curl_slist_append(_headers,
+                    ("If-Modified-Since: "+v.last_modified).c_str());
+            if (_headers)
+                curl_easy_setopt(_handle, CURLOPT_HTTPHEADER, _headers);
+        }
+
+        ~CurlTransfer()
+        {
+            if (_handle)
+                this->finish(CURLE_ABORTED_BY_CALLBACK);
+        }
+
+        /// Handle to perform (NULL if initialization failed).
+        CURL *handle() const { return _handle; }
+
+        /// Did opening or writing the destination file fail?
+        bool file_error() const { return (_out.error() != 0); }
+
+        /// Set the request's result and give the handle back.
+        void finish(CURLcode code)
+        {
+            long status = 0;
+            curl_easy_getinfo(_handle, CURLINFO_RESPONSE_CODE, &status);
+            this->time();
+
+            if (code == CURLE_OK and status == 304)
+            {
+                _req.ok = true;
+                _req.modified = false;
+                if (not _validators.empty())
+                    _req.validators = _validators;
+                _out.discard();
+            }
+            else if (code == CURLE_OK and _out.commit())
+            {
+                _req.ok = true;
+                _req.modified = true;
+                _req.validators = _validators;
+            }
+            else
+            {
+                const bool local = (_out.error() or _out.aborted());
+                _req.ok = false;
+                _req.transient = (not local and transient(code, status));
+                _req.error.assign(local ? _out.error_string() :
+                    std::string(curl_easy_strerror(code)));
+                _out.discard();
+            }
+
+            curl_pool->release(_handle);
+            _handle = NULL;
+            curl_slist_free_all(_headers);
+            _headers = NULL;
+        }
+
+    private:
+        /// Add the transfer's times and size to the request's timing.
+        void time()
+        {
+            /* each is in seconds since the start of the (final) transfer */
+            double lookup = 0, connect = 0, tls = 0, pretransfer = 0,
+                   start = 0, total = 0;
+            curl_easy_getinfo(_handle, CURLINFO_NAMELOOKUP_TIME, &lookup);
+            curl_easy_getinfo(_handle, CURLINFO_CONNECT_TIME, &connect);
+#if LIBCURL_VERSION_NUM >= 0x071300
+            curl_easy_getinfo(_handle, CURLINFO_APPCONNECT_TIME, &tls);
+#endif
+            curl_easy_getinfo(_handle, CURLINFO_PRETRANSFER_TIME, &pretransfer);
+            curl_easy_getinfo(_handle, CURLINFO_STARTTRANSFER_TIME, &start);
+            curl_easy_getinfo(_handle, CURLINFO_TOTAL_TIME, &total);
+#if LIBCURL_VERSION_NUM >= 0x073700
+            curl_off_t size = 0;
+            curl_easy_getinfo(_handle, CURLINFO_SIZE_DOWNLOAD_T, &size);
+#else
+            double size = 0;
+            curl_easy_getinfo(_handle, CURLINFO_SIZE_DOWNLOAD, &size);
+#endif
+
+            FetchTiming& t(_req.timing);
+            t.resolve += 1000 * lookup;
+            t.connect += 1000 * std::max(0.0, connect - lookup);
+            if (tls > 0)
+                t.tls += 1000 * std::max(0.0, tls - connect);
+            if (start > 0)
+            {
+                t.wait += 1000 * std::max(0.0, start - pretransfer);
+                t.transfer += 1000 * std::max(0.0, total - start);
+            }
+            t.total += 1000 * total;
+            t.bytes += static_cast<uint64_t>(size);
+        }
+
+        /// Might a transfer that failed this way succeed if retried?
+        static bool transient(CURLcode code, long status)
+        {
+            switch (code)
+            {
+                case CURLE_COULDNT_RESOLVE_HOST:
+                case CURLE_COULDNT_CONNECT:
+                case CURLE_OPERATION_TIMEDOUT:
+                case CURLE_PARTIAL_FILE:
+                case CURLE_GOT_NOTHING:
+                case CURLE_SEND_ERROR:
+                case CURLE_RECV_ERROR:
+                    return true;
+                case CURLE_HTTP_RETURNED_ERROR:
+                    return (status == 408 or status == 429 or status >= 500);
+                default:
+                    return false;
+            }
+        }
+
+        static size_t write(char *data, size_t size, size_t n, void *userp)
+        {
+            CurlTransfer *t = static_cast<CurlTransfer *>(userp);
+            return (t->_out.write(data, size * n) ? size * n : 0);
+        }
+
+        /// Header line's value (following the name and colon).
+        static std::string value(const std::string& line,
+                                 std::string::size_type pos)
+        {
+            pos = line.find_first_not_of(" \t", pos);
+            return (pos == std::string::npos ? "" : line.substr(pos));
+        }
+
+        static size_t header(char *data, size_t size, size_t n, void *userp)
+        {
+            CurlTransfer *t = static_cast<CurlTransfer *>(userp);
+            std::string line(data, size * n);
+            line.erase(line.find_last_not_of(" \t\r\n") + 1);
+
+            /* a new response (after a redirect or 100 Continue) */
+            if (line.compare(0, 5, "HTTP/") == 0)
+                t->_validators.clear();
+            else if (strncasecmp(line.c_str(), "ETag:", 5) == 0)
+                t->_validators.etag = value(line, 5);
+            else if (strncasecmp(line.c_str(), "Last-Modified:", 14) == 0)
+                t->_validators.last_modified = value(line, 14);
+
+            return size * n;
+        }
+
+        FetchRequest& _req;
+        CURL *_handle;
+        FetchOutput _out;
+        struct curl_slist *_headers;
+        /// Validators of the response.
+        Validators _validators;
+};
+#endif
 /****************************************************************************/
 CurlFetcher::CurlFetcher(const FetcherOptions& opts) throw()
     : FetcherImp(opts)
 {
+#ifdef HAVE_LIBCURL
+    pthread_once(&curl_once, curl_init);
+#endif
 }
 /****************************************************************************/
 CurlFetcher::~CurlFetcher() throw()
@@ -52,48 +360,104 @@ CurlFetcher::fetch(const std::string& url, const std::string& path) const
     BacktraceContext c("CurlFetcher::fetch("+url+", "+path+")");
 
 #ifdef HAVE_LIBCURL
-    FILE *fp = NULL;
-    bool result = true;
-
-    CURL *handle = curl_easy_init();
-    if (not handle)
+    FetchRequest req(url, path);
+    CurlTransfer t(req, options());
+    if (not t.handle())
         throw Exception("curl_easy_init() returned NULL.");
 
-    try
-    {
-        fp = std::fopen(path.c_str(), "w");
-        if (not fp)
-            throw FileException(path);
-
-        /* set curl options */
-        curl_easy_setopt(handle, CURLOPT_URL, url.c_str());
-        curl_easy_setopt(handle, CURLOPT_WRITEDATA, fp);
-        curl_easy_setopt(handle, CURLOPT_NOPROGRESS, not options().verbose());
-        curl_easy_setopt(handle, CURLOPT_FAILONERROR, 1);
-        curl_easy_setopt(handle, CURLOPT_VERBOSE, options().debug());
-        curl_easy_setopt(handle, CURLOPT_USERAGENT, PACKAGE);
-
-        if (curl_easy_perform(handle) != 0)
-            throw FetchException();
-    }
-    catch (const FileException& e)
+    t.finish(curl_easy_perform(t.handle()));
+    if (t.file_error())
+        throw FileException(path);
+
+    return req.ok;
+#else
+    return false;
+#endif
+}
+/****************************************************************************/
+void
+CurlFetcher::fetch_request(FetchRequest& request) const
+{
+    BacktraceContext c("CurlFetcher::fetch_request("+request.url+")");
+
+#ifdef HAVE_LIBCURL
+    CurlTransfer t(request, options());
+    if (t.handle())
+        t.finish(curl_easy_perform(t.handle()));
+#else
+    FetcherImp::fetch_request(request);
+#endif
+}
+/****************************************************************************/
+void
+CurlFetcher::fetch_all(FetchRequests& requests) const
+{
+    BacktraceContext c("CurlFetcher::fetch_all()");
+
+#ifdef HAVE_LIBCURL
+    CURLM *multi = curl_multi_init();
+    if (not multi)
     {
-        curl_easy_cleanup(handle);
-        throw e;
+        FetcherImp::fetch_all(requests);
+        return;
     }
-    catch (const FetchException)
+
+    const std::size_t max = options().max_parallel();
+    std::vector<CurlTransfer *> active;
+    FetchRequests::iterator next = requests.begin();
+
+    while (next != requests.end() or not active.empty())
     {
-        std::fclose(fp); fp = NULL;
-        unlink(path.c_str());
-        result = false;
-    }
+        /* start transfers until we hit the limit */
+        while (next != requests.end() and active.size() < max)
+        {
+            CurlTransfer *t = new CurlTransfer(*next++, options());
+            if (not t->handle())
+            {
+                delete t;
+                continue;
+            }
+
+            curl_multi_add_handle(multi, t->handle());
+            active.push_back(t);
+        }
+
+        if (active.empty())
+            break;
+
+        int running = 0;
+        curl_multi_perform(multi, &running);
+
+        /* collect finished transfers */
+        CURLMsg *msg;
+        int left = 0;
+        while ((msg = curl_multi_info_read(multi, &left)))
+        {
+            if (msg->msg != CURLMSG_DONE)
+                continue;
 
-    if (fp) std::fclose(fp);
-    curl_easy_cleanup(handle);
+            std::vector<CurlTransfer *>::iterator t;
+            for (t = active.begin() ; t != active.end() ; ++t)
+                if ((*t)->handle() == msg->easy_handle)
+                    break;
+            assert(t != active.end());
 
-    return result;
+            /* msg is invalid once the handle is removed */
+            const CURLcode code = msg->data.result;
+            curl_multi_remove_handle(multi, (*t)->handle());
+            (*t)->finish(code);
+            delete *t;
+            active.erase(t);
+        }
+
+        /* wait for activity if anything is still in progress */
+        if (running > 0)
+            curl_multi_wait(multi, NULL, 0, 1000, NULL);
+    }
+
+    curl_multi_cleanup(multi);
 #else
-    return false;
+    FetcherImp::fetch_all(requests);
 #endif
 }
 /****************************************************************************/
@@ -57,6 +57,18 @@ namespace herdstat {
                                const std::string& path) const
                 throw (FileException);
 
+            /** Fetch a single request, conditionally if it has validators.
+             * @param request Reference to request.
+             */
+            virtual void fetch_request(FetchRequest& request) const;
+
+            /** Fetch a batch of URLs concurrently (using curl's multi
+             * interface), running up to FetcherOptions::max_parallel()
+             * transfers at a time.
+             * @param requests Reference to requests.
+             */
+            virtual void fetch_all(FetchRequests& requests) const;
+
         private:
             /// Only FetcherImpMap can instantiate this class.
             friend class FetcherImpMap;
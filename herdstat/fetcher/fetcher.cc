@@ -25,9 +25,13 @@
 #endif
 
 #include <iostream>
+#include <fstream>
+#include <vector>
 #include <unistd.h>
+#include <utime.h>
 
 #include <herdstat/util/string.hh>
+#include <herdstat/util/file.hh>
 #include <herdstat/util/functional.hh>
 #include <herdstat/fetcher/fetcherimp.hh>
 #include <herdstat/fetcher/fetcher.hh>
@@ -35,18 +39,21 @@
 namespace herdstat {
 /****************************************************************************/
 Fetcher::Fetcher() throw()
-    : _opts(), _impmap(_opts), _copied_impmap(false)
+    : _opts(), _impmap(_opts), _copied_impmap(false),
+      _stats()
 {
 }
 /****************************************************************************/
 Fetcher::Fetcher(const FetcherImpMap& impmap, const FetcherOptions& opts)
     throw()
-    : _opts(opts), _impmap(impmap), _copied_impmap(true)
+    : _opts(opts), _impmap(impmap), _copied_impmap(true),
+      _stats()
 {
 }
 /****************************************************************************/
 Fetcher::Fetcher(const FetcherOptions& opts) throw()
-    : _opts(opts), _impmap(opts), _copied_impmap(false)
+    : _opts(opts), _impmap(opts), _copied_impmap(false),
+      _stats()
 {
 }
 /****************************************************************************/
@@ -54,13 +61,21 @@ Fetcher::Fetcher(const std::string& url,
                  const std::string& path,
                  const FetcherOptions& opts)
     throw (FileException, FetchException, UnimplementedFetchMethod)
-    : _opts(opts), _impmap(opts), _copied_impmap(false)
+    : _opts(opts), _impmap(opts), _copied_impmap(false),
+      _stats()
 {
     this->operator()(url, path);
 }
 /****************************************************************************/
 Fetcher::~Fetcher() throw()
 {
+    if (not _opts.stats_file().empty() and not _stats.empty())
+    {
+        std::ofstream stream(_opts.stats_file().c_str(), std::ios::app);
+        _stats.dump_json(stream);
+        stream << std::endl;
+    }
+
     /* only free _impmap memory if we created it */
     if (not _copied_impmap)
         std::for_each(_impmap.begin(), _impmap.end(),
@@ -86,15 +101,131 @@ Fetcher::operator()(const std::string& url, const std::string& path) const
 #endif
 
     /* make sure we have write access to the directory */
-    const char * const dir = util::dirname(path).c_str();
-    if (access(dir, W_OK) != 0)
+    const std::string dir(util::dirname(path));
+    if (access(dir.c_str(), W_OK) != 0)
         throw FileException(dir);
 
     if (_opts.verbose())
         std::cerr << "Fetching " << url << std::endl;
 
-    if (not imp->fetch(url, path))
+    FetchRequests requests(1, FetchRequest(url, path));
+    FetchRequest& req(requests.front());
+    this->prepare(req);
+    GlobalFetchScheduler().fetch(*imp, _opts, requests);
+    this->record(req);
+
+    if (not req.ok)
         throw FetchException();
+
+    this->finish(req);
+}
+/****************************************************************************/
+void
+Fetcher::operator()(FetchRequest& request) const
+    throw (UnimplementedFetchMethod)
+{
+    FetchRequests requests(1, request);
+    this->fetch_all(requests);
+    request = requests.front();
+}
+/****************************************************************************/
+void
+Fetcher::fetch_all(FetchRequests& requests) const
+    throw (UnimplementedFetchMethod)
+{
+    BacktraceContext c("herdstat::Fetcher::fetch_all()");
+    assert(not _opts.implementation().empty());
+
+    const FetcherImp * const imp = _impmap[_opts.implementation()];
+    if (not imp)
+        throw UnimplementedFetchMethod(_opts.implementation());
+
+    /* requests we have write access to the directory of, and their
+     * position in requests */
+    FetchRequests pending;
+    std::vector<FetchRequests::size_type> pos;
+
+    for (FetchRequests::size_type n = 0 ; n < requests.size() ; ++n)
+    {
+        FetchRequest& req(requests[n]);
+        req.ok = false;
+        req.error.clear();
+        req.timing = FetchTiming();
+
+        const std::string dir(util::dirname(req.path));
+        if (access(dir.c_str(), W_OK) != 0)
+        {
+            req.error.assign(FileException(dir).what());
+            this->record(req);
+            continue;
+        }
+
+        if (_opts.verbose())
+            std::cerr << "Fetching " << req.url << std::endl;
+
+        this->prepare(req);
+        pending.push_back(req);
+        pos.push_back(n);
+    }
+
+    if (pending.empty())
+        return;
+
+    GlobalFetchScheduler().fetch(*imp, _opts, pending);
+
+    for (FetchRequests::size_type n = 0 ; n < pending.size() ; ++n)
+    {
+        this->record(pending[n]);
+        this->finish(pending[n]);
+        requests[pos[n]] = pending[n];
+    }
+}
+/****************************************************************************/
+void
+Fetcher::prepare(FetchRequest& req) const
+{
+    req.ok = req.modified = req.transient = false;
+    req.validators.clear();
+    req.compress = _opts.compress();
+    req.timing = FetchTiming();
+
+    if (_opts.conditional() and util::is_file(req.path))
+        req.validators.load(req.path);
+}
+/****************************************************************************/
+void
+Fetcher::finish(const FetchRequest& req) const
+{
+    if (not req.ok)
+        return;
+
+    if (not req.modified)
+    {
+        /* keep it, but reset its age */
+        utime(req.path.c_str(), NULL);
+        return;
+    }
+
+    if (_opts.conditional())
+        req.validators.save(req.path);
+    else
+        Validators().save(req.path);
+}
+/****************************************************************************/
+void
+Fetcher::record(const FetchRequest& req) const
+{
+    _stats.record(req);
+
+    if (not _opts.verbose())
+        return;
+
+    const FetchTiming& t(req.timing);
+    std::cerr << util::sprintf("Fetched %s (%s): %lu bytes in %.1fms "
+        "(resolve %.1f, connect %.1f, tls %.1f, wait %.1f, transfer %.1f)",
+        req.url.c_str(), (req.ok ? (req.modified ? "ok" : "not modified") :
+        "failed"), static_cast<unsigned long>(t.bytes), t.total, t.resolve, t.connect, t.tls, t.wait,
+        t.transfer) << std::endl;
 }
 /****************************************************************************/
 } // namespace herdstat
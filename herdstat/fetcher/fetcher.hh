@@ -35,7 +35,10 @@
 #include <herdstat/noncopyable.hh>
 #include <herdstat/fetcher/exceptions.hh>
 #include <herdstat/fetcher/options.hh>
+#include <herdstat/fetcher/request.hh>
 #include <herdstat/fetcher/impmap.hh>
+#include <herdstat/fetcher/scheduler.hh>
+#include <herdstat/fetcher/stats.hh>
 
 namespace herdstat {
 
@@ -60,6 +63,25 @@ namespace herdstat {
      * FetcherImpMap class to provide a user-defined fetcher implementation.
      *
      * @include fetcherimp/main.cc
+     *
+     * Several URLs can be fetched at once with fetch_all().  The curl
+     * implementation runs up to FetcherOptions::max_parallel() transfers
+     * concurrently; others fetch one URL after another.
+     *
+     * Unless disabled with FetcherOptions::set_conditional(), re-fetching a
+     * file that already exists is conditional on it having changed (see
+     * Validators).  An unchanged file is kept and its mtime updated, so
+     * callers checking its age see it as fresh.  Only the curl and http
+     * implementations send conditional requests.
+     *
+     * All fetches go through the GlobalFetchScheduler(), which coalesces
+     * concurrent fetches of the same URL, retries transient failures and
+     * limits the number of transfers per host.  Its counters() cover every
+     * Fetcher in the process.
+     *
+     * Each Fetcher keeps the timing of its own fetches in its stats(), so
+     * that slow URLs (and where their time goes) can be found.  In verbose
+     * mode the timing of each fetch is printed once it's done.
      */
 
     class Fetcher : private Noncopyable
@@ -92,7 +114,9 @@ namespace herdstat {
                     const FetcherOptions& opts = FetcherOptions())
                 throw (FileException, FetchException, UnimplementedFetchMethod);
 
-            /// Destructor.
+            /** Destructor.  Appends our stats() to the
+             * FetcherOptions::stats_file() (if any).
+             */
             ~Fetcher() throw();
 
             /// Get const reference to options object.
@@ -100,6 +124,9 @@ namespace herdstat {
             /// Set options object.
             void set_options(const FetcherOptions& opts) { _opts = opts; }
 
+            /// Get const reference to the stats of our fetches.
+            const FetchStats& stats() const { return _stats; }
+
             /** Fetch url and save to path.
              * @param url URL string.
              * @param path Path to save to.
@@ -109,10 +136,34 @@ namespace herdstat {
                             const std::string& path) const
                 throw (FileException, FetchException, UnimplementedFetchMethod);
 
+            /** Fetch a single request.  As with fetch_all(), failure
+             * doesn't throw but is stored in the request.
+             * @param request Reference to request.
+             * @exception UnimplementedFetchMethod
+             */
+            void operator()(FetchRequest& request) const
+                throw (UnimplementedFetchMethod);
+
+            /** Fetch a batch of URLs.  Failures don't throw; instead the
+             * result of each request is stored in its ok and error members.
+             * @param requests Reference to requests.
+             * @exception UnimplementedFetchMethod
+             */
+            void fetch_all(FetchRequests& requests) const
+                throw (UnimplementedFetchMethod);
+
         private:
+            /// Load the validators of a request's existing file.
+            void prepare(FetchRequest& req) const;
+            /// Save validators or touch the file of a successful request.
+            void finish(const FetchRequest& req) const;
+            /// Add a finished request to our stats.
+            void record(const FetchRequest& req) const;
+
             FetcherOptions _opts;
             FetcherImpMap _impmap;
             const bool _copied_impmap;
+            mutable FetchStats _stats;
     };
 
 } // namespace herdstat
@@ -0,0 +1,89 @@
+/*
+ * libherdstat -- herdstat/fetcher/fetcherimp.cc
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <herdstat/util/file.hh>
+#include <herdstat/util/timer.hh>
+#include <herdstat/fetcher/output.hh>
+#include <herdstat/fetcher/fetcherimp.hh>
+
+namespace herdstat {
+/****************************************************************************/
+void
+FetcherImp::fetch_request(FetchRequest& request) const
+{
+    request.validators.clear();
+
+    /* fetch to a temporary file, so path is only replaced on success */
+    FetchOutput out(request);
+    const std::string tmp(out.temp_path());
+    if (tmp.empty())
+    {
+        request.ok = false;
+        request.error.assign(out.error_string());
+        return;
+    }
+
+    /* all we can tell is how long it took and how big the result is */
+    util::Timer timer;
+    timer.start();
+
+    try
+    {
+        request.ok = this->fetch(request.url, tmp);
+        if (not request.ok)
+            request.error.assign("fetch failed");
+    }
+    catch (const FileException& e)
+    {
+        request.ok = false;
+        request.error.assign(e.what());
+    }
+
+    timer.stop();
+    request.timing.total += timer.elapsed();
+    if (request.ok)
+        request.timing.bytes += util::Stat(tmp).size();
+
+    if (request.ok and not (out.replay() and out.commit()))
+    {
+        request.ok = false;
+        request.error.assign(out.error_string());
+    }
+
+    request.modified = request.ok;
+}
+/****************************************************************************/
+void
+FetcherImp::fetch_all(FetchRequests& requests) const
+{
+    FetchRequests::iterator i;
+    for (i = requests.begin() ; i != requests.end() ; ++i)
+        this->fetch_request(*i);
+}
+/****************************************************************************/
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
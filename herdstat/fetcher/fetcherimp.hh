@@ -35,6 +35,7 @@
 #include <string>
 #include <herdstat/exceptions.hh>
 #include <herdstat/fetcher/options.hh>
+#include <herdstat/fetcher/request.hh>
 
 namespace herdstat {
 
@@ -59,6 +60,26 @@ namespace herdstat {
                                const std::string& path) const
                 throw (FileException) = 0;
 
+            /** Fetch a single request, setting its result.  Implementations
+             * that support conditional fetches should send the request's
+             * validators and replace them with those of the response.  All
+             * should write through a FetchOutput, which replaces the path
+             * atomically and feeds the request's sink, and add what they
+             * can measure to its timing.  The default calls fetch()
+             * (unconditionally) on a temporary file, clears the validators
+             * and only times the fetch as a whole.
+             * @param request Reference to request.
+             */
+            virtual void fetch_request(FetchRequest& request) const;
+
+            /** Fetch a batch of URLs, setting the result of each request.
+             * Implementations that can fetch concurrently should run up to
+             * FetcherOptions::max_parallel() transfers at a time.  The
+             * default calls fetch_request() for each request in turn.
+             * @param requests Reference to requests.
+             */
+            virtual void fetch_all(FetchRequests& requests) const;
+
         protected:
             /// Constructor.
             FetcherImp(const FetcherOptions& opts) throw()
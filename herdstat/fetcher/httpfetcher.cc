@@ -0,0 +1,861 @@
+/*
+ * libherdstat -- herdstat/fetcher/httpfetcher.cc
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <algorithm>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <stdint.h>
+#include <strings.h>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <zlib.h>
+
+#include <herdstat/util/string.hh>
+#include <herdstat/util/thread.hh>
+#include <herdstat/fetcher/output.hh>
+#include <herdstat/fetcher/httpfetcher.hh>
+
+#ifndef MSG_NOSIGNAL
+# define MSG_NOSIGNAL 0
+#endif
+
+namespace herdstat {
+/*** static members *********************************************************/
+const unsigned short HttpFetcher::max_redirects = 5;
+const unsigned short HttpFetcher::timeout = 15;
+/****************************************************************************
+ * A parsed http:// URL.
+ ****************************************************************************/
+struct HttpURL
+{
+    std::string host;
+    std::string port;
+    /// Path and query.
+    std::string target;
+
+    bool parse(const std::string& url);
+
+    /// host:port as it appears in a URL.
+    std::string authority() const
+    {
+        return (host.find(':') == std::string::npos ? host : "["+host+"]") +
+            (port == "80" ? "" : ":"+port);
+    }
+
+    /// Resolve a (possibly relative) Location header against this URL.
+    std::string resolve(const std::string& location) const;
+};
+/****************************************************************************/
+bool
+HttpURL::parse(const std::string& url)
+{
+    if (url.size() < 7 or strncasecmp(url.c_str(), "http://", 7) != 0)
+        return false;
+
+    const std::string::size_type end = url.find_first_of("/?#", 7);
+    std::string auth(url, 7, (end == std::string::npos ? end : end - 7));
+
+    target.assign(end == std::string::npos ? "/" : url.substr(end));
+    target.erase(std::min(target.find('#'), target.size()));
+    if (target.empty() or target[0] != '/')
+        target.insert(0, "/");
+
+    /* drop any user info */
+    std::string::size_type pos = auth.rfind('@');
+    if (pos != std::string::npos)
+        auth.erase(0, pos + 1);
+
+    port.clear();
+    if (not auth.empty() and auth[0] == '[')
+    {
+        /* IPv6 literal */
+        pos = auth.find(']');
+        if (pos == std::string::npos)
+            return false;
+        host.assign(auth, 1, pos - 1);
+        if (pos + 1 < auth.size())
+        {
+            if (auth[pos + 1] != ':')
+                return false;
+            port.assign(auth, pos + 2, std::string::npos);
+        }
+    }
+    else
+    {
+        pos = auth.rfind(':');
+        if (pos != std::string::npos)
+        {
+            port.assign(auth, pos + 1, std::string::npos);
+            auth.erase(pos);
+        }
+        host.assign(auth);
+    }
+
+    if (port.empty())
+        port.assign("80");
+
+    return (not host.empty() and
+            port.find_first_not_of("0123456789") == std::string::npos);
+}
+/****************************************************************************/
+std::string
+HttpURL::resolve(const std::string& location) const
+{
+    if (location.find("://") != std::string::npos)
+        return location;
+    if (location.compare(0, 2, "//") == 0)
+        return "http:"+location;
+    if (not location.empty() and location[0] == '/')
+        return "http://"+this->authority()+location;
+
+    /* relative to the current directory */
+    const std::string path(target.substr(0, target.find('?')));
+    return "http://"+this->authority()+
+        path.substr(0, path.rfind('/') + 1)+location;
+}
+/****************************************************************************
+ * Process-wide pool of idle keep-alive connections, keyed by host:port.
+ ****************************************************************************/
+class HttpConnectionPool
+{
+    public:
+        /// Maximum number of idle connections kept open.
+        static const std::size_t max_idle = 16;
+
+        HttpConnectionPool() : _mutex(), _idle() { }
+
+        ~HttpConnectionPool()
+        {
+            std::vector<std::pair<std::string, int> >::iterator i;
+            for (i = _idle.begin() ; i != _idle.end() ; ++i)
+                close(i->second);
+        }
+
+        /// Get an idle connection to key (or -1 if there is none).
+        int acquire(const std::string& key)
+        {
+            util::MutexLock lock(_mutex);
+
+            std::vector<std::pair<std::string, int> >::iterator i;
+            for (i = _idle.begin() ; i != _idle.end() ; )
+            {
+                if (i->first != key)
+                {
+                    ++i;
+                    continue;
+                }
+
+                const int fd = i->second;
+                i = _idle.erase(i);
+
+                /* an idle connection shouldn't be readable; if it is, the
+                 * server has closed it (or sent garbage) */
+                struct pollfd p;
+                p.fd = fd;
+                p.events = POLLIN;
+                p.revents = 0;
+                if (poll(&p, 1, 0) == 0)
+                    return fd;
+
+                close(fd);
+            }
+
+            return -1;
+        }
+
+        /// Keep connection open for reuse.
+        void release(const std::string& key, int fd)
+        {
+            util::MutexLock lock(_mutex);
+
+            if (_idle.size() == max_idle)
+            {
+                close(_idle.front().second);
+                _idle.erase(_idle.begin());
+            }
+
+            _idle.push_back(std::make_pair(key, fd));
+        }
+
+    private:
+        util::Mutex _mutex;
+        std::vector<std::pair<std::string, int> > _idle;
+};
+
+static HttpConnectionPool&
+http_pool()
+{
+    static HttpConnectionPool p;
+    return p;
+}
+/****************************************************************************
+ * Measures elapsed time (in milliseconds), optionally adding it to total
+ * when destroyed.
+ ****************************************************************************/
+class HttpClock
+{
+    public:
+        explicit HttpClock(double *total = NULL) : _begin(), _total(total)
+        { this->restart(); }
+        ~HttpClock() { if (_total) *_total += this->elapsed(); }
+
+        void restart() { gettimeofday(&_begin, NULL); }
+
+        double elapsed() const
+        {
+            struct timeval now;
+            gettimeofday(&now, NULL);
+            return ((now.tv_sec - _begin.tv_sec) * 1000.0) +
+                   ((now.tv_usec - _begin.tv_usec) / 1000.0);
+        }
+
+    private:
+        struct timeval _begin;
+        double *_total;
+};
+/****************************************************************************
+ * Buffered reading from/writing to a connected socket.  Closes it on
+ * destruction unless detach()'d.
+ ****************************************************************************/
+class HttpConnection
+{
+    public:
+        explicit HttpConnection(int fd)
+            : _fd(fd), _buf(), _pos(0), _received(false) { }
+        ~HttpConnection() { if (_fd >= 0) close(_fd); }
+
+        /// Give up ownership of the socket.
+        int detach() { const int fd = _fd; _fd = -1; return fd; }
+
+        /// Has anything been received?
+        bool received() const { return _received; }
+
+        /// Is there unread data in our buffer?
+        bool buffered() const { return (_pos < _buf.size()); }
+
+        bool send(const std::string& data)
+        {
+            std::string::size_type sent = 0;
+            while (sent < data.size())
+            {
+                const ssize_t n = ::send(_fd, data.data() + sent,
+                    data.size() - sent, MSG_NOSIGNAL);
+                if (n < 0 and errno == EINTR)
+                    continue;
+                if (n <= 0)
+                    return false;
+                sent += n;
+            }
+            return true;
+        }
+
+        /// Read a line, stripping the line terminator.
+        bool read_line(std::string& line)
+        {
+            line.clear();
+            while (true)
+            {
+                const std::string::size_type nl = _buf.find('\n', _pos);
+                if (nl != std::string::npos)
+                {
+                    line.assign(_buf, _pos, nl - _pos);
+                    _pos = nl + 1;
+                    if (not line.empty() and line[line.size() - 1] == '\r')
+                        line.erase(line.size() - 1);
+                    return true;
+                }
+
+                if (not this->fill())
+                    return false;
+            }
+        }
+
+        /// Read up to n bytes (returns 0 on EOF, -1 on error).
+        ssize_t read(char *data, std::size_t n)
+        {
+            if (not this->buffered() and not this->fill())
+                return (errno ? -1 : 0);
+
+            n = std::min(n, _buf.size() - _pos);
+            std::memcpy(data, _buf.data() + _pos, n);
+            _pos += n;
+            return n;
+        }
+
+    private:
+        bool fill()
+        {
+            if (_pos > 0)
+            {
+                _buf.erase(0, _pos);
+                _pos = 0;
+            }
+
+            char data[8192];
+            ssize_t n;
+            while ((n = ::recv(_fd, data, sizeof(data), 0)) < 0 and
+                   errno == EINTR) ;
+
+            if (n <= 0)
+            {
+                if (n == 0)
+                    errno = 0;
+                return false;
+            }
+
+            _received = true;
+            _buf.append(data, n);
+            return true;
+        }
+
+        int _fd;
+        std::string _buf;
+        std::string::size_type _pos;
+        bool _received;
+};
+/****************************************************************************/
+static int
+http_connect(const HttpURL& url, std::string& error, FetchTiming& timing)
+{
+    struct addrinfo hints, *res = NULL;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    HttpClock clock;
+    const int rv = getaddrinfo(url.host.c_str(), url.port.c_str(),
+                               &hints, &res);
+    timing.resolve += clock.elapsed();
+    if (rv != 0)
+    {
+        error.assign(url.host+": "+gai_strerror(rv));
+        return -1;
+    }
+
+    struct timeval tv;
+    tv.tv_sec = HttpFetcher::timeout;
+    tv.tv_usec = 0;
+
+    HttpClock connecting(&timing.connect);
+    int fd = -1;
+    for (struct addrinfo *ai = res ; ai ; ai = ai->ai_next)
+    {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0)
+            continue;
+
+        /* on Linux, the send timeout applies to connect() too */
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0)
+            break;
+
+        error.assign(url.authority()+": "+std::strerror(errno));
+        close(fd);
+        fd = -1;
+    }
+
+    freeaddrinfo(res);
+    return fd;
+}
+/****************************************************************************
+ * Undoes a gzip or deflate Content-Encoding on the way to a FetchOutput.
+ ****************************************************************************/
+class HttpDecoder : private Noncopyable
+{
+    public:
+        explicit HttpDecoder(FetchOutput& out)
+            : _out(out), _zs(), _inflating(false), _raw(false), _ended(false)
+        { }
+
+        ~HttpDecoder() { if (_inflating) inflateEnd(&_zs); }
+
+        /// Prepare for an encoding (returns false if it's unsupported).
+        bool start(const std::string& encoding)
+        {
+            if (encoding.empty() or encoding == "identity")
+                return true;
+            if (encoding != "gzip" and encoding != "x-gzip" and
+                encoding != "deflate")
+                return false;
+
+            /* zlib or gzip format, detected from the header */
+            std::memset(&_zs, 0, sizeof(_zs));
+            return (_inflating = (inflateInit2(&_zs, 15 + 32) == Z_OK));
+        }
+
+        bool write(const char *data, std::size_t len)
+        {
+            if (not _inflating)
+                return _out.write(data, len);
+
+            _zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+            _zs.avail_in = len;
+
+            while (_zs.avail_in > 0 and not _ended)
+            {
+                char buf[16384];
+                _zs.next_out = reinterpret_cast<Bytef *>(buf);
+                _zs.avail_out = sizeof(buf);
+
+                int result = inflate(&_zs, Z_NO_FLUSH);
+
+                /* some servers send raw deflate data for "deflate"; start
+                 * over if this is the first data we were given */
+                if (result == Z_DATA_ERROR and not _raw and
+                    _zs.total_in == (len - _zs.avail_in))
+                {
+                    inflateEnd(&_zs);
+                    std::memset(&_zs, 0, sizeof(_zs));
+                    if (inflateInit2(&_zs, -15) != Z_OK)
+                    {
+                        _inflating = false;
+                        return false;
+                    }
+                    _raw = true;
+                    return this->write(data, len);
+                }
+
+                if (result != Z_OK and result != Z_STREAM_END)
+                    return false;
+                _ended = (result == Z_STREAM_END);
+
+                const std::size_t n = sizeof(buf) - _zs.avail_out;
+                if (n > 0 and not _out.write(buf, n))
+                    return false;
+            }
+
+            return true;
+        }
+
+        /// Was the whole compressed stream received?
+        bool finish() const { return (not _inflating or _ended); }
+
+    private:
+        FetchOutput& _out;
+        z_stream _zs;
+        bool _inflating;
+        bool _raw;
+        bool _ended;
+};
+/****************************************************************************
+ * A single fetch, following redirects.  As with curl, the body goes through
+ * a FetchOutput.
+ ****************************************************************************/
+class HttpTransfer
+{
+    public:
+        HttpTransfer(FetchRequest& req, const FetcherOptions& opts)
+            : _req(req), _opts(opts), _out(req) { }
+
+        void run();
+
+        /// Did opening or writing the destination file fail?
+        bool file_error() const { return (_out.error() != 0); }
+
+    private:
+        struct Response
+        {
+            int status;
+            /// Content-Length (-1 if unknown).
+            int64_t length;
+            bool chunked;
+            bool keep_alive;
+            std::string location;
+            /// Content-Encoding (lowercase).
+            std::string encoding;
+            Validators validators;
+        };
+
+        bool exchange(const HttpURL& url, Response& r, std::string& error);
+        bool read_header(HttpConnection& conn, Response& r);
+        bool read_body(HttpConnection& conn, Response& r, bool save);
+        /// Count and decode part of the body.
+        bool decode(HttpDecoder& decoder, const char *data, std::size_t len)
+        {
+            _req.timing.bytes += len;
+            return decoder.write(data, len);
+        }
+        void fail(const std::string& error, bool transient = false);
+
+        FetchRequest& _req;
+        const FetcherOptions& _opts;
+        FetchOutput _out;
+};
+/****************************************************************************/
+void
+HttpTransfer::run()
+{
+    const HttpClock clock(&_req.timing.total);
+    std::string url(_req.url);
+
+    for (unsigned short redirects = 0 ; ; ++redirects)
+    {
+        HttpURL u;
+        if (not u.parse(url))
+        {
+            this->fail("unsupported URL: "+url);
+            return;
+        }
+
+        Response r;
+        std::string error;
+        if (not this->exchange(u, r, error))
+        {
+            /* connection trouble might not last; local errors will */
+            this->fail(error, not (_out.error() or _out.aborted()));
+            return;
+        }
+
+        switch (r.status)
+        {
+            case 301: case 302: case 303: case 307: case 308:
+                if (r.location.empty())
+                    break;
+                if (redirects == HttpFetcher::max_redirects)
+                {
+                    this->fail("too many redirects");
+                    return;
+                }
+                url.assign(u.resolve(r.location));
+                continue;
+            case 304:
+                _req.ok = true;
+                _req.modified = false;
+                if (not r.validators.empty())
+                    _req.validators = r.validators;
+                return;
+        }
+
+        if (r.status < 200 or r.status >= 300)
+        {
+            this->fail(util::sprintf("HTTP status %d", r.status),
+                r.status == 408 or r.status == 429 or r.status >= 500);
+            return;
+        }
+
+        if (not _out.commit())
+        {
+            this->fail(_out.error_string());
+            return;
+        }
+
+        _req.ok = true;
+        _req.modified = true;
+        _req.validators = r.validators;
+        return;
+    }
+}
+/****************************************************************************/
+bool
+HttpTransfer::exchange(const HttpURL& url, Response& r, std::string& error)
+{
+    const std::string key(url.host+":"+url.port);
+
+    std::string request("GET "+url.target+" HTTP/1.1\r\n"
+        "Host: "+url.authority()+"\r\n"
+        "User-Agent: " PACKAGE "\r\n"
+        "Accept: */*\r\n"
+        "Accept-Encoding: gzip, deflate\r\n");
+    if (not _req.validators.etag.empty())
+        request += "If-None-Match: "+_req.validators.etag+"\r\n";
+    if (not _req.validators.last_modified.empty())
+        request += "If-Modified-Since: "+_req.validators.last_modified+"\r\n";
+    request += "\r\n";
+
+    if (_opts.debug())
+        std::fprintf(stderr, "> GET http://%s%s\n",
+            url.authority().c_str(), url.target.c_str());
+
+    /* a reused connection may have been closed by the server in the
+     * meantime, in which case retry once with a new one */
+    int fd = http_pool().acquire(key);
+    for (bool reused = (fd >= 0) ; ; reused = false)
+    {
+        if (not reused and (fd = http_connect(url, error, _req.timing)) < 0)
+            return false;
+
+        HttpConnection conn(fd);
+        HttpClock clock;
+
+        if (not conn.send(request))
+        {
+            if (reused)
+                continue;
+            error.assign(url.authority()+": "+std::strerror(errno));
+            return false;
+        }
+
+        if (not this->read_header(conn, r))
+        {
+            if (reused and not conn.received())
+                continue;
+            error.assign(url.authority()+": invalid or no response");
+            return false;
+        }
+
+        if (_opts.debug())
+            std::fprintf(stderr, "< %d\n", r.status);
+
+        _req.timing.wait += clock.elapsed();
+        const HttpClock transfer(&_req.timing.transfer);
+
+        /* only the body of the final response is saved */
+        const bool save = (r.status >= 200 and r.status < 300);
+        if (not this->read_body(conn, r, save))
+        {
+            error.assign((_out.error() or _out.aborted()) ?
+                _out.error_string() : url.authority()+": transfer failed");
+            return false;
+        }
+
+        if (r.keep_alive and not conn.buffered())
+            http_pool().release(key, conn.detach());
+
+        return true;
+    }
+}
+/****************************************************************************
+ * Parse the leading digits (in the given base, 10 or 16) of a header value
+ * or chunk size.  Returns -1 if there are none or the value overflows.
+ ****************************************************************************/
+static int64_t
+http_size(const std::string& s, int base)
+{
+    const int64_t max = (static_cast<int64_t>(1) << 62);
+    int64_t size = -1;
+
+    for (std::string::const_iterator i = s.begin() ; i != s.end() ; ++i)
+    {
+        int digit;
+        if (*i >= '0' and *i <= '9')
+            digit = *i - '0';
+        else if (base == 16 and *i >= 'a' and *i <= 'f')
+            digit = *i - 'a' + 10;
+        else if (base == 16 and *i >= 'A' and *i <= 'F')
+            digit = *i - 'A' + 10;
+        else
+            break;
+
+        if (size < 0)
+            size = 0;
+        else if (size >= max / base)
+            return -1;
+        size = size * base + digit;
+    }
+
+    return size;
+}
+/****************************************************************************/
+bool
+HttpTransfer::read_header(HttpConnection& conn, Response& r)
+{
+    std::string line;
+
+    do
+    {
+        /* status line, e.g. "HTTP/1.1 200 OK" */
+        if (not conn.read_line(line) or line.compare(0, 5, "HTTP/") != 0 or
+            line.size() < 12)
+            return false;
+
+        r.status = std::atoi(line.c_str() + 9);
+        r.length = -1;
+        r.chunked = false;
+        r.keep_alive = (line.compare(0, 8, "HTTP/1.0") != 0);
+        r.location.clear();
+        r.encoding.clear();
+        r.validators.clear();
+
+        while (true)
+        {
+            if (not conn.read_line(line))
+                return false;
+            if (line.empty())
+                break;
+
+            const std::string::size_type colon = line.find(':');
+            if (colon == std::string::npos)
+                continue;
+
+            const std::string name(util::lowercase(line.substr(0, colon)));
+            std::string value(line.substr(colon + 1));
+            value.erase(0, value.find_first_not_of(" \t"));
+            value.erase(value.find_last_not_of(" \t") + 1);
+
+            if (name == "content-length")
+                r.length = http_size(value, 10);
+            else if (name == "transfer-encoding")
+                r.chunked = (util::lowercase(value).find("chunked") !=
+                             std::string::npos);
+            else if (name == "connection")
+            {
+                const std::string v(util::lowercase(value));
+                if (v.find("close") != std::string::npos)
+                    r.keep_alive = false;
+                else if (v.find("keep-alive") != std::string::npos)
+                    r.keep_alive = true;
+            }
+            else if (name == "location")
+                r.location.assign(value);
+            else if (name == "content-encoding")
+                r.encoding.assign(util::lowercase(value));
+            else if (name == "etag")
+                r.validators.etag.assign(value);
+            else if (name == "last-modified")
+                r.validators.last_modified.assign(value);
+        }
+    } while (r.status >= 100 and r.status < 200); /* skip 100 Continue etc */
+
+    return true;
+}
+/****************************************************************************/
+bool
+HttpTransfer::read_body(HttpConnection& conn, Response& r, bool save)
+{
+    if (r.status == 204 or r.status == 304)
+        return true;
+
+    HttpDecoder decoder(_out);
+    if (save and not decoder.start(r.encoding))
+        return false;
+
+    char buf[8192];
+
+    if (r.chunked)
+    {
+        std::string line;
+        while (true)
+        {
+            /* chunk size (in hex), possibly followed by extensions */
+            if (not conn.read_line(line))
+                return false;
+
+            int64_t size = http_size(line, 16);
+            if (size < 0)
+                return false;
+            if (size == 0)
+                break;
+
+            while (size > 0)
+            {
+                const ssize_t n = conn.read(buf,
+                    static_cast<std::size_t>(std::min<int64_t>(size,
+                        sizeof(buf))));
+                if (n <= 0 or (save and not this->decode(decoder, buf, n)))
+                    return false;
+                size -= n;
+            }
+
+            /* CRLF following the chunk */
+            if (not conn.read_line(line) or not line.empty())
+                return false;
+        }
+
+        /* trailers */
+        do
+        {
+            if (not conn.read_line(line))
+                return false;
+        } while (not line.empty());
+
+        return (not save or decoder.finish());
+    }
+
+    if (r.length < 0)
+        r.keep_alive = false; /* body ends when the connection is closed */
+
+    int64_t left = r.length;
+    while (left != 0)
+    {
+        const std::size_t want = (left < 0 ? sizeof(buf) :
+            static_cast<std::size_t>(std::min<int64_t>(left, sizeof(buf))));
+        const ssize_t n = conn.read(buf, want);
+        if (n == 0 and left < 0)
+            break;
+        if (n <= 0 or (save and not this->decode(decoder, buf, n)))
+            return false;
+        if (left > 0)
+            left -= n;
+    }
+
+    return (not save or decoder.finish());
+}
+/****************************************************************************/
+void
+HttpTransfer::fail(const std::string& error, bool transient)
+{
+    _req.ok = false;
+    _req.transient = transient;
+    _req.error.assign(error);
+    _out.discard();
+}
+/****************************************************************************/
+HttpFetcher::HttpFetcher(const FetcherOptions& opts) throw()
+    : FetcherImp(opts)
+{
+}
+/****************************************************************************/
+HttpFetcher::~HttpFetcher() throw()
+{
+}
+/****************************************************************************/
+bool
+HttpFetcher::fetch(const std::string& url, const std::string& path) const
+    throw (FileException)
+{
+    BacktraceContext c("HttpFetcher::fetch("+url+", "+path+")");
+
+    FetchRequest req(url, path);
+    HttpTransfer t(req, options());
+    t.run();
+
+    if (t.file_error())
+        throw FileException(path);
+
+    return req.ok;
+}
+/****************************************************************************/
+void
+HttpFetcher::fetch_request(FetchRequest& request) const
+{
+    BacktraceContext c("HttpFetcher::fetch_request("+request.url+")");
+
+    HttpTransfer t(request, options());
+    t.run();
+}
+/****************************************************************************/
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
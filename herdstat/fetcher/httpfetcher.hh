@@ -0,0 +1,87 @@
+/*
+ * libherdstat -- herdstat/fetcher/httpfetcher.hh
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_HTTPFETCHER_HH
+#define _HAVE_HTTPFETCHER_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/fetcher/httpfetcher.hh
+ * @brief Defines the HttpFetcher concrete class.
+ */
+
+#include <herdstat/fetcher/fetcherimp.hh>
+
+namespace herdstat {
+
+    /**
+     * @class HttpFetcher httpfetcher.hh herdstat/fetcher/httpfetcher.hh
+     * @brief Fetcher implementation using a built-in HTTP/1.1 client.
+     *
+     * Supports plain http:// URLs only (no TLS, no proxies).  Connections
+     * are kept alive and reused across fetches (and HttpFetcher instances),
+     * chunked responses are decoded and up to max_redirects redirects are
+     * followed.  Fetches are conditional if the request has validators.
+     */
+
+    class HttpFetcher : public FetcherImp
+    {
+        public:
+            /// Maximum number of redirects followed.
+            static const unsigned short max_redirects;
+            /// Connect/read/write timeout (in seconds).
+            static const unsigned short timeout;
+
+            /// Destructor.
+            virtual ~HttpFetcher() throw();
+
+            /** Save url to path.
+             * @param url URL string.
+             * @param path Path to file.
+             * @exception FileException
+             * @returns False if fetching failed.
+             */
+            virtual bool fetch(const std::string& url,
+                               const std::string& path) const
+                throw (FileException);
+
+            /** Fetch a single request, conditionally if it has validators.
+             * @param request Reference to request.
+             */
+            virtual void fetch_request(FetchRequest& request) const;
+
+        private:
+            /// Only FetcherImpMap can instantiate this class.
+            friend class FetcherImpMap;
+
+            /// Constructor.
+            HttpFetcher(const FetcherOptions& opts) throw();
+    };
+
+} // namespace herdstat
+
+#endif /* _HAVE_HTTPFETCHER_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -26,6 +26,7 @@
 
 #include <herdstat/fetcher/curlfetcher.hh>
 #include <herdstat/fetcher/wgetfetcher.hh>
+#include <herdstat/fetcher/httpfetcher.hh>
 #include <herdstat/fetcher/impmap.hh>
 
 namespace herdstat {
@@ -40,6 +41,7 @@ FetcherImpMap::FetcherImpMap(const FetcherOptions& opts) throw()
     INSERT_IMP(curl, new CurlFetcher(_opts));
 #endif
     INSERT_IMP(wget, new WgetFetcher(_opts));
+    INSERT_IMP(http, new HttpFetcher(_opts));
 
 #undef INSERT_IMP
 }
@@ -25,20 +25,37 @@
 #endif
 
 #include <cstdlib>
+#include <cstring>
 #include <herdstat/fetcher/options.hh>
 
 namespace herdstat {
 /****************************************************************************/
 FetcherOptions::FetcherOptions() throw()
-    : _verbose(false), _debug(false), _imp(DEFAULT_FETCH_METHOD)
+    : _verbose(false), _debug(false), _imp(DEFAULT_FETCH_METHOD),
+      _max_parallel(DEFAULT_FETCH_PARALLEL), _conditional(true),
+      _max_per_host(DEFAULT_FETCH_PER_HOST), _retries(DEFAULT_FETCH_RETRIES),
+      _retry_delay(DEFAULT_FETCH_RETRY_DELAY), _compress(false),
+      _stats_file()
 {
     const char * const result = std::getenv("HERDSTAT_FETCH_METHOD");
     if (result)
         _imp.assign(result);
+
+    const char * const compress = std::getenv("HERDSTAT_FETCH_COMPRESS");
+    if (compress and *compress and std::strcmp(compress, "0") != 0)
+        _compress = true;
+
+    const char * const stats = std::getenv("HERDSTAT_FETCH_STATS");
+    if (stats)
+        _stats_file.assign(stats);
 }
 /****************************************************************************/
 FetcherOptions::FetcherOptions(const std::string& imp) throw()
-    : _verbose(false), _debug(false), _imp(imp)
+    : _verbose(false), _debug(false), _imp(imp),
+      _max_parallel(DEFAULT_FETCH_PARALLEL), _conditional(true),
+      _max_per_host(DEFAULT_FETCH_PER_HOST), _retries(DEFAULT_FETCH_RETRIES),
+      _retry_delay(DEFAULT_FETCH_RETRY_DELAY), _compress(false),
+      _stats_file()
 {
 }
 /****************************************************************************/
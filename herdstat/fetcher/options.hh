@@ -40,6 +40,32 @@
  */
 #define DEFAULT_FETCH_METHOD    "wget"
 
+/**
+ * @def DEFAULT_FETCH_PARALLEL
+ * @brief Default maximum number of concurrent transfers when fetching a
+ * batch of URLs.
+ */
+#define DEFAULT_FETCH_PARALLEL  4
+
+/**
+ * @def DEFAULT_FETCH_PER_HOST
+ * @brief Default maximum number of concurrent transfers from one host,
+ * across all Fetcher objects.
+ */
+#define DEFAULT_FETCH_PER_HOST  2
+
+/**
+ * @def DEFAULT_FETCH_RETRIES
+ * @brief Default number of times a transient failure is retried.
+ */
+#define DEFAULT_FETCH_RETRIES   2
+
+/**
+ * @def DEFAULT_FETCH_RETRY_DELAY
+ * @brief Default delay (in milliseconds) before the first retry.
+ */
+#define DEFAULT_FETCH_RETRY_DELAY   500
+
 namespace herdstat {
 
     /**
@@ -60,7 +86,10 @@ namespace herdstat {
             /** Default constructor.
              * Fetcher implementation is set to the value of the environment
              * variable HERDSTAT_FETCH_METHOD (if set).  Otherwise the value of
-             * the DEFAULT_FETCH_METHOD define is used.
+             * the DEFAULT_FETCH_METHOD define is used.  Fetched files are
+             * stored compressed if HERDSTAT_FETCH_COMPRESS is set (to
+             * anything but 0).  The stats file is set to the value of
+             * HERDSTAT_FETCH_STATS (if set).
              */
             FetcherOptions() throw();
 
@@ -78,6 +107,20 @@ namespace herdstat {
             inline bool verbose() const;
             /// debug?
             inline bool debug() const;
+            /// Get maximum number of concurrent transfers for batches.
+            inline unsigned int max_parallel() const;
+            /// Make fetches of already existing files conditional?
+            inline bool conditional() const;
+            /// Get maximum number of concurrent transfers from one host.
+            inline unsigned int max_per_host() const;
+            /// Get number of times a transient failure is retried.
+            inline unsigned int retries() const;
+            /// Get delay (in milliseconds) before the first retry.
+            inline unsigned int retry_delay() const;
+            /// Store fetched files gzip-compressed?
+            inline bool compress() const;
+            /// Get path of file to append fetch stats to (empty if none).
+            inline const std::string& stats_file() const;
 
             /// Set fetcher implementation name.
             inline void set_implementation(const std::string& imp);
@@ -85,11 +128,58 @@ namespace herdstat {
             inline void set_verbose(bool v);
             /// set debug
             inline void set_debug(bool v);
+            /** Set maximum number of concurrent transfers for batches.
+             * @param n Number of transfers (0 is treated as 1).
+             */
+            inline void set_max_parallel(unsigned int n);
+            /** Set whether fetches of already existing files should be
+             * conditional (on by default).  If so, the ETag/Last-Modified
+             * validators of each fetched file are saved alongside it and
+             * sent with the next fetch; if the server responds that the file
+             * hasn't changed, it is kept and just touched.
+             * @param v Whether to make fetches conditional.
+             */
+            inline void set_conditional(bool v);
+            /** Set maximum number of concurrent transfers from one host.
+             * The limit is shared by all Fetcher objects in the process.
+             * @param n Number of transfers (0 is treated as 1).
+             */
+            inline void set_max_per_host(unsigned int n);
+            /** Set number of times a fetch that failed in a way that might
+             * be temporary (see FetchRequest::transient) is retried.
+             * @param n Number of retries (0 disables retrying).
+             */
+            inline void set_retries(unsigned int n);
+            /** Set delay before the first retry.  It doubles for every
+             * subsequent retry, and is randomized by up to half so that
+             * clients don't retry in lockstep.
+             * @param ms Delay in milliseconds.
+             */
+            inline void set_retry_delay(unsigned int ms);
+            /** Set whether fetched files should be stored gzip-compressed
+             * (off by default).  The XML parsers read compressed files
+             * transparently.
+             * @param v Whether to compress.
+             */
+            inline void set_compress(bool v);
+            /** Set path of file that each Fetcher appends its stats() to,
+             * as a line of JSON (see FetchStats::dump_json()), when it's
+             * destroyed.
+             * @param path Path to file (empty to disable).
+             */
+            inline void set_stats_file(const std::string& path);
 
         private:
             bool _verbose;
             bool _debug;
             std::string _imp;
+            unsigned int _max_parallel;
+            bool _conditional;
+            unsigned int _max_per_host;
+            unsigned int _retries;
+            unsigned int _retry_delay;
+            bool _compress;
+            std::string _stats_file;
     };
 
     inline const std::string& FetcherOptions::implementation() const
@@ -100,6 +190,28 @@ namespace herdstat {
     { _imp = imp; }
     inline void FetcherOptions::set_verbose(bool v) { _verbose = v; }
     inline void FetcherOptions::set_debug(bool v) { _debug = v; }
+    inline unsigned int FetcherOptions::max_parallel() const
+    { return _max_parallel; }
+    inline void FetcherOptions::set_max_parallel(unsigned int n)
+    { _max_parallel = (n == 0 ? 1 : n); }
+    inline bool FetcherOptions::conditional() const { return _conditional; }
+    inline void FetcherOptions::set_conditional(bool v) { _conditional = v; }
+    inline unsigned int FetcherOptions::max_per_host() const
+    { return _max_per_host; }
+    inline void FetcherOptions::set_max_per_host(unsigned int n)
+    { _max_per_host = (n == 0 ? 1 : n); }
+    inline unsigned int FetcherOptions::retries() const { return _retries; }
+    inline void FetcherOptions::set_retries(unsigned int n) { _retries = n; }
+    inline unsigned int FetcherOptions::retry_delay() const
+    { return _retry_delay; }
+    inline void FetcherOptions::set_retry_delay(unsigned int ms)
+    { _retry_delay = ms; }
+    inline bool FetcherOptions::compress() const { return _compress; }
+    inline void FetcherOptions::set_compress(bool v) { _compress = v; }
+    inline const std::string& FetcherOptions::stats_file() const
+    { return _stats_file; }
+    inline void FetcherOptions::set_stats_file(const std::string& path)
+    { _stats_file = path; }
 
 } // namespace herdstat
 
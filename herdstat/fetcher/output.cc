@@ -0,0 +1,276 @@
+/*
+ * libherdstat -- herdstat/fetcher/output.cc
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <herdstat/util/file.hh>
+#include <herdstat/fetcher/output.hh>
+
+namespace herdstat {
+/****************************************************************************/
+FetchOutput::FetchOutput(FetchRequest& req) throw()
+    : _req(req), _fp(NULL), _gz(NULL), _tmp(), _errno(0), _aborted(false),
+      _external(false)
+{
+}
+/****************************************************************************/
+FetchOutput::~FetchOutput() throw()
+{
+    this->discard();
+}
+/****************************************************************************/
+bool
+FetchOutput::open() throw()
+{
+    if (_fp or _gz)
+        return true;
+
+    /* unique per process and thread, so concurrent fetches of the same path
+     * don't trample each other */
+    _tmp = util::tmp_path(_req.path);
+
+    int fd = ::open(_tmp.c_str(), O_WRONLY|O_CREAT|O_EXCL, 0666);
+    if (fd < 0 and errno == EEXIST)
+    {
+        /* left over from a process that died mid-fetch */
+        unlink(_tmp.c_str());
+        fd = ::open(_tmp.c_str(), O_WRONLY|O_CREAT|O_EXCL, 0666);
+    }
+
+    /* compress as we go, unless someone else writes the file */
+    const bool gz = (_req.compress and not _external);
+    if (fd < 0 or not (gz ? (_gz = gzdopen(fd, "wb")) != NULL :
+                            (_fp = fdopen(fd, "w")) != NULL))
+    {
+        _errno = errno;
+        if (fd >= 0)
+        {
+            close(fd);
+            unlink(_tmp.c_str());
+        }
+        _tmp.clear();
+        return false;
+    }
+
+    if (_req.sink)
+        _req.sink->begin();
+
+    return true;
+}
+/****************************************************************************/
+bool
+FetchOutput::write(const char *data, std::size_t len) throw()
+{
+    if (not this->open())
+        return false;
+
+    if (len == 0)
+        return true;
+
+    if (_gz ? (gzwrite(_gz, data, len) != static_cast<int>(len)) :
+              (std::fwrite(data, 1, len, _fp) != len))
+    {
+        _errno = errno;
+        return false;
+    }
+
+    if (_req.sink and not _req.sink->write(data, len))
+    {
+        _aborted = true;
+        return false;
+    }
+
+    return true;
+}
+/****************************************************************************/
+bool
+FetchOutput::replay() throw()
+{
+    if (not _req.sink or _tmp.empty())
+        return true;
+
+    std::FILE *fp = std::fopen(_tmp.c_str(), "r");
+    if (not fp)
+    {
+        _errno = errno;
+        return false;
+    }
+
+    char buf[8192];
+    std::size_t n;
+    bool result = true;
+
+    while (result and (n = std::fread(buf, 1, sizeof(buf), fp)) > 0)
+    {
+        if (not _req.sink->write(buf, n))
+        {
+            _aborted = true;
+            result = false;
+        }
+    }
+
+    if (result and std::ferror(fp))
+    {
+        _errno = errno;
+        result = false;
+    }
+
+    std::fclose(fp);
+    return result;
+}
+/****************************************************************************/
+bool
+FetchOutput::commit() throw()
+{
+    if (not this->open())
+        return false;
+
+    const int result = (_gz ? gzclose(_gz) : std::fclose(_fp));
+    _fp = NULL;
+    _gz = NULL;
+
+    if (result != 0)
+    {
+        _errno = (errno ? errno : EIO);
+        this->discard();
+        return false;
+    }
+
+    if (_req.sink and not _req.sink->finish())
+    {
+        _aborted = true;
+        this->discard();
+        return false;
+    }
+
+    if (_external and _req.compress and not this->compress())
+    {
+        this->discard();
+        return false;
+    }
+
+    if (std::rename(_tmp.c_str(), _req.path.c_str()) != 0)
+    {
+        _errno = errno;
+        this->discard();
+        return false;
+    }
+
+    _tmp.clear();
+    return true;
+}
+/****************************************************************************/
+bool
+FetchOutput::compress() throw()
+{
+    const std::string gzpath(_tmp+".gz");
+
+    std::FILE *in = std::fopen(_tmp.c_str(), "r");
+    if (not in)
+    {
+        _errno = errno;
+        return false;
+    }
+
+    const int fd = ::open(gzpath.c_str(), O_WRONLY|O_CREAT|O_TRUNC, 0666);
+    gzFile out = (fd < 0 ? NULL : gzdopen(fd, "wb"));
+    if (not out)
+    {
+        _errno = errno;
+        if (fd >= 0)
+            close(fd);
+        std::fclose(in);
+        unlink(gzpath.c_str());
+        return false;
+    }
+
+    char buf[8192];
+    std::size_t n;
+    bool result = true;
+
+    while (result and (n = std::fread(buf, 1, sizeof(buf), in)) > 0)
+        result = (gzwrite(out, buf, n) == static_cast<int>(n));
+
+    if (std::ferror(in))
+        result = false;
+    if (gzclose(out) != 0)
+        result = false;
+    std::fclose(in);
+
+    if (not result or std::rename(gzpath.c_str(), _tmp.c_str()) != 0)
+    {
+        _errno = (errno ? errno : EIO);
+        unlink(gzpath.c_str());
+        return false;
+    }
+
+    return true;
+}
+/****************************************************************************/
+void
+FetchOutput::discard() throw()
+{
+    if (_fp)
+    {
+        std::fclose(_fp);
+        _fp = NULL;
+    }
+
+    if (_gz)
+    {
+        gzclose(_gz);
+        _gz = NULL;
+    }
+
+    if (not _tmp.empty())
+    {
+        unlink(_tmp.c_str());
+        _tmp.clear();
+    }
+}
+/****************************************************************************/
+const std::string&
+FetchOutput::temp_path() throw()
+{
+    _external = true;
+    this->open();
+    return _tmp;
+}
+/****************************************************************************/
+std::string
+FetchOutput::error_string() const
+{
+    if (_aborted)
+        return _req.path+": rejected by receiver";
+    return _req.path+": "+std::strerror(_errno);
+}
+/****************************************************************************/
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
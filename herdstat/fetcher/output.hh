@@ -0,0 +1,127 @@
+/*
+ * libherdstat -- herdstat/fetcher/output.hh
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_FETCHER_OUTPUT_HH
+#define _HAVE_FETCHER_OUTPUT_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/fetcher/output.hh
+ * @brief Defines the FetchOutput class.
+ */
+
+#include <cstdio>
+#include <string>
+#include <zlib.h>
+#include <herdstat/noncopyable.hh>
+#include <herdstat/fetcher/request.hh>
+
+namespace herdstat {
+
+    /**
+     * @class FetchOutput output.hh herdstat/fetcher/output.hh
+     * @brief Destination of a FetchRequest's body, for use by FetcherImp
+     * implementations.
+     *
+     * Data is written to a temporary file in the same directory as the
+     * request's path (created on the first write()) and passed on to the
+     * request's sink, if any, after calling its begin().  commit() renames the temporary file over the
+     * path; if that never happens, the temporary file is removed and the
+     * path is left alone.
+     *
+     * If the request asks for it, the file is stored gzip-compressed: as
+     * it's written, or when committed if written by someone else (see
+     * temp_path()).  The sink always receives the data uncompressed.
+     */
+
+    class FetchOutput : private Noncopyable
+    {
+        public:
+            /** Constructor.
+             * @param req Reference to the request being fetched.
+             */
+            explicit FetchOutput(FetchRequest& req) throw();
+
+            /// Destructor.  Calls discard() unless committed.
+            ~FetchOutput() throw();
+
+            /** Write data.
+             * @param data Pointer to data.
+             * @param len Length of data.
+             * @returns False if writing failed or the sink aborted.
+             */
+            bool write(const char *data, std::size_t len) throw();
+
+            /** Pass the contents of the temporary file (written by someone
+             * else, see temp_path()) to the sink.
+             * @returns False if reading failed or the sink aborted.
+             */
+            bool replay() throw();
+
+            /** Let the sink accept the body, then replace the request's
+             * path with it.  An empty body makes an empty file.
+             * @returns False on failure (the temporary file is removed).
+             */
+            bool commit() throw();
+
+            /// Close and remove the temporary file.
+            void discard() throw();
+
+            /** Get the path of the temporary file, creating it if
+             * necessary, for someone else to write to.  Use replay() and
+             * commit() once it has been written.
+             * @returns Empty string on failure.
+             */
+            const std::string& temp_path() throw();
+
+            /// Did the sink abort or reject the body?
+            bool aborted() const { return _aborted; }
+
+            /// errno of the last file error (0 if none).
+            int error() const { return _errno; }
+
+            /// Description of what went wrong.
+            std::string error_string() const;
+
+        private:
+            bool open() throw();
+            /// Compress the temporary file in place.
+            bool compress() throw();
+
+            FetchRequest& _req;
+            std::FILE *_fp;
+            gzFile _gz;
+            std::string _tmp;
+            int _errno;
+            bool _aborted;
+            /// was the temporary file handed out by temp_path()?
+            bool _external;
+    };
+
+} // namespace herdstat
+
+#endif /* _HAVE_FETCHER_OUTPUT_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
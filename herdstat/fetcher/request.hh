@@ -0,0 +1,177 @@
+/*
+ * libherdstat -- herdstat/fetcher/request.hh
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_FETCHER_REQUEST_HH
+#define _HAVE_FETCHER_REQUEST_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/fetcher/request.hh
+ * @brief Defines the FetchSink interface and FetchRequest struct.
+ */
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+#include <herdstat/fetcher/validators.hh>
+
+namespace herdstat {
+
+    /**
+     * @class FetchSink request.hh herdstat/fetcher/request.hh
+     * @brief Receives the body of a fetch as it arrives.
+     *
+     * A sink sees the same bytes that are written to the request's path.
+     * The file only replaces an existing one once finish() has accepted
+     * it, so a sink that parses the data can refuse a broken document.
+     *
+     * A request that fails part way through may be retried with the same
+     * sink, so begin() is called at the start of every attempt that
+     * receives data.
+     */
+
+    class FetchSink
+    {
+        public:
+            /// Destructor.
+            virtual ~FetchSink() { }
+
+            /// A new attempt is starting; forget anything received so far.
+            virtual void begin() { }
+
+            /** Receive the next part of the body.
+             * @param data Pointer to data.
+             * @param len Length of data.
+             * @returns False to abort the fetch.
+             */
+            virtual bool write(const char *data, std::size_t len) = 0;
+
+            /** The whole body has been received.
+             * @returns False to reject it (the fetch then fails).
+             */
+            virtual bool finish() { return true; }
+    };
+
+    /**
+     * @struct FetchTiming request.hh herdstat/fetcher/request.hh
+     * @brief Where the time of a fetch went, and how much was received.
+     *
+     * Times are in milliseconds.  Implementations add to them, so a
+     * request that was retried accounts for every attempt.  Phases an
+     * implementation can't tell apart (or that didn't happen, such as
+     * connecting over a reused connection) are left at zero.
+     */
+
+    struct FetchTiming
+    {
+        /// Resolving the host name.
+        double resolve;
+        /// Establishing the TCP connection.
+        double connect;
+        /// TLS handshake.
+        double tls;
+        /// From sending the request until the first byte of the response.
+        double wait;
+        /// Receiving the response.
+        double transfer;
+        /// The whole fetch (including redirects).
+        double total;
+        /// Bytes of body received (before any decoding).
+        uint64_t bytes;
+
+        /// Default constructor.
+        FetchTiming()
+            : resolve(0), connect(0), tls(0), wait(0), transfer(0), total(0),
+              bytes(0) { }
+
+        /// Add another's times and bytes to ours.
+        FetchTiming& operator+= (const FetchTiming& that)
+        {
+            resolve += that.resolve;
+            connect += that.connect;
+            tls += that.tls;
+            wait += that.wait;
+            transfer += that.transfer;
+            total += that.total;
+            bytes += that.bytes;
+            return *this;
+        }
+    };
+
+    /**
+     * @struct FetchRequest request.hh herdstat/fetcher/request.hh
+     * @brief A URL to fetch, the path to save it to and, once fetched, the
+     * result.
+     *
+     * If validators are set (and the implementation supports it), the
+     * fetch is conditional: if the remote file hasn't changed, path is
+     * left alone and modified is false.  path is replaced atomically: until
+     * the fetch succeeds, the body is written to a temporary file next to
+     * it.  If a sink is set, it receives the body as well, as it arrives.
+     * Bodies sent with a gzip or deflate content-encoding are decoded.
+     */
+
+    struct FetchRequest
+    {
+        /// URL string.
+        std::string url;
+        /// Path to save to.
+        std::string path;
+        /// Was it fetched successfully?
+        bool ok;
+        /// Why not (if known).
+        std::string error;
+        /// Might the failure go away if retried (e.g. a timeout)?
+        bool transient;
+        /// Validators of the local copy; updated with the response's.
+        Validators validators;
+        /// Was path (re)written?  False if the server said not modified.
+        bool modified;
+        /// Receives the body too (if not NULL).  Not owned.
+        FetchSink *sink;
+        /// Store the file gzip-compressed (the sink still gets it plain)?
+        bool compress;
+        /// Time spent and bytes received fetching it.
+        FetchTiming timing;
+
+        /** Constructor.
+         * @param u URL string.
+         * @param p Path to save to.
+         */
+        FetchRequest(const std::string& u, const std::string& p)
+            : url(u), path(p), ok(false), error(), transient(false),
+              validators(),
+              modified(false), sink(NULL), compress(false), timing() { }
+    };
+
+    /// Batch of fetch requests.
+    typedef std::vector<FetchRequest> FetchRequests;
+
+} // namespace herdstat
+
+#endif /* _HAVE_FETCHER_REQUEST_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,348 @@
+/*
+ * libherdstat -- herdstat/fetcher/scheduler.cc
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include <herdstat/util/file.hh>
+#include <herdstat/fetcher/fetcherimp.hh>
+#include <herdstat/fetcher/scheduler.hh>
+
+namespace herdstat {
+/****************************************************************************
+ * A fetch in progress, and the number of requests waiting for its result.
+ ****************************************************************************/
+struct FetchScheduler::Flight
+{
+    Flight() : done(false), result("", ""), waiters(0) { }
+
+    bool done;
+    FetchRequest result;
+    unsigned int waiters;
+};
+/****************************************************************************/
+static uint64_t
+now_ms()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (static_cast<uint64_t>(tv.tv_sec) * 1000) + (tv.tv_usec / 1000);
+}
+/****************************************************************************/
+FetchScheduler::FetchScheduler() throw()
+    : _mutex(), _cond(), _flights(), _active(), _counters(),
+      _seed(static_cast<unsigned int>(std::time(NULL) ^ getpid()))
+{
+}
+/****************************************************************************/
+FetchScheduler::~FetchScheduler() throw()
+{
+}
+/****************************************************************************/
+void
+FetchScheduler::fetch(const FetcherImp& imp, const FetcherOptions& opts,
+                      FetchRequests& requests)
+{
+    BacktraceContext c("herdstat::FetchScheduler::fetch()");
+
+    /* requests nobody is fetching yet (and their position in requests),
+     * and those that joined a fetch in flight */
+    FetchRequests own;
+    std::vector<FetchRequests::size_type> pos;
+    std::vector<std::pair<FetchRequests::size_type, Flight *> > joined;
+
+    {
+        util::MutexLock lock(_mutex);
+
+        for (FetchRequests::size_type n = 0 ; n < requests.size() ; ++n)
+        {
+            const std::string& url(requests[n].url);
+            flights_type::iterator i = _flights.find(url);
+            if (i == _flights.end())
+            {
+                _flights.insert(std::make_pair(url, new Flight()));
+                own.push_back(requests[n]);
+                pos.push_back(n);
+            }
+            else
+            {
+                ++(i->second->waiters);
+                ++_counters.coalesced;
+                joined.push_back(std::make_pair(n, i->second));
+            }
+        }
+    }
+
+    /* our own fetches first, as they might be what we're waiting for */
+    if (not own.empty())
+    {
+        this->run(imp, opts, own);
+        for (FetchRequests::size_type n = 0 ; n < own.size() ; ++n)
+            requests[pos[n]] = own[n];
+    }
+
+    for (std::size_t n = 0 ; n < joined.size() ; ++n)
+        this->join(joined[n].second, requests[joined[n].first]);
+}
+/****************************************************************************/
+void
+FetchScheduler::run(const FetcherImp& imp, const FetcherOptions& opts,
+                    FetchRequests& requests)
+{
+    /* per request: retries so far, when it may next be tried, and whether
+     * it's finished */
+    std::vector<unsigned int> tries(requests.size(), 0);
+    std::vector<uint64_t> due(requests.size(), 0);
+    std::vector<bool> done(requests.size(), false);
+    FetchRequests::size_type left = requests.size();
+
+    while (left > 0)
+    {
+        FetchRequests wave;
+        std::vector<FetchRequests::size_type> pos;
+
+        {
+            util::MutexLock lock(_mutex);
+
+            /* take whatever is due and has a free slot for its host */
+            while (true)
+            {
+                const uint64_t now = now_ms();
+                uint64_t next = 0;
+
+                for (FetchRequests::size_type n = 0 ; n < requests.size() and
+                     wave.size() < opts.max_parallel() ; ++n)
+                {
+                    if (done[n])
+                        continue;
+
+                    if (due[n] > now)
+                    {
+                        next = (next ? std::min(next, due[n]) : due[n]);
+                        continue;
+                    }
+
+                    unsigned int& active(_active[host_of(requests[n].url)]);
+                    if (active < opts.max_per_host())
+                    {
+                        ++active;
+                        wave.push_back(requests[n]);
+                        pos.push_back(n);
+                    }
+                }
+
+                if (not wave.empty())
+                    break;
+
+                /* wait for a slot to free up or a retry to come due */
+                if (next)
+                    _cond.wait(_mutex, static_cast<unsigned long>(next - now));
+                else
+                    _cond.wait(_mutex);
+            }
+        }
+
+        try
+        {
+            imp.fetch_all(wave);
+        }
+        catch (...)
+        {
+            /* don't leave anybody waiting */
+            util::MutexLock lock(_mutex);
+
+            for (std::size_t k = 0 ; k < wave.size() ; ++k)
+                this->release(wave[k].url);
+
+            for (FetchRequests::size_type n = 0 ; n < requests.size() ; ++n)
+            {
+                if (done[n])
+                    continue;
+                requests[n].ok = requests[n].transient = false;
+                requests[n].error.assign("fetch aborted");
+                this->publish(requests[n]);
+            }
+
+            _cond.broadcast();
+            throw;
+        }
+
+        /* outside the lock, as it means a stat() */
+        std::vector<uint64_t> sizes(wave.size(), 0);
+        for (std::size_t k = 0 ; k < wave.size() ; ++k)
+        {
+            if (wave[k].ok and wave[k].modified)
+                sizes[k] = util::Stat(wave[k].path).size();
+        }
+
+        util::MutexLock lock(_mutex);
+
+        for (std::size_t k = 0 ; k < wave.size() ; ++k)
+        {
+            const FetchRequests::size_type n = pos[k];
+            requests[n] = wave[k];
+            this->release(wave[k].url);
+            ++_counters.requests;
+
+            if (wave[k].ok)
+            {
+                if (wave[k].modified)
+                    _counters.bytes += sizes[k];
+                else
+                    ++_counters.cache_hits;
+            }
+            else if (wave[k].transient and tries[n] < opts.retries())
+            {
+                ++_counters.retries;
+                due[n] = now_ms() + this->backoff(opts.retry_delay(),
+                                                  tries[n]++);
+                continue;
+            }
+            else
+                ++_counters.failures;
+
+            done[n] = true;
+            --left;
+            this->publish(requests[n]);
+        }
+
+        _cond.broadcast();
+    }
+}
+/****************************************************************************/
+void
+FetchScheduler::release(const std::string& url)
+{
+    hosts_type::iterator i = _active.find(host_of(url));
+    assert(i != _active.end() and i->second > 0);
+    if (--(i->second) == 0)
+        _active.erase(i);
+}
+/****************************************************************************/
+void
+FetchScheduler::publish(const FetchRequest& req)
+{
+    flights_type::iterator i = _flights.find(req.url);
+    assert(i != _flights.end());
+
+    Flight * const flight = i->second;
+    _flights.erase(i);
+
+    if (flight->waiters == 0)
+    {
+        delete flight;
+        return;
+    }
+
+    flight->result = req;
+    flight->done = true;
+}
+/****************************************************************************/
+void
+FetchScheduler::join(Flight *flight, FetchRequest& req)
+{
+    std::string path;
+
+    {
+        util::MutexLock lock(_mutex);
+        while (not flight->done)
+            _cond.wait(_mutex);
+
+        const FetchRequest& result(flight->result);
+        req.ok = result.ok;
+        req.error = result.error;
+        req.transient = result.transient;
+        req.validators = result.validators;
+        req.modified = result.modified;
+        path = result.path;
+
+        if (--(flight->waiters) == 0)
+            delete flight;
+    }
+
+    if (not req.ok or path == req.path)
+        return;
+
+    /* fetched to somewhere else */
+    try
+    {
+        util::copy_file_atomic(path, req.path);
+        req.modified = true;
+    }
+    catch (const FileException& e)
+    {
+        req.ok = false;
+        req.error.assign(e.what());
+    }
+}
+/****************************************************************************/
+unsigned long
+FetchScheduler::backoff(unsigned int delay, unsigned int n)
+{
+    /* delay * 2^n, of which a random half or more */
+    const unsigned long max =
+        static_cast<unsigned long>(delay) << std::min(n, 16U);
+    return (max - (rand_r(&_seed) % (max / 2 + 1)));
+}
+/****************************************************************************/
+FetchCounters
+FetchScheduler::counters() const
+{
+    util::MutexLock lock(_mutex);
+    return _counters;
+}
+/****************************************************************************/
+void
+FetchScheduler::reset_counters()
+{
+    util::MutexLock lock(_mutex);
+    _counters = FetchCounters();
+}
+/****************************************************************************/
+std::string
+FetchScheduler::host_of(const std::string& url)
+{
+    std::string::size_type begin = url.find("://");
+    begin = (begin == std::string::npos ? 0 : begin + 3);
+
+    std::string::size_type end = url.find_first_of("/?#", begin);
+    if (end == std::string::npos)
+        end = url.size();
+
+    /* strip any user info */
+    const std::string::size_type at = url.rfind('@', end);
+    if (at != std::string::npos and at >= begin)
+        begin = at + 1;
+
+    return url.substr(begin, end - begin);
+}
+/****************************************************************************/
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,164 @@
+/*
+ * libherdstat -- herdstat/fetcher/scheduler.hh
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_FETCHER_SCHEDULER_HH
+#define _HAVE_FETCHER_SCHEDULER_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/fetcher/scheduler.hh
+ * @brief Defines the FetchScheduler class.
+ */
+
+#include <map>
+#include <string>
+#include <stdint.h>
+#include <herdstat/noncopyable.hh>
+#include <herdstat/util/thread.hh>
+#include <herdstat/fetcher/options.hh>
+#include <herdstat/fetcher/request.hh>
+
+namespace herdstat {
+
+    class FetcherImp;
+
+    /**
+     * @struct FetchCounters scheduler.hh herdstat/fetcher/scheduler.hh
+     * @brief Running totals kept by the FetchScheduler.
+     */
+
+    struct FetchCounters
+    {
+        /// Transfers performed (including retries).
+        unsigned long requests;
+        /// Requests that joined an identical one already in flight.
+        unsigned long coalesced;
+        /// Transfers the server answered with "not modified".
+        unsigned long cache_hits;
+        /// Transfers that were retried after a transient failure.
+        unsigned long retries;
+        /// Requests that failed for good.
+        unsigned long failures;
+        /// Bytes written to fetched files.
+        uint64_t bytes;
+
+        /// Default constructor.
+        FetchCounters()
+            : requests(0), coalesced(0), cache_hits(0), retries(0),
+              failures(0), bytes(0) { }
+    };
+
+    /**
+     * @class FetchScheduler scheduler.hh herdstat/fetcher/scheduler.hh
+     * @brief Coordinates the fetches of all Fetcher objects in the process.
+     *
+     * Every Fetcher hands its requests to the GlobalFetchScheduler(), which
+     *  - coalesces requests for a URL that is already being fetched: they
+     *    wait for that fetch and share its result (copying the file if it
+     *    was saved elsewhere; their sink receives nothing);
+     *  - retries transient failures (see FetchRequest::transient) up to
+     *    FetcherOptions::retries() times, with exponential backoff and
+     *    jitter;
+     *  - runs no more than FetcherOptions::max_per_host() transfers from
+     *    one host at a time.
+     *
+     * The only instance is accessed through GlobalFetchScheduler().  All
+     * public members are thread-safe.
+     */
+
+    class FetchScheduler : private Noncopyable
+    {
+        public:
+            /** Fetch a batch of requests using the given implementation.
+             * Results are stored in the requests, as with
+             * FetcherImp::fetch_all().
+             * @param imp Fetcher implementation.
+             * @param opts Options (retries and limits) to fetch with.
+             * @param requests Reference to requests.
+             */
+            void fetch(const FetcherImp& imp, const FetcherOptions& opts,
+                       FetchRequests& requests);
+
+            /// Get a snapshot of the counters.
+            FetchCounters counters() const;
+
+            /// Reset the counters to zero.
+            void reset_counters();
+
+            /** Get the host (and port, if any) part of a URL.
+             * @param url URL string.
+             */
+            static std::string host_of(const std::string& url);
+
+        private:
+            friend FetchScheduler& GlobalFetchScheduler();
+            struct Flight;
+            typedef std::map<std::string, Flight *> flights_type;
+            typedef std::map<std::string, unsigned int> hosts_type;
+
+            /// Only GlobalFetchScheduler() can instantiate this class.
+            FetchScheduler() throw();
+            /// Destructor.
+            ~FetchScheduler() throw();
+
+            /// Fetch requests nobody else is fetching, retrying as needed.
+            void run(const FetcherImp& imp, const FetcherOptions& opts,
+                     FetchRequests& requests);
+            /// Free the host slot taken for a URL.
+            void release(const std::string& url);
+            /// Hand a finished request's result to its waiters.
+            void publish(const FetchRequest& req);
+            /// Wait for the in-flight fetch a request joined.
+            void join(Flight *flight, FetchRequest& req);
+            /// Delay before the nth retry (with jitter).
+            unsigned long backoff(unsigned int delay, unsigned int n);
+
+            mutable util::Mutex _mutex;
+            util::Condition _cond;
+            /// in-flight fetches, by URL.
+            flights_type _flights;
+            /// running transfers, by host.
+            hosts_type _active;
+            FetchCounters _counters;
+            unsigned int _seed;
+    };
+
+    /**
+     * Sole access point to the FetchScheduler class.
+     * @returns reference to a local static instance of FetchScheduler.
+     */
+
+    inline FetchScheduler&
+    GlobalFetchScheduler()
+    {
+        static FetchScheduler s;
+        return s;
+    }
+
+} // namespace herdstat
+
+#endif /* _HAVE_FETCHER_SCHEDULER_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
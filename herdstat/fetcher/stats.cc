@@ -0,0 +1,181 @@
+/*
+ * libherdstat -- herdstat/fetcher/stats.cc
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <algorithm>
+#include <vector>
+#include <herdstat/util/string.hh>
+#include <herdstat/fetcher/stats.hh>
+
+namespace herdstat {
+/****************************************************************************/
+static std::string
+json_string(const std::string& s)
+{
+    std::string result("\"");
+
+    std::string::const_iterator i;
+    for (i = s.begin() ; i != s.end() ; ++i)
+    {
+        switch (*i)
+        {
+            case '"':  result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\n': result += "\\n"; break;
+            case '\r': result += "\\r"; break;
+            case '\t': result += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(*i) < 0x20)
+                    result += util::sprintf("\\u%04x", *i);
+                else
+                    result += *i;
+        }
+    }
+
+    return result + "\"";
+}
+/****************************************************************************/
+static std::string
+json_ms(double ms)
+{
+    return util::sprintf("%.3f", ms);
+}
+/****************************************************************************/
+static void
+json_stat(std::ostream& stream, const FetchStat& stat)
+{
+    const FetchTiming& t(stat.timing);
+    stream << "\"fetches\":" << stat.fetches
+        << ",\"failures\":" << stat.failures
+        << ",\"not_modified\":" << stat.not_modified
+        << ",\"bytes\":" << t.bytes
+        << ",\"resolve_ms\":" << json_ms(t.resolve)
+        << ",\"connect_ms\":" << json_ms(t.connect)
+        << ",\"tls_ms\":" << json_ms(t.tls)
+        << ",\"wait_ms\":" << json_ms(t.wait)
+        << ",\"transfer_ms\":" << json_ms(t.transfer)
+        << ",\"total_ms\":" << json_ms(t.total)
+        << ",\"slowest_ms\":" << json_ms(stat.slowest);
+}
+/****************************************************************************
+ * Orders URLs by the total time spent fetching them, slowest first.
+ ****************************************************************************/
+struct SlowerURL
+{
+    bool operator()(const FetchStats::container_type::value_type *a,
+                    const FetchStats::container_type::value_type *b) const
+    {
+        if (a->second.timing.total != b->second.timing.total)
+            return (a->second.timing.total > b->second.timing.total);
+        return (a->first < b->first);
+    }
+};
+/****************************************************************************/
+FetchStats::FetchStats() throw()
+    : _mutex(), _total(), _urls()
+{
+}
+/****************************************************************************/
+FetchStats::~FetchStats() throw()
+{
+}
+/****************************************************************************/
+void
+FetchStats::record(const FetchRequest& req)
+{
+    util::MutexLock lock(_mutex);
+
+    FetchStat * const stats[] = { &_total, &_urls[req.url] };
+    for (std::size_t i = 0 ; i < sizeof(stats) / sizeof(stats[0]) ; ++i)
+    {
+        FetchStat& stat(*stats[i]);
+        ++stat.fetches;
+        if (not req.ok)
+            ++stat.failures;
+        else if (not req.modified)
+            ++stat.not_modified;
+        stat.timing += req.timing;
+        stat.slowest = std::max(stat.slowest, req.timing.total);
+    }
+}
+/****************************************************************************/
+FetchStat
+FetchStats::total() const
+{
+    util::MutexLock lock(_mutex);
+    return _total;
+}
+/****************************************************************************/
+FetchStats::container_type
+FetchStats::by_url() const
+{
+    util::MutexLock lock(_mutex);
+    return _urls;
+}
+/****************************************************************************/
+bool
+FetchStats::empty() const
+{
+    util::MutexLock lock(_mutex);
+    return (_total.fetches == 0);
+}
+/****************************************************************************/
+void
+FetchStats::clear()
+{
+    util::MutexLock lock(_mutex);
+    _total = FetchStat();
+    _urls.clear();
+}
+/****************************************************************************/
+void
+FetchStats::dump_json(std::ostream& stream) const
+{
+    util::MutexLock lock(_mutex);
+
+    std::vector<const container_type::value_type *> urls;
+    container_type::const_iterator i;
+    for (i = _urls.begin() ; i != _urls.end() ; ++i)
+        urls.push_back(&(*i));
+    std::sort(urls.begin(), urls.end(), SlowerURL());
+
+    stream << "{";
+    json_stat(stream, _total);
+    stream << ",\"urls\":[";
+
+    for (std::size_t n = 0 ; n < urls.size() ; ++n)
+    {
+        stream << (n ? ",{" : "{") << "\"url\":" << json_string(urls[n]->first)
+            << ",";
+        json_stat(stream, urls[n]->second);
+        stream << "}";
+    }
+
+    stream << "]}";
+}
+/****************************************************************************/
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
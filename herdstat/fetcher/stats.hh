@@ -0,0 +1,131 @@
+/*
+ * libherdstat -- herdstat/fetcher/stats.hh
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_FETCHER_STATS_HH
+#define _HAVE_FETCHER_STATS_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/fetcher/stats.hh
+ * @brief Defines the FetchStats class.
+ */
+
+#include <map>
+#include <string>
+#include <ostream>
+#include <herdstat/noncopyable.hh>
+#include <herdstat/util/thread.hh>
+#include <herdstat/fetcher/request.hh>
+
+namespace herdstat {
+
+    /**
+     * @struct FetchStat stats.hh herdstat/fetcher/stats.hh
+     * @brief Totals for a number of fetches.
+     */
+
+    struct FetchStat
+    {
+        /// Number of fetches.
+        unsigned long fetches;
+        /// Fetches that failed.
+        unsigned long failures;
+        /// Fetches the server answered with "not modified".
+        unsigned long not_modified;
+        /// Sum of the fetches' times and bytes received.
+        FetchTiming timing;
+        /// Total time (in milliseconds) of the slowest fetch.
+        double slowest;
+
+        /// Default constructor.
+        FetchStat()
+            : fetches(0), failures(0), not_modified(0), timing(),
+              slowest(0) { }
+    };
+
+    /**
+     * @class FetchStats stats.hh herdstat/fetcher/stats.hh
+     * @brief Collects the timing of fetches, overall and by URL.
+     *
+     * Every Fetcher records each request it fetches in its stats() (see
+     * FetchRequest::timing).  Requests that joined a fetch of the same URL
+     * already in flight (see FetchScheduler) are counted, but took no time
+     * of their own.  All members are thread-safe.
+     *
+     * @section example Example
+     *
+@code
+const herdstat::Fetcher fetcher;
+fetcher.fetch_all(requests);
+fetcher.stats().dump_json(std::cerr);
+@endcode
+     */
+
+    class FetchStats : private Noncopyable
+    {
+        public:
+            /// Totals by URL.
+            typedef std::map<std::string, FetchStat> container_type;
+
+            /// Default constructor.
+            FetchStats() throw();
+
+            /// Destructor.
+            ~FetchStats() throw();
+
+            /** Record a finished request.
+             * @param req const reference to a FetchRequest.
+             */
+            void record(const FetchRequest& req);
+
+            /// Get the totals of all fetches recorded.
+            FetchStat total() const;
+
+            /// Get a snapshot of the totals of each URL.
+            container_type by_url() const;
+
+            /// Have any fetches been recorded?
+            bool empty() const;
+
+            /// Forget all fetches recorded.
+            void clear();
+
+            /** Write the totals, and those of each URL (slowest first), as
+             * a JSON object.  Times are in milliseconds.
+             * @param stream Output stream.
+             */
+            void dump_json(std::ostream& stream) const;
+
+        private:
+            mutable util::Mutex _mutex;
+            FetchStat _total;
+            container_type _urls;
+    };
+
+} // namespace herdstat
+
+#endif /* _HAVE_FETCHER_STATS_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
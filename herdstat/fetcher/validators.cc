@@ -0,0 +1,85 @@
+/*
+ * libherdstat -- herdstat/fetcher/validators.cc
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <fstream>
+#include <unistd.h>
+
+#include <herdstat/fetcher/validators.hh>
+
+namespace herdstat {
+/****************************************************************************
+ * Stored as HTTP-style header lines:
+ *
+ *   ETag: "abc123"
+ *   Last-Modified: Sat, 01 Apr 2006 12:00:00 GMT
+ ****************************************************************************/
+bool
+Validators::load(const std::string& path)
+{
+    this->clear();
+
+    std::ifstream stream(path_for(path).c_str());
+    if (not stream)
+        return false;
+
+    std::string line;
+    while (std::getline(stream, line))
+    {
+        if (line.compare(0, 6, "ETag: ") == 0)
+            etag.assign(line, 6, std::string::npos);
+        else if (line.compare(0, 15, "Last-Modified: ") == 0)
+            last_modified.assign(line, 15, std::string::npos);
+    }
+
+    return not this->empty();
+}
+/****************************************************************************/
+void
+Validators::save(const std::string& path) const
+{
+    const std::string vpath(path_for(path));
+
+    if (this->empty())
+    {
+        unlink(vpath.c_str());
+        return;
+    }
+
+    std::ofstream stream(vpath.c_str());
+    if (not etag.empty())
+        stream << "ETag: " << etag << std::endl;
+    if (not last_modified.empty())
+        stream << "Last-Modified: " << last_modified << std::endl;
+    stream.close();
+
+    /* don't leave a partially written file behind */
+    if (not stream)
+        unlink(vpath.c_str());
+}
+/****************************************************************************/
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
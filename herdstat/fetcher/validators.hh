@@ -0,0 +1,85 @@
+/*
+ * libherdstat -- herdstat/fetcher/validators.hh
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_FETCHER_VALIDATORS_HH
+#define _HAVE_FETCHER_VALIDATORS_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/fetcher/validators.hh
+ * @brief Defines the Validators struct.
+ */
+
+#include <string>
+
+namespace herdstat {
+
+    /**
+     * @struct Validators validators.hh herdstat/fetcher/validators.hh
+     * @brief HTTP cache validators (ETag and Last-Modified) of a fetched
+     * file.
+     *
+     * Validators are stored alongside the file they belong to (see
+     * path_for()) so that the next fetch of the same file can be made
+     * conditional.
+     */
+
+    struct Validators
+    {
+        /// ETag response header (including quotes).
+        std::string etag;
+        /// Last-Modified response header.
+        std::string last_modified;
+
+        /// Are both validators unset?
+        bool empty() const { return (etag.empty() and last_modified.empty()); }
+
+        /// Unset both validators.
+        void clear() { etag.clear(); last_modified.clear(); }
+
+        /** Load the validators stored for a file.
+         * @param path Path to fetched file.
+         * @returns False if none are stored.
+         */
+        bool load(const std::string& path);
+
+        /** Store the validators for a file (or remove the stored ones if
+         * empty()).
+         * @param path Path to fetched file.
+         */
+        void save(const std::string& path) const;
+
+        /** Get the path validators for a file are stored at.
+         * @param path Path to fetched file.
+         */
+        static std::string path_for(const std::string& path)
+        { return path + ".validators"; }
+    };
+
+} // namespace herdstat
+
+#endif /* _HAVE_FETCHER_VALIDATORS_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
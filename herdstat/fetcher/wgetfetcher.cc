@@ -31,6 +31,20 @@
 
 namespace herdstat {
 /****************************************************************************/
+static std::string
+shell_quote(const std::string& s)
+{
+    std::string result("'");
+    for (std::string::size_type i = 0 ; i < s.size() ; ++i)
+    {
+        if (s[i] == '\'')
+            result += "'\\''";
+        else
+            result += s[i];
+    }
+    return result + "'";
+}
+/****************************************************************************/
 WgetFetcher::WgetFetcher(const FetcherOptions& opts) throw()
     : FetcherImp(opts)
 {
@@ -49,9 +63,9 @@ WgetFetcher::fetch(const std::string& url, const std::string& path) const
     std::string opts("-r -t3 -T15");
     opts += (options().verbose() ? " -v" : " -q");
 
-    return (std::system(util::sprintf("%s %s -O %s '%s'", WGET,
-                opts.c_str(), path.c_str(),
-                url.c_str()).c_str()) == EXIT_SUCCESS);
+    return (std::system(util::sprintf("%s %s -O %s %s", WGET,
+                opts.c_str(), shell_quote(path).c_str(),
+                shell_quote(url).c_str()).c_str()) == EXIT_SUCCESS);
 }
 /****************************************************************************/
 } // namespace herdstat
@@ -24,18 +24,41 @@
 # include "config.h"
 #endif
 
+#include <algorithm>
+#include <cassert>
+#include <herdstat/util/crc32c.hh>
 #include <herdstat/io/binary_stream.hh>
 
 namespace herdstat {
 namespace io {
+/*** static members *********************************************************/
+const std::size_t BinaryStream::default_buffer_size = 128 * 1024;
+const std::size_t BinaryStream::max_block_size = 16 * 1024 * 1024;
+/****************************************************************************/
+/* framed streams start with this, followed by the magic number and version */
+static const unsigned char signature[] = { 'H', 'S', 'B', 1 };
+static const std::size_t header_size = sizeof(signature) + 8;
 /****************************************************************************/
 BinaryStream::BinaryStream() throw()
-    : _path(), _stream(NULL), _open(false)
+    : _path(), _stream(NULL), _open(false), _writing(false), _framed(false),
+      _magic(0), _version(0), _eof(false), _error(false),
+      _size(default_buffer_size), _buf(_size), _pos(0), _end(0)
 {
 }
 /****************************************************************************/
 BinaryStream::BinaryStream(const std::string& path) throw ()
-    : _path(path), _stream(NULL), _open(false)
+    : _path(path), _stream(NULL), _open(false), _writing(false),
+      _framed(false), _magic(0), _version(0), _eof(false), _error(false),
+      _size(default_buffer_size), _buf(_size), _pos(0), _end(0)
+{
+}
+/****************************************************************************/
+BinaryStream::BinaryStream(const std::string& path, uint32_t magic,
+                           uint32_t version) throw ()
+    : _path(path), _stream(NULL), _open(false), _writing(false),
+      _framed(true), _magic(magic), _version(version), _eof(false),
+      _error(false), _size(default_buffer_size), _buf(_size), _pos(0),
+      _end(0)
 {
 }
 /****************************************************************************/
@@ -53,7 +76,17 @@ BinaryStream::open() throw ()
 
     _stream = std::fopen(_path.c_str(), this->mode());
 
+    /* we do our own buffering */
+    if (_stream)
+        std::setvbuf(_stream, NULL, _IONBF, 0);
+
+    _writing = (this->mode()[0] != 'r');
+    _eof = _error = false;
+    _pos = _end = 0;
     _open = true;
+
+    if (_stream and _framed)
+        _error = not (_writing ? this->write_header() : this->read_header());
 }
 /****************************************************************************/
 void
@@ -63,21 +96,282 @@ BinaryStream::open(const std::string& path) throw ()
 	return;
 
     _path.assign(path);
+    _framed = false;
 
     this->open();
 }
 /****************************************************************************/
 void
+BinaryStream::open(const std::string& path, uint32_t magic,
+                   uint32_t version) throw ()
+{
+    if (_open)
+	return;
+
+    _path.assign(path);
+    _framed = true;
+    _magic = magic;
+    _version = version;
+
+    this->open();
+}
+/****************************************************************************/
+bool
 BinaryStream::close() throw()
 {
     if (not _open)
-	return;
+	return true;
 
-    assert(_stream != NULL);
-    std::fclose(_stream);
-    _stream = NULL;
+    bool ok = false;
 
+    if (_stream)
+    {
+        /* an empty block marks the end of a framed stream */
+        if (_writing and this->flush_buffer() and _framed and
+            std::fputc(0, _stream) == EOF)
+            _error = true;
+        ok = (std::fclose(_stream) == 0 and not _error);
+        _stream = NULL;
+    }
+
+    _pos = _end = 0;
     _open = false;
+    return ok;
+}
+/****************************************************************************/
+void
+BinaryStream::set_buffer_size(std::size_t n) throw()
+{
+    n = std::max<std::size_t>(n, 1);
+
+    if (_writing)
+        this->flush_buffer();
+
+    /* keep unread data, at the front of the new buffer */
+    const std::size_t unread = _end - _pos;
+    std::vector<char> buf(std::max(n, unread));
+    if (unread > 0)
+        std::memcpy(&buf[0], &_buf[_pos], unread);
+
+    _buf.swap(buf);
+    _size = n;
+    _pos = 0;
+    _end = unread;
+}
+/****************************************************************************/
+bool
+BinaryStream::fill() throw()
+{
+    assert(_pos == _end);
+    _pos = _end = 0;
+
+    if (not _stream or _eof or _error)
+        return false;
+
+    if (_framed)
+        return this->read_block();
+
+    /* a buffer kept bigger by set_buffer_size() shrinks now */
+    if (_buf.size() != _size)
+        std::vector<char>(_size).swap(_buf);
+
+    _end = std::fread(&_buf[0], 1, _size, _stream);
+    if (_end > 0)
+        return true;
+
+    if (std::ferror(_stream))
+        _error = true;
+    else
+        _eof = true;
+    return false;
+}
+/****************************************************************************/
+bool
+BinaryStream::underflow(void *v, std::size_t n) throw()
+{
+    char *dst = static_cast<char *>(v);
+
+    /* whatever is left in the buffer first */
+    std::size_t len = _end - _pos;
+    if (len > 0)
+    {
+        std::memcpy(dst, &_buf[_pos], len);
+        dst += len;
+        n -= len;
+        _pos = _end;
+    }
+
+    /* too big to be worth buffering (framed data must go through it) */
+    if (n >= _size and not _framed)
+    {
+        _pos = _end = 0;
+        if (not _stream or _eof or _error)
+            return false;
+
+        if (std::fread(dst, 1, n, _stream) == n)
+            return true;
+
+        if (std::ferror(_stream))
+            _error = true;
+        else
+            _eof = true;
+        return false;
+    }
+
+    while (n > 0)
+    {
+        if (not this->fill())
+            return false;
+
+        len = std::min(n, _end);
+        std::memcpy(dst, &_buf[0], len);
+        dst += len;
+        n -= len;
+        _pos = len;
+    }
+
+    return true;
+}
+/****************************************************************************/
+bool
+BinaryStream::flush_buffer() throw()
+{
+    if (not _stream or _error)
+        return false;
+
+    if (_end > 0)
+    {
+        if (_framed)
+            this->write_blocks(&_buf[0], _end);
+        else if (std::fwrite(&_buf[0], 1, _end, _stream) != _end)
+            _error = true;
+    }
+
+    _end = 0;
+    return (not _error);
+}
+/****************************************************************************/
+bool
+BinaryStream::overflow(const void *v, std::size_t n) throw()
+{
+    if (not this->flush_buffer())
+        return false;
+
+    /* too big to be worth buffering */
+    if (n >= _buf.size())
+    {
+        if (_framed)
+            return this->write_blocks(static_cast<const char *>(v), n);
+        if (std::fwrite(v, 1, n, _stream) != n)
+            _error = true;
+        return (not _error);
+    }
+
+    std::memcpy(&_buf[0], v, n);
+    _end = n;
+    return true;
+}
+/****************************************************************************/
+bool
+BinaryStream::write_header() throw()
+{
+    unsigned char header[header_size];
+    std::memcpy(header, signature, sizeof(signature));
+    BinaryTraits<uint32_t>::encode(_magic, header + sizeof(signature));
+    BinaryTraits<uint32_t>::encode(_version, header + sizeof(signature) + 4);
+
+    return (std::fwrite(header, 1, header_size, _stream) == header_size);
+}
+/****************************************************************************/
+bool
+BinaryStream::read_header() throw()
+{
+    unsigned char header[header_size];
+    if (std::fread(header, 1, header_size, _stream) != header_size or
+        std::memcmp(header, signature, sizeof(signature)) != 0)
+        return false;
+
+    uint32_t magic, version;
+    BinaryTraits<uint32_t>::decode(header + sizeof(signature), magic);
+    BinaryTraits<uint32_t>::decode(header + sizeof(signature) + 4, version);
+
+    return (magic == _magic and version == _version);
+}
+/****************************************************************************/
+bool
+BinaryStream::write_blocks(const char *data, std::size_t n) throw()
+{
+    /* each block is its (varint) length, the data, and its CRC-32C */
+    while (n > 0 and not _error)
+    {
+        const std::size_t len = std::min(n, max_block_size);
+
+        unsigned char head[max_varint_size], tail[4];
+        const std::size_t headlen = encode_varint(len, head);
+        BinaryTraits<uint32_t>::encode(util::crc32c(data, len), tail);
+
+        if (std::fwrite(head, 1, headlen, _stream) != headlen or
+            std::fwrite(data, 1, len, _stream) != len or
+            std::fwrite(tail, 1, sizeof(tail), _stream) != sizeof(tail))
+            _error = true;
+
+        data += len;
+        n -= len;
+    }
+
+    return (not _error);
+}
+/****************************************************************************/
+bool
+BinaryStream::read_block() throw()
+{
+    /* a file that ends before the empty last block was cut short */
+    unsigned char head[max_varint_size];
+    std::size_t headlen = 0;
+    uint64_t len = 0;
+    while (headlen < max_varint_size)
+    {
+        const int c = std::fgetc(_stream);
+        if (c == EOF)
+            break;
+        head[headlen++] = static_cast<unsigned char>(c);
+        if (not (c & 0x80))
+            break;
+    }
+
+    if (decode_varint(head, headlen, len) == 0 or len > max_block_size)
+    {
+        _error = true;
+        return false;
+    }
+
+    if (len == 0)
+    {
+        _eof = true;
+        return false;
+    }
+
+    if (_buf.size() < len)
+        _buf.resize(len);
+
+    unsigned char tail[4];
+    uint32_t crc;
+    if (std::fread(&_buf[0], 1, len, _stream) != len or
+        std::fread(tail, 1, sizeof(tail), _stream) != sizeof(tail))
+    {
+        _error = true;
+        return false;
+    }
+
+    BinaryTraits<uint32_t>::decode(tail, crc);
+    if (crc != util::crc32c(&_buf[0], len))
+    {
+        _error = true;
+        return false;
+    }
+
+    _end = len;
+    return true;
 }
 /****************************************************************************/
 BinaryIStream::BinaryIStream() throw()
@@ -91,6 +385,13 @@ BinaryIStream::BinaryIStream(const std::string& path) throw ()
     this->open();
 }
 /****************************************************************************/
+BinaryIStream::BinaryIStream(const std::string& path, uint32_t magic,
+                             uint32_t version) throw ()
+    : BinaryStream(path, magic, version)
+{
+    this->open();
+}
+/****************************************************************************/
 BinaryIStream::~BinaryIStream() throw()
 {
 }
@@ -101,6 +402,64 @@ BinaryIStream::mode() const
     return "rb";
 }
 /****************************************************************************/
+void
+BinaryIStream::read_string(std::string& str)
+{
+    std::string::size_type len = 0;
+    this->read_varint(len);
+
+    if (not *this)
+        return;
+
+    /* straight from the buffer; it's only as big as what's actually there,
+     * should len be garbage */
+    str.clear();
+    str.reserve(std::min(len, this->buffer_size()));
+
+    while (len > 0)
+    {
+        if (this->available() == 0 and not this->fill())
+            return;
+
+        const std::size_t n = std::min(len, this->available());
+        str.append(this->next(), n);
+        this->advance(n);
+        len -= n;
+    }
+}
+/****************************************************************************/
+bool
+BinaryIStream::read_uint64(uint64_t& v)
+{
+    /* decode in place if the buffer holds enough for any varint */
+    if (this->available() >= max_varint_size)
+    {
+        const std::size_t n = decode_varint(
+            reinterpret_cast<const unsigned char *>(this->next()),
+            this->available(), v);
+        if (n == 0)
+        {
+            this->fail();
+            return false;
+        }
+
+        this->advance(n);
+        return true;
+    }
+
+    unsigned char buf[max_varint_size];
+    for (std::size_t i = 0 ; i < max_varint_size ; ++i)
+    {
+        if (not this->get(&buf[i], 1))
+            return false;
+        if (not (buf[i] & 0x80))
+            return (decode_varint(buf, i + 1, v) != 0);
+    }
+
+    this->fail();
+    return false;
+}
+/****************************************************************************/
 BinaryOStream::BinaryOStream() throw()
     : BinaryStream()
 {
@@ -112,10 +471,23 @@ BinaryOStream::BinaryOStream(const std::string& path) throw ()
     this->open();
 }
 /****************************************************************************/
+BinaryOStream::BinaryOStream(const std::string& path, uint32_t magic,
+                             uint32_t version) throw ()
+    : BinaryStream(path, magic, version)
+{
+    this->open();
+}
+/****************************************************************************/
 BinaryOStream::~BinaryOStream() throw()
 {
 }
 /****************************************************************************/
+bool
+BinaryOStream::flush() throw()
+{
+    return this->flush_buffer();
+}
+/****************************************************************************/
 const char * const
 BinaryOStream::mode() const
 {
@@ -34,8 +34,12 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 #include <cstdlib>
 #include <cstdio>
+#include <cstring>
+#include <stdint.h>
+#include <herdstat/io/binary_traits.hh>
 
 namespace herdstat {
 namespace io {
@@ -43,11 +47,37 @@ namespace io {
     /**
      * @class BinaryStream binary_stream.hh herdstat/io/binary_stream.hh
      * @brief C++-like stream interface for C's fread/fwrite.
+     *
+     * Streams do their own buffering (stdio's is turned off), so that
+     * reading or writing a value is usually just a copy to or from the
+     * buffer, and the file is read and written a buffer at a time.  Values
+     * larger than the buffer go straight to or from the file.
+     *
+     * Values are stored as described by BinaryTraits, so files are
+     * portable between hosts; string lengths are stored as varints.
+     * Container sizes (std::size_t's width varies) should be written with
+     * write_varint() rather than as is.
+     *
+     * @section framing Framing
+     *
+     * A stream opened with open(path, magic, version) is framed: the file
+     * starts with a header holding the given magic number and (schema)
+     * version, and the data is written in blocks, each followed by its
+     * CRC-32C, and ended by an empty block.  A reader opened with a magic
+     * number or version other than the file's, or that comes across a
+     * block that doesn't match its checksum or a file that was cut short,
+     * fails as it would on a read error.  Framed files can't be read with
+     * MappedBinaryReader.
      */
 
     class BinaryStream
     {
 	public:
+            /// Default buffer size (in bytes).
+            static const std::size_t default_buffer_size;
+            /// Maximum size of a block of a framed stream (in bytes).
+            static const std::size_t max_block_size;
+
             /// Destructor.
 	    virtual ~BinaryStream() throw();
 
@@ -56,11 +86,36 @@ namespace io {
              */
 	    void open(const std::string& path) throw ();
 
-            /// Close stream.
-	    void close() throw();
+            /** Open framed stream.  A writer writes the header; a reader
+             * reads it and fails unless it matches.
+             * @param path path of file to open.
+             * @param magic Magic number identifying the kind of file.
+             * @param version Version of the file's contents.
+             */
+            void open(const std::string& path, uint32_t magic,
+                      uint32_t version) throw ();
+
+            /** Close stream (writing out anything still buffered).
+             * @returns False if anything written failed to be.
+             */
+	    bool close() throw();
+
+            /// Get buffer size (in bytes).
+            inline std::size_t buffer_size() const { return _size; }
+
+            /** Set buffer size.  Can be called at any time; a writer's
+             * buffer is written out first, and a reader keeps what it has
+             * buffered but not yet read.
+             * @param n Buffer size in bytes (0 is treated as 1).
+             */
+            void set_buffer_size(std::size_t n) throw();
 
             /// Is stream open?
 	    inline bool is_open() const { return _open; }
+            /// Is stream framed?
+            inline bool is_framed() const { return _framed; }
+            /// Put stream into a failed state (e.g. on bad data).
+            inline void fail() { _error = true; }
             /// Get path.
 	    inline const std::string& path() const { return _path; }
 
@@ -73,8 +128,7 @@ namespace io {
 
 	    inline bool operator!() const
 	    {
-		return ((_stream == NULL) or (std::ferror(_stream)) or
-		        (std::feof(_stream)));
+		return ((_stream == NULL) or _error or _eof);
 	    }
             ///@}
 
@@ -89,6 +143,14 @@ namespace io {
              */
 	    BinaryStream(const std::string& path) throw ();
 
+            /** Constructor for framed streams.
+             * @param path Path of file.
+             * @param magic Magic number identifying the kind of file.
+             * @param version Version of the file's contents.
+             */
+            BinaryStream(const std::string& path, uint32_t magic,
+                         uint32_t version) throw ();
+
             /// Open stream (path already set).
             void open() throw();
 
@@ -101,10 +163,74 @@ namespace io {
             /// Get underlying FILE pointer.
 	    inline FILE * const stream() const { return _stream; }
 
+            /** Take n bytes from the buffer (reading more if needed).
+             * @returns False on error or end of file.
+             */
+            inline bool get(void *v, std::size_t n)
+            {
+                if (_end - _pos < n)
+                    return this->underflow(v, n);
+                std::memcpy(v, &_buf[_pos], n);
+                _pos += n;
+                return true;
+            }
+
+            /** Add n bytes to the buffer (writing it out if full).
+             * @returns False on error.
+             */
+            inline bool put(const void *v, std::size_t n)
+            {
+                if (_buf.size() - _end < n)
+                    return this->overflow(v, n);
+                std::memcpy(&_buf[_end], v, n);
+                _end += n;
+                return true;
+            }
+
+            /// Number of bytes buffered but not yet read.
+            inline std::size_t available() const { return (_end - _pos); }
+            /// Pointer to the next unread byte.
+            inline const char *next() const { return &_buf[_pos]; }
+            /// Skip n (available) bytes.
+            inline void advance(std::size_t n) { _pos += n; }
+
+            /** Read the next buffer's worth, once all buffered data has
+             * been read.
+             * @returns False (and marks the stream) on error or end of file.
+             */
+            bool fill() throw();
+
+            /** Write out the buffer.
+             * @returns False on error.
+             */
+            bool flush_buffer() throw();
+
 	private:
+            bool underflow(void *v, std::size_t n) throw();
+            bool overflow(const void *v, std::size_t n) throw();
+            /// Write or read and check the header of a framed stream.
+            bool write_header() throw();
+            bool read_header() throw();
+            /// Write data as framed blocks.
+            bool write_blocks(const char *data, std::size_t n) throw();
+            /// Read the next framed block into the buffer.
+            bool read_block() throw();
+
 	    std::string _path;
 	    FILE *_stream;
 	    bool _open;
+            /// opened for writing?
+            bool _writing;
+            bool _framed;
+            uint32_t _magic;
+            uint32_t _version;
+            bool _eof;
+            bool _error;
+            std::size_t _size;
+            std::vector<char> _buf;
+            /// readers: unread data is [_pos, _end); writers: [0, _end).
+            std::size_t _pos;
+            std::size_t _end;
     };
 
     /**
@@ -123,6 +249,14 @@ namespace io {
              */
 	    BinaryIStream(const std::string& path) throw ();
 
+            /** Constructor.  Opens framed stream.
+             * @param path Path of file to open.
+             * @param magic Magic number the file must have.
+             * @param version Version the file must have.
+             */
+            BinaryIStream(const std::string& path, uint32_t magic,
+                          uint32_t version) throw ();
+
             /// Destructor.
 	    virtual ~BinaryIStream() throw();
 
@@ -132,6 +266,21 @@ namespace io {
             template <typename T>
             inline void read(T& v);
 
+            /** Read an array of values (written with write_array()).
+             * T must be a POD type.
+             * @param v Pointer to first element.
+             * @param n Number of elements.
+             */
+            template <typename T>
+            inline void read_array(T *v, std::size_t n);
+
+            /** Read an unsigned integer written with write_varint().  The
+             * stream fails if the value doesn't fit in a T.
+             * @param v variable to save read value.
+             */
+            template <typename T>
+            inline void read_varint(T& v);
+
             /** Read value from stream.
              * @param v variable to save read value.
              * @returns reference to this.
@@ -142,31 +291,62 @@ namespace io {
 	protected:
             /// Open mode.
 	    virtual const char * const mode() const;
+
+        private:
+            /// Read a string straight from the buffer.
+            void read_string(std::string& str);
+            /// Read a varint.
+            bool read_uint64(uint64_t& v);
     };
 
     template <typename T>
     inline void
     BinaryIStream::read(T& v)
     {
-        std::fread(static_cast<void *>(&v), sizeof(T), 1, this->stream());
+        typedef BinaryTraits<T> traits;
+
+        if (traits::raw)
+            this->get(static_cast<void *>(&v), sizeof(T));
+        else
+        {
+            unsigned char buf[traits::size];
+            if (this->get(static_cast<void *>(buf), traits::size))
+                traits::decode(buf, v);
+        }
     }
 
-    /// Partial specialization for std::string.
-    template <>
+    template <typename T>
     inline void
-    BinaryIStream::read<std::string>(std::string& str)
+    BinaryIStream::read_array(T *v, std::size_t n)
     {
-	std::string::size_type len;
-        this->read(len);
+        if (BinaryTraits<T>::raw)
+            this->get(static_cast<void *>(v), n * sizeof(T));
+        else
+        {
+            for (std::size_t i = 0 ; i < n and *this ; ++i)
+                this->read(v[i]);
+        }
+    }
 
-        if (not *this)
+    template <typename T>
+    inline void
+    BinaryIStream::read_varint(T& v)
+    {
+        uint64_t u;
+        if (not this->read_uint64(u))
             return;
 
-        char *buf = new char[len+1];
-        buf[len] = 0;
-        std::fread(static_cast<void*>(buf), sizeof(char), len, this->stream());
-	str.assign(buf);
-        delete[] buf;
+        v = static_cast<T>(u);
+        if (static_cast<uint64_t>(v) != u)
+            this->fail();
+    }
+
+    /// Partial specialization for std::string.
+    template <>
+    inline void
+    BinaryIStream::read<std::string>(std::string& str)
+    {
+        this->read_string(str);
     }
 
     template <typename T>
@@ -193,6 +373,14 @@ namespace io {
              */
 	    BinaryOStream(const std::string& path) throw ();
 
+            /** Constructor.  Opens framed stream.
+             * @param path Path of file to open.
+             * @param magic Magic number identifying the kind of file.
+             * @param version Version of the file's contents.
+             */
+            BinaryOStream(const std::string& path, uint32_t magic,
+                          uint32_t version) throw ();
+
             /// Destructor.
 	    virtual ~BinaryOStream() throw();
 
@@ -205,6 +393,24 @@ namespace io {
             /// char * overload which calls the std::string specialization.
             inline void write(const char * const str);
 
+            /** Write an array of values.  T must be a POD type.
+             * @param v Pointer to first element.
+             * @param n Number of elements.
+             */
+            template <typename T>
+            inline void write_array(const T *v, std::size_t n);
+
+            /** Write an unsigned integer in as few bytes as it needs (see
+             * encode_varint()).  Use for sizes and counts.
+             * @param v Value to write to stream.
+             */
+            inline void write_varint(uint64_t v);
+
+            /** Write out everything buffered so far.
+             * @returns False if anything written so far failed to be.
+             */
+            bool flush() throw();
+
             /** Write value to stream.
              * @param v Value to write to stream.
              * @returns reference to this.
@@ -221,8 +427,36 @@ namespace io {
     inline void
     BinaryOStream::write(const T& v)
     {
-        std::fwrite(static_cast<const void *>(&v),
-                sizeof(T), 1, this->stream());
+        typedef BinaryTraits<T> traits;
+
+        if (traits::raw)
+            this->put(static_cast<const void *>(&v), sizeof(T));
+        else
+        {
+            unsigned char buf[traits::size];
+            traits::encode(v, buf);
+            this->put(static_cast<const void *>(buf), traits::size);
+        }
+    }
+
+    template <typename T>
+    inline void
+    BinaryOStream::write_array(const T *v, std::size_t n)
+    {
+        if (BinaryTraits<T>::raw)
+            this->put(static_cast<const void *>(v), n * sizeof(T));
+        else
+        {
+            for (std::size_t i = 0 ; i < n and *this ; ++i)
+                this->write(v[i]);
+        }
+    }
+
+    inline void
+    BinaryOStream::write_varint(uint64_t v)
+    {
+        unsigned char buf[max_varint_size];
+        this->put(static_cast<const void *>(buf), encode_varint(v, buf));
     }
 
     /// Partial specialization for std::string.
@@ -231,13 +465,12 @@ namespace io {
     BinaryOStream::write<std::string>(const std::string& str)
     {
 	const std::string::size_type len(str.length());
-        this->write(len);
+        this->write_varint(len);
 
         if (not *this)
             return;
 
-        std::fwrite(static_cast<const void *>(str.c_str()),
-                sizeof(char), len, this->stream());
+        this->put(static_cast<const void *>(str.data()), len);
     }
 
     inline void
@@ -0,0 +1,204 @@
+/*
+ * libherdstat -- herdstat/io/binary_traits.hh
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_IO_BINARY_TRAITS_HH
+#define _HAVE_IO_BINARY_TRAITS_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/io/binary_traits.hh
+ * @brief Defines the BinaryTraits template and varint encoding used by the
+ * binary streams.
+ */
+
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <stdint.h>
+
+/* This header is installed, so the host's byte order can't come from
+ * config.h. */
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__)
+# if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#  define LIBHERDSTAT_BIG_ENDIAN 1
+# endif
+#else
+# include <endian.h>
+# if __BYTE_ORDER == __BIG_ENDIAN
+#  define LIBHERDSTAT_BIG_ENDIAN 1
+# endif
+#endif
+
+namespace herdstat {
+namespace io {
+
+    /// BinaryTraits of an integral type T stored in N bytes.
+    template <typename T, std::size_t N>
+    struct BinaryIntTraits
+    {
+#ifdef LIBHERDSTAT_BIG_ENDIAN
+        enum { size = N, raw = (N == 1 and sizeof(T) == 1) };
+#else
+        enum { size = N, raw = (sizeof(T) == N) };
+#endif
+
+        static void encode(const T& v, unsigned char *buf)
+        {
+            /* sign-extends negative values */
+            const uint64_t u = static_cast<uint64_t>(v);
+            for (std::size_t i = 0 ; i < N ; ++i)
+                buf[i] = static_cast<unsigned char>(u >> (8 * i));
+        }
+
+        static void decode(const unsigned char *buf, T& v)
+        {
+            uint64_t u = 0;
+            for (std::size_t i = 0 ; i < N ; ++i)
+                u |= static_cast<uint64_t>(buf[i]) << (8 * i);
+            v = static_cast<T>(u);
+        }
+    };
+
+    /// BinaryTraits of a floating point type T with the bits of a U.
+    template <typename T, typename U>
+    struct BinaryFloatTraits
+    {
+        enum { size = sizeof(U), raw = BinaryIntTraits<U, sizeof(U)>::raw };
+
+        static void encode(const T& v, unsigned char *buf)
+        {
+            U bits;
+            std::memcpy(&bits, &v, sizeof(U));
+            BinaryIntTraits<U, sizeof(U)>::encode(bits, buf);
+        }
+
+        static void decode(const unsigned char *buf, T& v)
+        {
+            U bits;
+            BinaryIntTraits<U, sizeof(U)>::decode(buf, bits);
+            std::memcpy(&v, &bits, sizeof(U));
+        }
+    };
+
+    /// BinaryTraits of a type T that isn't specialized below.
+    template <typename T, bool Integer>
+    struct BinaryDefaultTraits
+    {
+        enum { size = sizeof(T), raw = true };
+
+        static void encode(const T& v, unsigned char *buf)
+        { std::memcpy(buf, &v, sizeof(T)); }
+        static void decode(const unsigned char *buf, T& v)
+        { std::memcpy(&v, buf, sizeof(T)); }
+    };
+
+    /* integers (bool, char types, and whatever types int8_t ... uint64_t
+     * are) are stored in their own width */
+    template <typename T>
+    struct BinaryDefaultTraits<T, true>
+        : public BinaryIntTraits<T, sizeof(T)> { };
+
+    /**
+     * @struct BinaryTraits binary_traits.hh herdstat/io/binary_traits.hh
+     * @brief How values of type T are stored by the binary streams.
+     *
+     * Arithmetic types are stored little-endian.  Integers are stored in
+     * as many bytes as they have (so int8_t ... uint64_t have their own
+     * width), except that long is always stored in 8 bytes.  float and
+     * double are stored in 4 and 8.  So a file written on a 64-bit host
+     * reads fine on a 32-bit one (as long as the values fit).  Where the
+     * host's representation is the stored one (raw is true), values are
+     * simply copied.
+     *
+     * Other types (e.g. structs of the above, for read_array() and
+     * write_array()) are stored as they are in memory, which is only
+     * portable between hosts with the same layout.
+     *
+     * Members are size (bytes stored), raw, and encode()/decode() to
+     * convert between a value and its stored bytes.
+     */
+    template <typename T>
+    struct BinaryTraits
+        : public BinaryDefaultTraits<T, std::numeric_limits<T>::is_integer> { };
+
+    ///@{
+    /// Specializations for types whose width depends on the host.
+    template <> struct BinaryTraits<long>
+        : public BinaryIntTraits<long, 8> { };
+    template <> struct BinaryTraits<unsigned long>
+        : public BinaryIntTraits<unsigned long, 8> { };
+    template <> struct BinaryTraits<float>
+        : public BinaryFloatTraits<float, uint32_t> { };
+    template <> struct BinaryTraits<double>
+        : public BinaryFloatTraits<double, uint64_t> { };
+    ///@}
+
+    /// Maximum number of bytes in an encoded varint.
+    const std::size_t max_varint_size = 10;
+
+    /** Encode an unsigned integer as a varint (7 bits a byte, least
+     * significant first, with the top bit set on all but the last byte).
+     * Used for string lengths and block sizes.
+     * @param v Value.
+     * @param buf Buffer of at least max_varint_size bytes.
+     * @returns number of bytes used.
+     */
+    inline std::size_t
+    encode_varint(uint64_t v, unsigned char *buf)
+    {
+        std::size_t n = 0;
+        for (; v >= 0x80 ; v >>= 7)
+            buf[n++] = static_cast<unsigned char>(v | 0x80);
+        buf[n++] = static_cast<unsigned char>(v);
+        return n;
+    }
+
+    /** Decode a varint.
+     * @param buf Encoded varint.
+     * @param len Number of bytes available at buf.
+     * @param v variable to save decoded value.
+     * @returns number of bytes used, or 0 if buf doesn't hold a (valid)
+     * varint.
+     */
+    inline std::size_t
+    decode_varint(const unsigned char *buf, std::size_t len, uint64_t& v)
+    {
+        v = 0;
+        len = (len < max_varint_size ? len : max_varint_size);
+        for (std::size_t i = 0 ; i < len ; ++i)
+        {
+            v |= static_cast<uint64_t>(buf[i] & 0x7f) << (7 * i);
+            if (not (buf[i] & 0x80))
+                return (i + 1);
+        }
+        return 0;
+    }
+
+} // namespace io
+} // namespace herdstat
+
+#endif /* _HAVE_IO_BINARY_TRAITS_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,74 @@
+/*
+ * libherdstat -- herdstat/io/mapped_binary_reader.cc
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <herdstat/io/mapped_binary_reader.hh>
+
+namespace herdstat {
+namespace io {
+/****************************************************************************/
+MappedBinaryReader::MappedBinaryReader() throw()
+    : _file(), _pos(0), _failed(false)
+{
+}
+/****************************************************************************/
+MappedBinaryReader::MappedBinaryReader(const std::string& path) throw()
+    : _file(), _pos(0), _failed(false)
+{
+    this->open(path);
+}
+/****************************************************************************/
+MappedBinaryReader::~MappedBinaryReader() throw()
+{
+}
+/****************************************************************************/
+void
+MappedBinaryReader::open(const std::string& path) throw()
+{
+    _pos = 0;
+    _failed = false;
+
+    try
+    {
+        _file.open(path);
+    }
+    catch (const FileException&)
+    {
+        _failed = true;
+    }
+}
+/****************************************************************************/
+void
+MappedBinaryReader::close() throw()
+{
+    _file.close();
+    _pos = 0;
+    _failed = false;
+}
+/****************************************************************************/
+} // namespace io
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
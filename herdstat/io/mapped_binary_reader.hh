@@ -0,0 +1,282 @@
+/*
+ * libherdstat -- herdstat/io/mapped_binary_reader.hh
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_IO_MAPPED_BINARY_READER_HH
+#define _HAVE_IO_MAPPED_BINARY_READER_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/io/mapped_binary_reader.hh
+ * @brief Defines the MappedBinaryReader class.
+ */
+
+#include <string>
+#include <cstring>
+#include <herdstat/noncopyable.hh>
+#include <herdstat/util/mapped_file.hh>
+#include <herdstat/util/string_view.hh>
+#include <herdstat/io/binary_traits.hh>
+
+namespace herdstat {
+namespace io {
+
+    /**
+     * @class MappedBinaryReader mapped_binary_reader.hh herdstat/io/mapped_binary_reader.hh
+     * @brief Reads what a BinaryOStream wrote, straight out of a memory
+     * mapping of the file.
+     *
+     * Opening a file only maps it; pages are read in as they're used.
+     * Values are read with the same interface as BinaryIStream, but strings
+     * can also be read into a util::StringView that refers to the mapping
+     * instead of being copied (so is only valid until the reader is closed
+     * or destroyed).  tell() and seek() allow jumping around in the file,
+     * e.g. to an entry of a table whose offsets were written up front.
+     *
+     * As with BinaryIStream, reading past the end of the file puts the
+     * reader in a failed state, and the value read is left alone.  Only
+     * files written by an unframed BinaryOStream can be read.
+     */
+
+    class MappedBinaryReader : private Noncopyable
+    {
+        public:
+            /// Offset into the file.
+            typedef std::size_t offset_type;
+
+            /// Default constructor.
+            MappedBinaryReader() throw();
+
+            /** Constructor.  Opens (maps) file.
+             * @param path Path of file to open.
+             */
+            explicit MappedBinaryReader(const std::string& path) throw();
+
+            /// Destructor.
+            ~MappedBinaryReader() throw();
+
+            /** Open (map) file, closing any previously opened one.
+             * @param path Path of file to open.
+             */
+            void open(const std::string& path) throw();
+
+            /// Close (unmap) file.
+            void close() throw();
+
+            /// Is a file open?
+            inline bool is_open() const { return _file.is_open(); }
+            /// Get path.
+            inline const std::string& path() const { return _file.path(); }
+            /// Get size of file.
+            inline offset_type size() const { return _file.size(); }
+            /// Get pointer to the start of the mapping.
+            inline const char *data() const { return _file.data(); }
+
+            /// Get current offset.
+            inline offset_type tell() const { return _pos; }
+
+            /** Move to the given offset.  Clears a failed state if the
+             * offset is within the file (or at its end).
+             * @param pos Offset.
+             */
+            inline void seek(offset_type pos);
+
+            /** Skip bytes.
+             * @param n Number of bytes.
+             */
+            inline void skip(offset_type n);
+
+            /// Has everything been read?
+            inline bool eof() const { return (_pos == _file.size()); }
+
+            ///@{
+            /** Check if reader's status is ok.  Allows the use of
+             * MappedBinaryReader in boolean expressions.
+             */
+            inline operator void*() const
+            {
+                return (operator!() ? NULL :
+                    const_cast<MappedBinaryReader*>(this));
+            }
+
+            inline bool operator!() const
+            { return (_failed or not _file.is_open()); }
+            ///@}
+
+            /** Read value.
+             * @param v variable to save read value.
+             */
+            template <typename T>
+            inline void read(T& v);
+
+            /** Read an array of values (written with
+             * BinaryOStream::write_array()).  T must be a POD type.
+             * @param v Pointer to first element.
+             * @param n Number of elements.
+             */
+            template <typename T>
+            inline void read_array(T *v, std::size_t n);
+
+            /** Read an unsigned integer written with
+             * BinaryOStream::write_varint().  Fails if the value doesn't
+             * fit in a T.
+             * @param v variable to save read value.
+             */
+            template <typename T>
+            inline void read_varint(T& v);
+
+            /** Read value.
+             * @param v variable to save read value.
+             * @returns reference to this.
+             */
+            template <typename T>
+            inline MappedBinaryReader& operator>>(T& v);
+
+        private:
+            /** Get a pointer to the next n bytes and skip them.
+             * @returns NULL (and fails) if there aren't that many left.
+             */
+            inline const char *take(offset_type n);
+
+            util::MappedFile _file;
+            offset_type _pos;
+            bool _failed;
+    };
+
+    inline void
+    MappedBinaryReader::seek(offset_type pos)
+    {
+        _failed = (pos > _file.size());
+        _pos = (_failed ? _file.size() : pos);
+    }
+
+    inline void
+    MappedBinaryReader::skip(offset_type n)
+    {
+        this->take(n);
+    }
+
+    inline const char *
+    MappedBinaryReader::take(offset_type n)
+    {
+        if (_failed or n > _file.size() - _pos)
+        {
+            _failed = true;
+            return NULL;
+        }
+
+        const char * const p = _file.data() + _pos;
+        _pos += n;
+        return p;
+    }
+
+    template <typename T>
+    inline void
+    MappedBinaryReader::read(T& v)
+    {
+        typedef BinaryTraits<T> traits;
+
+        /* the mapping needn't be suitably aligned for T */
+        const char * const p = this->take(traits::size);
+        if (p)
+            traits::decode(reinterpret_cast<const unsigned char *>(p), v);
+    }
+
+    template <typename T>
+    inline void
+    MappedBinaryReader::read_array(T *v, std::size_t n)
+    {
+        if (BinaryTraits<T>::raw)
+        {
+            const char * const p = this->take(n * sizeof(T));
+            if (p)
+                std::memcpy(static_cast<void *>(v), p, n * sizeof(T));
+        }
+        else
+        {
+            for (std::size_t i = 0 ; i < n and not _failed ; ++i)
+                this->read(v[i]);
+        }
+    }
+
+    template <typename T>
+    inline void
+    MappedBinaryReader::read_varint(T& v)
+    {
+        if (_failed)
+            return;
+
+        uint64_t u;
+        const std::size_t n = decode_varint(
+            reinterpret_cast<const unsigned char *>(_file.data() + _pos),
+            _file.size() - _pos, u);
+
+        if (n == 0 or static_cast<uint64_t>(static_cast<T>(u)) != u)
+        {
+            _failed = true;
+            return;
+        }
+
+        _pos += n;
+        v = static_cast<T>(u);
+    }
+
+    /// Specialization for util::StringView (refers to the mapping).
+    template <>
+    inline void
+    MappedBinaryReader::read<util::StringView>(util::StringView& v)
+    {
+        std::string::size_type len = 0;
+        this->read_varint(len);
+
+        const char * const p = this->take(len);
+        if (p)
+            v = util::StringView(p, len);
+    }
+
+    /// Specialization for std::string.
+    template <>
+    inline void
+    MappedBinaryReader::read<std::string>(std::string& str)
+    {
+        util::StringView v;
+        this->read(v);
+        if (not _failed)
+            str.assign(v.data(), v.size());
+    }
+
+    template <typename T>
+    inline MappedBinaryReader&
+    MappedBinaryReader::operator>>(T& v)
+    {
+        this->read(v);
+        return *this;
+    }
+
+} // namespace io
+} // namespace herdstat
+
+#endif /* _HAVE_IO_MAPPED_BINARY_READER_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,255 @@
+/*
+ * libherdstat -- herdstat/io/serialize.hh
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_IO_SERIALIZE_HH
+#define _HAVE_IO_SERIALIZE_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/io/serialize.hh
+ * @brief Defines the Serializer traits template and the serialize() and
+ * deserialize() functions.
+ */
+
+#include <vector>
+#include <set>
+#include <map>
+#include <utility>
+#include <algorithm>
+#include <herdstat/util/container_base.hh>
+#include <herdstat/io/binary_stream.hh>
+
+namespace herdstat {
+namespace io {
+
+    /**
+     * @struct Serializer serialize.hh herdstat/io/serialize.hh
+     * @brief How values of type T are written to a BinaryOStream and read
+     * back from a BinaryIStream.
+     *
+     * The default simply uses operator<< and operator>>, which suits
+     * arithmetic types and std::string.  Specializations are provided for
+     * std::pair, the standard containers and util::VectorBase, util::SetBase
+     * and util::MapBase; herdstat/portage/serialize.hh provides them for the
+     * core portage types.  Containers are written as a (varint) count
+     * followed by their elements.
+     *
+     * Since a specialization for a base class isn't used for classes
+     * derived from it, classes derived from a ContainerBase specialize
+     * Serializer by deriving from SequenceSerializer, SetSerializer or
+     * MapSerializer, e.g.
+     *
+@code
+template <> struct Serializer<Foo> : public SetSerializer<Foo> { };
+@endcode
+     *
+     * A value that fails to be read leaves the stream failed; the value
+     * itself is then unspecified.  For checksummed and versioned records,
+     * serialize to a framed stream (see BinaryStream).
+     */
+
+    template <typename T>
+    struct Serializer
+    {
+        static void save(BinaryOStream& stream, const T& v) { stream << v; }
+        static void load(BinaryIStream& stream, T& v) { stream >> v; }
+    };
+
+    /** Write a value.
+     * @param stream Stream to write to.
+     * @param v Value to write.
+     */
+    template <typename T>
+    inline void
+    serialize(BinaryOStream& stream, const T& v)
+    {
+        Serializer<T>::save(stream, v);
+    }
+
+    /** Read a value written with serialize().
+     * @param stream Stream to read from.
+     * @param v variable to save read value.
+     */
+    template <typename T>
+    inline void
+    deserialize(BinaryIStream& stream, T& v)
+    {
+        Serializer<T>::load(stream, v);
+    }
+
+    /// Serializer for std::pair.
+    template <typename T, typename U>
+    struct Serializer<std::pair<T, U> >
+    {
+        static void save(BinaryOStream& stream, const std::pair<T, U>& v)
+        {
+            serialize(stream, v.first);
+            serialize(stream, v.second);
+        }
+
+        static void load(BinaryIStream& stream, std::pair<T, U>& v)
+        {
+            deserialize(stream, v.first);
+            deserialize(stream, v.second);
+        }
+    };
+
+    /// Write the (varint) count and elements of container c.
+    template <typename C>
+    inline void
+    serialize_elements(BinaryOStream& stream, const C& c)
+    {
+        stream.write_varint(c.size());
+
+        typename C::const_iterator i;
+        for (i = c.begin() ; i != c.end() and stream ; ++i)
+            serialize(stream, *i);
+    }
+
+    /**
+     * @struct SequenceSerializer serialize.hh herdstat/io/serialize.hh
+     * @brief Serializer for vector-like containers.  Loading reserves room
+     * for the elements up front and reads each in place.
+     */
+
+    template <typename C>
+    struct SequenceSerializer
+    {
+        static void save(BinaryOStream& stream, const C& c)
+        { serialize_elements(stream, c); }
+
+        static void load(BinaryIStream& stream, C& c)
+        {
+            c.clear();
+
+            typename C::size_type n = 0;
+            stream.read_varint(n);
+
+            /* a corrupt count shouldn't cost more than the data does */
+            c.reserve(std::min<typename C::size_type>(n, 65536));
+
+            for (; n > 0 and stream ; --n)
+            {
+                c.push_back(typename C::value_type());
+                deserialize(stream, c.back());
+            }
+        }
+    };
+
+    /**
+     * @struct SetSerializer serialize.hh herdstat/io/serialize.hh
+     * @brief Serializer for set-like containers.  Elements are written in
+     * order, so loading inserts each at the end (with end() as the hint)
+     * rather than searching for its position.
+     */
+
+    template <typename C>
+    struct SetSerializer
+    {
+        static void save(BinaryOStream& stream, const C& c)
+        { serialize_elements(stream, c); }
+
+        static void load(BinaryIStream& stream, C& c)
+        {
+            c.clear();
+
+            typename C::size_type n = 0;
+            stream.read_varint(n);
+
+            typename C::value_type v;
+            for (; n > 0 and stream ; --n)
+            {
+                deserialize(stream, v);
+                if (stream)
+                    c.insert(c.end(), v);
+            }
+        }
+    };
+
+    /**
+     * @struct MapSerializer serialize.hh herdstat/io/serialize.hh
+     * @brief Serializer for map-like containers.  As with SetSerializer,
+     * entries are inserted at the end; values are read in place.
+     */
+
+    template <typename C>
+    struct MapSerializer
+    {
+        static void save(BinaryOStream& stream, const C& c)
+        { serialize_elements(stream, c); }
+
+        static void load(BinaryIStream& stream, C& c)
+        {
+            c.clear();
+
+            typename C::size_type n = 0;
+            stream.read_varint(n);
+
+            typename C::key_type k;
+            for (; n > 0 and stream ; --n)
+            {
+                deserialize(stream, k);
+                if (not stream)
+                    break;
+
+                typename C::iterator i = c.insert(c.end(),
+                    typename C::value_type(k, typename C::mapped_type()));
+                deserialize(stream, i->second);
+            }
+        }
+    };
+
+    ///@{
+    /// Serializers for the standard containers.
+    template <typename T>
+    struct Serializer<std::vector<T> >
+        : public SequenceSerializer<std::vector<T> > { };
+    template <typename T, typename Compare>
+    struct Serializer<std::set<T, Compare> >
+        : public SetSerializer<std::set<T, Compare> > { };
+    template <typename K, typename V, typename Compare>
+    struct Serializer<std::map<K, V, Compare> >
+        : public MapSerializer<std::map<K, V, Compare> > { };
+    ///@}
+
+    ///@{
+    /// Serializers for the ContainerBase templates.
+    template <typename T>
+    struct Serializer<util::VectorBase<T> >
+        : public SequenceSerializer<util::VectorBase<T> > { };
+    template <typename T, typename Compare>
+    struct Serializer<util::SetBase<T, Compare> >
+        : public SetSerializer<util::SetBase<T, Compare> > { };
+    template <typename K, typename V, typename Compare>
+    struct Serializer<util::MapBase<K, V, Compare> >
+        : public MapSerializer<util::MapBase<K, V, Compare> > { };
+    ///@}
+
+} // namespace io
+} // namespace herdstat
+
+#endif /* _HAVE_IO_SERIALIZE_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
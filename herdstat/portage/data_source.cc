@@ -0,0 +1,115 @@
+/*
+ * libherdstat -- herdstat/portage/data_source.cc
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <typeinfo>
+#include <cstdio>
+#include <ctime>
+
+#include <herdstat/util/file.hh>
+#include <herdstat/io/binary_stream.hh>
+#include <herdstat/portage/data_source.hh>
+
+namespace herdstat {
+namespace portage {
+/*** static members *********************************************************/
+const unsigned int DataSource::snapshot_version = 3;
+/* "HSDS" */
+static const unsigned int snapshot_magic = 0x48534453;
+/****************************************************************************/
+bool
+DataSource::load_snapshot()
+{
+    if (_snapshot.empty() or not _query.empty() or
+        not util::is_file(_snapshot))
+        return false;
+
+    const util::Stat st(this->path());
+    if (not st.exists())
+        return false;
+
+    /* fails unless magic and version match */
+    io::BinaryIStream stream(_snapshot, snapshot_magic, snapshot_version);
+    if (not stream)
+        return false;
+
+    std::string type, path;
+    std::time_t mtime = 0;
+    util::Stat::size_type size = 0;
+    stream >> type >> path >> mtime >> size;
+
+    if (not stream or type != typeid(*this).name() or path != this->path() or
+        mtime != st.mtime() or size != st.size())
+        return false;
+
+    return this->do_load_snapshot(stream);
+}
+/****************************************************************************/
+void
+DataSource::save_snapshot() const
+{
+    if (_snapshot.empty() or not _query.empty())
+        return;
+
+    const util::Stat st(this->path());
+    if (not st.exists())
+        return;
+
+    /* write to a temporary and rename it so readers never see a partial
+     * snapshot */
+    const std::string tmp(util::tmp_path(_snapshot));
+    bool ok;
+
+    {
+        io::BinaryOStream stream(tmp, snapshot_magic, snapshot_version);
+        if (not stream)
+            return;
+
+        stream << std::string(typeid(*this).name()) << this->path()
+               << st.mtime() << st.size();
+
+        ok = (this->do_save_snapshot(stream) and stream.close());
+    }
+
+    if (not ok or std::rename(tmp.c_str(), _snapshot.c_str()) != 0)
+        std::remove(tmp.c_str());
+}
+/****************************************************************************/
+bool
+DataSource::do_load_snapshot(io::BinaryIStream& stream LIBHERDSTAT_UNUSED)
+{
+    return false;
+}
+/****************************************************************************/
+bool
+DataSource::do_save_snapshot(io::BinaryOStream& stream LIBHERDSTAT_UNUSED) const
+{
+    return false;
+}
+/****************************************************************************/
+} // namespace portage
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
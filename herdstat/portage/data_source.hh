@@ -32,6 +32,7 @@
  * @brief Defines the DataSource abstract interface.
  */
 
+#include <string>
 #include <herdstat/parsable.hh>
 #include <herdstat/progressable.hh>
 #include <herdstat/noncopyable.hh>
@@ -39,6 +40,12 @@
 #include <herdstat/xml/saxparser.hh>
 
 namespace herdstat {
+
+namespace io {
+    class BinaryIStream;
+    class BinaryOStream;
+} // namespace io
+
 namespace portage {
 
     class Developer;
@@ -47,6 +54,31 @@ namespace portage {
      * @class DataSource
      * @brief Abstract base class for Gentoo-related XML files that provide
      * information (eg herds.xml).
+     *
+     * DataSource's parse local files only; they aren't Fetchable, so
+     * getting an up-to-date herds.xml, userinfo.xml or devaway.xml is up
+     * to the application.  The <maintainingproject> files HerdsXML
+     * references are fetched concurrently by a ProjectResolver.
+     *
+     * @section snapshot Snapshots
+     *
+     * If a snapshot path has been set via set_snapshot(), derivatives that
+     * support it (HerdsXML, UserinfoXML and DevawayXML) write their parsed
+     * state to it after parsing, and on the next parse load it instead if
+     * the XML file's path, mtime and size haven't changed.  Snapshots are
+     * framed io::BinaryStream's, versioned by snapshot_version; ones
+     * written by a different version or for a different class, or that
+     * fail their checksums, are ignored.
+     *
+     * @section query Queries
+     *
+     * If only a single entry is needed (eg one developer from
+     * userinfo.xml), set a query via set_query() before parsing.  Entries
+     * whose key doesn't match are then skipped without being built, and
+     * parsing stops as soon as the matching entry is complete.  The key is
+     * the developer's user name (UserinfoXML, DevawayXML) or the herd name
+     * (HerdsXML).  Snapshots are neither loaded nor written while a query
+     * is set, since they would only be partial.
      */
 
     class DataSource : public Parsable,
@@ -65,18 +97,69 @@ namespace portage {
             virtual void fill_developer(Developer& dev) const
                 throw (Exception) = 0;
 
+            /// Snapshot format version.
+            static const unsigned int snapshot_version;
+
+            /** Set path of binary snapshot (defaults to none).
+             * @param path Path.
+             */
+            void set_snapshot(const std::string& path)
+            { _snapshot.assign(path); }
+            /// Get path of binary snapshot.
+            const std::string& snapshot() const { return _snapshot; }
+
+            /** Only parse the entry matching @a key (defaults to none,
+             * meaning parse everything).
+             * @param key Developer user name or herd name.
+             */
+            void set_query(const std::string& key) { _query.assign(key); }
+            /// Get query key.
+            const std::string& query() const { return _query; }
+
         protected:
             /// Default constructor.
-            DataSource() throw() { }
+            DataSource() throw() : _snapshot(), _query() { }
 
             /** Constructor.
              * @param path Path to XML file.
              */
             DataSource(const std::string& path) throw()
-                : Parsable(path) { }
+                : Parsable(path), _snapshot(), _query() { }
 
             /// Destructor.
             virtual ~DataSource() throw() { }
+
+            /** Load the snapshot if it is up-to-date with path().
+             * @returns true if loaded.
+             */
+            bool load_snapshot();
+
+            /** Write the snapshot (if a path is set).  Failure to do so is
+             * not an error.
+             */
+            void save_snapshot() const;
+
+            /** Read parsed state from a snapshot.  The default does nothing.
+             * On failure, any partially read state must be discarded.
+             * @returns true if successful.
+             */
+            virtual bool do_load_snapshot(io::BinaryIStream& stream);
+
+            /** Write parsed state to a snapshot.  The default does nothing.
+             * @returns false if unsupported.
+             */
+            virtual bool do_save_snapshot(io::BinaryOStream& stream) const;
+
+            /** Does the entry with the given key need to be parsed?
+             * @param key Developer user name or herd name.
+             * @returns true if no query is set or @a key matches it.
+             */
+            bool wanted(const std::string& key) const
+            { return (_query.empty() or key == _query); }
+
+        private:
+            std::string _snapshot;
+            std::string _query;
     };
 
 } // namespace portage
@@ -24,10 +24,10 @@
 # include "config.h"
 #endif
 
-#include <iostream>
 #include <herdstat/exceptions.hh>
 #include <herdstat/util/string.hh>
 #include <herdstat/util/file.hh>
+#include <herdstat/portage/serialize.hh>
 #include <herdstat/portage/devaway_xml.hh>
 
 namespace herdstat {
@@ -37,14 +37,14 @@ const char * const DevawayXML::_local_default = LOCALSTATEDIR"/devaway.xml";
 /****************************************************************************/
 DevawayXML::DevawayXML() throw()
     : DataSource(), _devs(), in_devaway(false),
-      in_dev(false), in_reason(false), _cur_dev()
+      in_dev(false), in_reason(false), _cur_dev(), _text()
 {
 }
 /****************************************************************************/
 DevawayXML::DevawayXML(const std::string &path)
     throw (FileException, xml::ParserException)
     : DataSource(path), _devs(), in_devaway(false),
-      in_dev(false), in_reason(false), _cur_dev()
+      in_dev(false), in_reason(false), _cur_dev(), _text()
 {
     this->parse();
 }
@@ -69,11 +69,33 @@ DevawayXML::do_parse(const std::string& path)
     if (not util::is_file(this->path()))
         throw FileException(this->path());
 
-    this->parse_file(this->path().c_str());
+    if (not this->load_snapshot())
+    {
+        this->parse_file(this->path());
+        this->save_snapshot();
+    }
 
     this->timer().stop();
 }
 /****************************************************************************/
+bool
+DevawayXML::do_load_snapshot(io::BinaryIStream& stream)
+{
+    io::deserialize(stream, _devs);
+    if (stream)
+        return true;
+
+    _devs.clear();
+    return false;
+}
+/****************************************************************************/
+bool
+DevawayXML::do_save_snapshot(io::BinaryOStream& stream) const
+{
+    io::serialize(stream, _devs);
+    return true;
+}
+/****************************************************************************/
 void
 DevawayXML::fill_developer(Developer& dev) const throw (Exception)
 {
@@ -102,53 +124,91 @@ DevawayXML::keys() const
     return v;
 }
 /****************************************************************************/
+const xml::ElementTable&
+DevawayXML::elements() const
+{
+    static const xml::ElementTableEntry entries[] = {
+        { "devaway",    DEVAWAY },
+        { "dev",        DEV },
+        { "reason",     REASON }
+    };
+    static const xml::ElementTable table(entries,
+        sizeof(entries) / sizeof(entries[0]));
+    return table;
+}
+/****************************************************************************/
 bool
-DevawayXML::start_element(const std::string& name, const attrs_type& attrs)
+DevawayXML::start_element(xml::element_id id, const attrs_type& attrs)
 {
     if (meter())
         ++*meter();
 
-    if (name == "devaway")
-        in_devaway = true;
-    else if (name == "dev" and in_devaway)
+    switch (id)
     {
-        attrs_type::const_iterator pos = attrs.find("nick");
-        if (pos == attrs.end())
+        case DEVAWAY:
+            in_devaway = true;
+            break;
+        case DEV:
         {
-            std::cerr << "<dev> tag with no nick attribute!" << std::endl;
-            return false;
+            if (not in_devaway)
+                break;
+
+            attrs_type::const_iterator pos = attrs.find("nick");
+            if (pos == attrs.end())
+                return this->error("<dev> tag with no nick attribute");
+
+            /* skip developers not matching the query; nothing inside is
+             * looked at unless in_dev is set */
+            if (not this->wanted(pos->second.str()))
+                break;
+
+            _cur_dev = Developer(pos->second.str());
+            _text.clear();
+            in_dev = true;
+            break;
         }
-
-        _cur_dev = _devs.insert(pos->second).first;
-        in_dev = true;
+        case REASON:
+            if (in_dev) in_reason = true;
+            break;
     }
-    else if (name == "reason" and in_dev)
-        in_reason = true;
 
     return true;
 }
 /****************************************************************************/
 bool
-DevawayXML::end_element(const std::string& name)
+DevawayXML::end_element(xml::element_id id)
 {
     if (meter())
         ++*meter();
 
-    if (name == "devaway")      in_devaway = false;
-    else if (name == "dev")     in_dev = false;
-    else if (name == "reason")  in_reason = false;
+    switch (id)
+    {
+        case DEVAWAY:   in_devaway = false; break;
+        case DEV:
+            if (not in_dev)
+                break;
+            in_dev = false;
+            _cur_dev.set_awaymsg(_text);
+            _devs.insert(_cur_dev);
+
+            /* found the queried developer; stop parsing */
+            if (not this->query().empty())
+                return false;
+            break;
+        case REASON:    in_reason = false; break;
+    }
 
     return true;
 }
 /****************************************************************************/
 bool
-DevawayXML::do_text(const std::string& text)
+DevawayXML::do_text(const util::StringView& text)
 {
     if (meter())
         ++*meter();
 
     if (in_reason)
-        const_cast<Developer&>(*_cur_dev).set_awaymsg(_cur_dev->awaymsg()+text);
+        text.append_to(_text);
 
     return true;
 }
@@ -95,17 +95,30 @@ namespace portage {
 
             ///@{
             /// SAX2 Callbacks
-            virtual bool start_element(const std::string& name,
+            virtual const xml::ElementTable& elements() const;
+            virtual bool start_element(xml::element_id id,
                                        const attrs_type& attrs);
-            virtual bool end_element(const std::string& name);
-            virtual bool do_text(const std::string& text);
+            virtual bool end_element(xml::element_id id);
+            virtual bool do_text(const util::StringView& text);
+            ///@}
+
+            ///@{
+            /// Snapshot support.
+            virtual bool do_load_snapshot(io::BinaryIStream& stream);
+            virtual bool do_save_snapshot(io::BinaryOStream& stream) const;
             ///@}
 
         private:
+            /// devaway.xml elements.
+            enum { DEVAWAY = 1, DEV, REASON };
+
             Developers _devs;
             static const char * const _local_default;
             bool in_devaway, in_dev, in_reason;
-            Developers::iterator _cur_dev;
+            /// developer being parsed (inserted at </dev>).
+            Developer _cur_dev;
+            /// text of the <reason>'s of the current <dev>.
+            std::string _text;
     };
 
     inline Developers& DevawayXML::devs() { return _devs; }
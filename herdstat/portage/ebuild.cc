@@ -24,16 +24,12 @@
 # include "config.h"
 #endif
 
-#include <iostream>
-#include <cassert>
-#include <herdstat/util/string.hh>
 #include <herdstat/portage/util.hh>
+#include <herdstat/portage/eclass_cache.hh>
 #include <herdstat/portage/ebuild.hh>
 
 namespace herdstat {
 namespace portage {
-/*** static members *********************************************************/
-//ebuild::eclass_map ebuild::_eclasses;
 /****************************************************************************/
 Ebuild::Ebuild() throw()
     : util::Vars(), _vmap()
@@ -73,58 +69,13 @@ Ebuild::do_set_defaults()
     }
 }
 /****************************************************************************/
-//void
-//Ebuild::do_perform_action_on(const std::string& str)
-//{
-//    /* perform any inherits */
-//    if (str.find("inherit") != std::string::npos)
-//    {
-//        std::string line(str);
-//        this->strip_ws(line);
-
-//        std::vector<std::string> parts(util::split(line));
-//        if (parts[0] == "inherit")
-//        {
-//            std::vector<std::string>::iterator i;
-//            for (i = parts.begin() + 1 ; i != parts.end() ; ++i)
-//            {
-//                const std::string eclass =
-//                    util::sprintf(GlobalConfig().portdir()+"/eclass/%s.eclass",
-//                        i->c_str());
-
-//                /* only recurse if we havent parsed this eclass already */
-//                eclass_map::iterator x = _eclasses.find(eclass);
-//                if (x == _eclasses.end())
-//                {
-//                    if (util::file_exists(eclass))
-//                    {
-//                        std::cout << "parsing eclass '" << eclass << "'" << std::endl;
-//                        x = _eclasses.insert(std::make_pair(eclass,
-//                                         new ebuild())).first;
-//                        x->second->insert(_vmap.begin(), _vmap.end());
-//                        x->second->read(eclass);
-//                    }
-//                    else
-//                    {
-//                        std::cerr << this->path() << ": non-existent eclass "
-//                            << eclass << std::endl;
-//                        continue;
-//                    }
-//                }
-//                else
-//                    x->second->insert(_vmap.begin(), _vmap.end());
-
-//                assert(x->second);
-//                for (iterator e = x->second->begin() ;
-//                        e != x->second->end() ; ++e)
-//                {
-//                    /* eclass overrides any variables set at this point */
-//                    this->operator[](e->first) = e->second;
-//                }
-//            }
-//        }
-//    }
-//}
+void
+Ebuild::do_perform_action_on(const std::string& line)
+{
+    /* perform any inherits */
+    if (line.find("inherit") != std::string::npos)
+        GlobalEclassCache().inherit(line, *this);
+}
 /****************************************************************************/
 } // namespace portage
 } // namespace herdstat
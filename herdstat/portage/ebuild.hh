@@ -32,7 +32,6 @@
  * @brief Defines the ebuild class.
  */
 
-#include <map>
 #include <herdstat/util/vars.hh>
 #include <herdstat/portage/version.hh>
 
@@ -44,7 +43,8 @@ namespace portage {
      * @brief Represents ebuild variables.
      * This is really identical to util::Vars, except it defines
      * do_set_defaults() and inserts variables that should be
-     * pre-existing (${PN}, ${P}, etc).
+     * pre-existing (${PN}, ${P}, etc).  Inherited eclasses are
+     * resolved via GlobalEclassCache().
      *
      * @section example Example
      *
@@ -74,13 +74,10 @@ namespace portage {
         protected:
             /// Set default variables.
             virtual void do_set_defaults();
-            /// Action to perform on each line read
-//            virtual void do_perform_action_on(const std::string& line);
+            /// Action to perform on each line read (handles inherits).
+            virtual void do_perform_action_on(const std::string& line);
 
         private:
-//            typedef std::map<std::string, ebuild * > eclass_map;
-            /// set of eclasses we've parsed; used for preventing recursion
-//            static eclass_map _eclasses;
             VersionComponents _vmap;
     };
 
@@ -0,0 +1,233 @@
+/*
+ * libherdstat -- herdstat/portage/eclass_cache.cc
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <algorithm>
+#include <iterator>
+
+#include <herdstat/exceptions.hh>
+#include <herdstat/util/string.hh>
+#include <herdstat/util/file.hh>
+#include <herdstat/portage/config.hh>
+#include <herdstat/portage/eclass_cache.hh>
+
+namespace herdstat {
+namespace portage {
+/*** static members *********************************************************/
+const unsigned short EclassCache::max_depth = 20;
+/****************************************************************************
+ * Reads an eclass, performing any inherits it contains.
+ ****************************************************************************/
+class EclassCache::Reader : public util::Vars
+{
+    public:
+        Reader(EclassCache& cache, unsigned short depth, Entry& entry)
+            : util::Vars(), _cache(cache), _depth(depth), _entry(entry) { }
+
+    protected:
+        virtual void do_set_defaults()
+        {
+            /* HOME is set by the inheriting ebuild */
+            this->erase("HOME");
+        }
+
+        virtual void do_perform_action_on(const std::string& line)
+        {
+            _cache.do_inherit(line, *this, _depth + 1, &_entry);
+        }
+
+    private:
+        EclassCache& _cache;
+        const unsigned short _depth;
+        Entry& _entry;
+};
+/****************************************************************************/
+EclassCache::EclassCache() throw()
+    : _mutex(), _entries(), _parsing(), _uncached(), _truncated(false)
+{
+}
+/****************************************************************************/
+EclassCache::~EclassCache() throw()
+{
+}
+/****************************************************************************/
+bool
+EclassCache::inherit(const std::string& line, util::Vars& vars)
+{
+    util::MutexLock lock(_mutex);
+    const bool result = this->do_inherit(line, vars, 0, NULL);
+    _uncached.clear();
+    _truncated = false;
+    return result;
+}
+/****************************************************************************/
+void
+EclassCache::clear()
+{
+    util::MutexLock lock(_mutex);
+    _entries.clear();
+}
+/****************************************************************************/
+bool
+EclassCache::do_inherit(const std::string& line, util::Vars& vars,
+                        unsigned short depth, Entry *parent)
+{
+    std::string::size_type pos = line.find_first_not_of(" \t");
+    if (pos == std::string::npos or line.compare(pos, 7, "inherit") != 0)
+        return false;
+
+    std::string str(line.substr(pos));
+    std::replace(str.begin(), str.end(), '\t', ' ');
+
+    std::vector<std::string> parts;
+    util::split(str, std::back_inserter(parts));
+    if (parts.empty() or parts.front() != "inherit")
+        return false;
+
+    std::vector<std::string>::iterator i;
+    for (i = parts.begin() + 1 ; i != parts.end() ; ++i)
+    {
+        const Entry *entry = this->lookup(*i, depth);
+        if (not entry)
+            continue;
+
+        /* eclass overrides any variables set at this point */
+        util::Vars::container_type::const_iterator v;
+        for (v = entry->vars.begin() ; v != entry->vars.end() ; ++v)
+            vars[v->first] = v->second;
+
+        if (parent)
+        {
+            parent->deps.insert(parent->deps.end(),
+                                entry->deps.begin(), entry->deps.end());
+            parent->height = std::max<unsigned short>(parent->height,
+                                                      entry->height + 1);
+        }
+    }
+
+    return true;
+}
+/****************************************************************************/
+const EclassCache::Entry *
+EclassCache::lookup(const std::string& eclass, unsigned short depth)
+{
+    if (depth >= max_depth)
+    {
+        _truncated = true;
+        return NULL;
+    }
+
+    const std::string path(this->find_eclass(eclass));
+    if (path.empty())
+        return NULL;
+
+    entries_type::iterator i = _entries.find(path);
+    if (i != _entries.end())
+    {
+        if (not this->is_valid(i->second))
+            _entries.erase(i);
+        /* parsing it here would give the same, unless its inherit chain
+         * doesn't fit under max_depth from here */
+        else if (depth + i->second.height <= max_depth)
+            return &(i->second);
+    }
+
+    /* eclass is already being parsed further up the inherit chain */
+    if (not _parsing.insert(path).second)
+    {
+        _truncated = true;
+        return NULL;
+    }
+
+    Entry entry;
+    entry.deps.push_back(std::make_pair(path, util::Stat(path).mtime()));
+
+    const bool truncated = _truncated;
+    _truncated = false;
+
+    try
+    {
+        Reader reader(*this, depth, entry);
+        reader.read(path);
+        entry.vars.insert(reader.begin(), reader.end());
+    }
+    catch (const FileException&)
+    {
+        _parsing.erase(path);
+        _truncated = truncated;
+        return NULL;
+    }
+
+    _parsing.erase(path);
+
+    const bool incomplete = _truncated;
+    _truncated = (truncated or incomplete);
+
+    /* what we got depends on where in the inherit chain we were */
+    if (incomplete)
+    {
+        _uncached.push_back(entry);
+        return &(_uncached.back());
+    }
+
+    return &(_entries.insert(std::make_pair(path, entry)).first->second);
+}
+/****************************************************************************/
+std::string
+EclassCache::find_eclass(const std::string& eclass) const
+{
+    const Config& config(GlobalConfig());
+    const std::vector<std::string>& overlays(config.overlays());
+
+    std::vector<std::string>::const_reverse_iterator i;
+    for (i = overlays.rbegin() ; i != overlays.rend() ; ++i)
+    {
+        const std::string path(*i+"/eclass/"+eclass+".eclass");
+        if (util::file_exists(path))
+            return path;
+    }
+
+    const std::string path(config.portdir()+"/eclass/"+eclass+".eclass");
+    return (util::file_exists(path) ? path : "");
+}
+/****************************************************************************/
+bool
+EclassCache::is_valid(const Entry& entry) const
+{
+    deps_type::const_iterator i;
+    for (i = entry.deps.begin() ; i != entry.deps.end() ; ++i)
+    {
+        const util::Stat st(i->first);
+        if (not st.exists() or st.mtime() != i->second)
+            return false;
+    }
+
+    return true;
+}
+/****************************************************************************/
+} // namespace portage
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
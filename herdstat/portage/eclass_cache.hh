@@ -0,0 +1,160 @@
+/*
+ * libherdstat -- herdstat/portage/eclass_cache.hh
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_ECLASS_CACHE_HH
+#define _HAVE_ECLASS_CACHE_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/portage/eclass_cache.hh
+ * @brief Defines the EclassCache class.
+ */
+
+#include <map>
+#include <list>
+#include <set>
+#include <vector>
+#include <string>
+#include <utility>
+#include <ctime>
+
+#include <herdstat/noncopyable.hh>
+#include <herdstat/util/vars.hh>
+#include <herdstat/util/thread.hh>
+
+namespace herdstat {
+namespace portage {
+
+    /**
+     * @class EclassCache eclass_cache.hh herdstat/portage/eclass_cache.hh
+     * @brief Process-wide cache of parsed eclass variables.
+     *
+     * @section overview Overview
+     *
+     * Each eclass is parsed at most once (per modification).  The variables
+     * it defines, including those of any eclasses it inherits itself, are
+     * cached and applied to any util::Vars object that inherits it.  A cached
+     * eclass is re-parsed if the mtime of it or any eclass it inherits has
+     * changed since it was cached.
+     *
+     * Eclasses are looked up in the overlays (last one listed wins) and then
+     * in ${PORTDIR}/eclass.  Non-existent eclasses are silently ignored, as
+     * are recursive inherits (eclass A inherits B which inherits A) and
+     * inherit chains deeper than max_depth.  An eclass whose variables were
+     * cut short by either is not cached, since the result depends on where
+     * in the inherit chain it was parsed.  Likewise, a cached eclass is
+     * only used where its own inherit chain fits under max_depth; elsewhere
+     * it is parsed again (and cut short).  So what an ebuild gets doesn't
+     * depend on what was inherited before it.
+     *
+     * @section usage Usage
+     *
+     * Like Config, EclassCache is a singleton that can only be accessed via
+     * GlobalEclassCache().  All public members are thread-safe.
+     */
+
+    class EclassCache : private Noncopyable
+    {
+        public:
+            /// Maximum inherit depth.
+            static const unsigned short max_depth;
+
+            /** Perform an inherit.  If @a line is an inherit statement, the
+             * variables of each inherited eclass are assigned to @a vars,
+             * overriding any variables already set.
+             * @param line Line (from an ebuild or eclass).
+             * @param vars Reference to a util::Vars object.
+             * @returns True if @a line is an inherit statement.
+             */
+            bool inherit(const std::string& line, util::Vars& vars);
+
+            /// Remove all cached eclasses.
+            void clear();
+
+        private:
+            friend EclassCache& GlobalEclassCache();
+            class Reader;
+            friend class Reader;
+
+            typedef std::vector<std::pair<std::string, std::time_t> > deps_type;
+
+            struct Entry
+            {
+                Entry() : vars(), deps(), height(1) { }
+
+                util::Vars::container_type vars;
+                /// This eclass and all eclasses it (indirectly) inherits.
+                deps_type deps;
+                /// Length of its longest inherit chain (1 if it inherits
+                /// nothing).
+                unsigned short height;
+            };
+
+            typedef std::map<std::string, Entry> entries_type;
+
+            /// Only GlobalEclassCache() can instantiate this class.
+            EclassCache() throw();
+            /// Destructor.
+            ~EclassCache() throw();
+
+            /// inherit() without locking.  Inherited eclasses are added to
+            /// the parent's deps and height, if any.
+            bool do_inherit(const std::string& line, util::Vars& vars,
+                            unsigned short depth, Entry *parent);
+            /// Look up (and parse if necessary) the specified eclass.
+            const Entry *lookup(const std::string& eclass, unsigned short depth);
+            /// Get path to the specified eclass or an empty string.
+            std::string find_eclass(const std::string& eclass) const;
+            /// Is the entry still up-to-date?
+            bool is_valid(const Entry& entry) const;
+
+            util::Mutex _mutex;
+            entries_type _entries;
+            /// eclasses that are currently being parsed.
+            std::set<std::string> _parsing;
+            /// Entries cut short by recursion or max_depth (current inherit).
+            std::list<Entry> _uncached;
+            /// Was the eclass currently being parsed cut short?
+            bool _truncated;
+    };
+
+    /**
+     * Sole access point to the EclassCache class.
+     * @returns reference to a local static instance of portage::EclassCache.
+     */
+
+    inline EclassCache&
+    GlobalEclassCache()
+    {
+        static EclassCache c;
+        return c;
+    }
+
+} // namespace portage
+} // namespace herdstat
+
+#endif /* _HAVE_ECLASS_CACHE_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
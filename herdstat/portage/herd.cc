@@ -61,6 +61,16 @@ Herd::~Herd() throw()
 {
 }
 /****************************************************************************/
+Herd&
+Herd::operator= (const Herd& that) throw()
+{
+    Developers::operator=(that);
+    _name = that._name;
+    _email = that._email;
+    _desc = that._desc;
+    return *this;
+}
+/****************************************************************************/
 Herds::Herds() throw()
 {
 }
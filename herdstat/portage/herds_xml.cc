@@ -29,8 +29,9 @@
 #include <herdstat/exceptions.hh>
 #include <herdstat/util/string.hh>
 #include <herdstat/util/file.hh>
+#include <herdstat/portage/serialize.hh>
 #include <herdstat/xml/document.hh>
-#include <herdstat/portage/project_xml.hh>
+#include <herdstat/portage/project_resolver.hh>
 #include <herdstat/portage/herds_xml.hh>
 
 #define HERDSXML_EXPIRE     86400
@@ -42,21 +43,22 @@ const char * const HerdsXML::_local_default = LOCALSTATEDIR"/herds.xml";
 /****************************************************************************/
 HerdsXML::HerdsXML() throw()
     : DataSource(), _herds(), _cvsdir(), _force_fetch(false), _fetch(),
-      in_herd(false), in_herd_name(false),
+      _projects(), _dev_index(), in_herd(false), in_herd_name(false),
       in_herd_email(false), in_herd_desc(false), in_maintainer(false),
       in_maintainer_name(false), in_maintainer_email(false),
       in_maintainer_role(false), in_maintaining_prj(false),
-      _cur_herd(), _cur_dev()
+      _cur_herd(), _cur_dev(), _text(), _skip(false)
 {
 }
 /****************************************************************************/
 HerdsXML::HerdsXML(const std::string& path)
     throw (FileException, xml::ParserException)
     : DataSource(path), _herds(), _cvsdir(), _force_fetch(false), _fetch(),
-      in_herd(false), in_herd_name(false), in_herd_email(false),
-      in_herd_desc(false), in_maintainer(false), in_maintainer_name(false),
-      in_maintainer_email(false), in_maintainer_role(false), in_maintaining_prj(false),
-      _cur_herd(), _cur_dev()
+      _projects(), _dev_index(), in_herd(false), in_herd_name(false),
+      in_herd_email(false), in_herd_desc(false), in_maintainer(false),
+      in_maintainer_name(false), in_maintainer_email(false),
+      in_maintainer_role(false), in_maintaining_prj(false),
+      _cur_herd(), _cur_dev(), _text(), _skip(false)
 {
     this->parse();
 }
@@ -79,12 +81,86 @@ HerdsXML::do_parse(const std::string& path)
     if (not util::is_file(this->path()))
         throw FileException(this->path());
 
-    this->parse_file(this->path().c_str());
+    /* the snapshot holds herds.xml as parsed; <maintainingproject> XML's
+     * are resolved every time so that they're re-fetched once they expire */
+    if (_force_fetch or not this->load_snapshot())
+    {
+        this->parse_file(this->path());
+        this->save_snapshot();
+    }
+
+    this->resolve_projects();
+
+    this->build_dev_index();
 
     this->timer().stop();
 }
 /****************************************************************************/
 void
+HerdsXML::resolve_projects()
+{
+    if (_projects.empty())
+        return;
+
+    ProjectResolver resolver(_cvsdir, _force_fetch);
+
+    std::vector<std::pair<std::string, std::string> >::iterator i;
+    for (i = _projects.begin() ; i != _projects.end() ; ++i)
+        resolver.add(i->second);
+
+    resolver.resolve();
+
+    for (i = _projects.begin() ; i != _projects.end() ; ++i)
+    {
+        if (meter())
+            ++*meter();
+
+        Herds::iterator h = _herds.find(i->first);
+        if (h == _herds.end())
+            continue;
+
+        /* set elements are immutable; replace the herd */
+        Herd herd(*h);
+        resolver.merge(i->second, herd);
+        _herds.erase(h);
+        _herds.insert(herd);
+    }
+
+    _projects.clear();
+}
+/****************************************************************************/
+void
+HerdsXML::build_dev_index()
+{
+    _dev_index.clear();
+
+    for (Herds::const_iterator h = _herds.begin() ; h != _herds.end() ; ++h)
+        for (Herd::const_iterator d = h->begin() ; d != h->end() ; ++d)
+            _dev_index[d->user()].push_back(DevEntry(h->name(), *d));
+}
+/****************************************************************************/
+bool
+HerdsXML::do_load_snapshot(io::BinaryIStream& stream)
+{
+    io::deserialize(stream, _herds);
+    io::deserialize(stream, _projects);
+    if (stream)
+        return true;
+
+    _herds.clear();
+    _projects.clear();
+    return false;
+}
+/****************************************************************************/
+bool
+HerdsXML::do_save_snapshot(io::BinaryOStream& stream) const
+{
+    io::serialize(stream, _herds);
+    io::serialize(stream, _projects);
+    return true;
+}
+/****************************************************************************/
+void
 HerdsXML::fill_developer(Developer& dev) const throw (Exception)
 {
     BacktraceContext c("portage::HerdsXML::fill_developer()");
@@ -93,118 +169,198 @@ HerdsXML::fill_developer(Developer& dev) const throw (Exception)
     if (dev.user().empty())
         throw Exception("HerdsXML::fill_developer() requires you pass a Developer object with at least the user name filled in");
 
-    /* for each herd */
-    for (Herds::const_iterator h = _herds.begin() ; h != _herds.end() ; ++h)
+    const dev_index_type::const_iterator i = _dev_index.find(dev.user());
+    if (i == _dev_index.end())
+        return;
+
+    /* for each herd the developer is in */
+    std::vector<DevEntry>::const_iterator e;
+    for (e = i->second.begin() ; e != i->second.end() ; ++e)
     {
-        /* is the developer in this herd? */
-        Herd::const_iterator d = h->find(dev);
-        if (d != h->end())
-        {
-            if (dev.name().empty() and not d->name().empty())
-                dev.set_name(d->name());
-            dev.set_email(d->email());
-            dev.append_herd(h->name());
-        }
+        if (dev.name().empty() and not e->name.empty())
+            dev.set_name(e->name);
+        dev.set_email(e->email);
+        dev.append_herd(e->herd);
     }
 }
 /****************************************************************************/
+const xml::ElementTable&
+HerdsXML::elements() const
+{
+    static const xml::ElementTableEntry entries[] = {
+        { "herd",               HERD },
+        { "name",               NAME },
+        { "email",              EMAIL },
+        { "description",        DESCRIPTION },
+        { "maintainer",         MAINTAINER },
+        { "role",               ROLE },
+        { "maintainingproject", MAINTAININGPROJECT }
+    };
+    static const xml::ElementTable table(entries,
+        sizeof(entries) / sizeof(entries[0]));
+    return table;
+}
+/****************************************************************************/
 bool
-HerdsXML::start_element(const std::string& name,
+HerdsXML::start_element(xml::element_id id,
                         const attrs_type& attrs LIBHERDSTAT_UNUSED)
 {
     if (meter())
         ++*meter();
 
-    if (name == "herd")
-        in_herd = true;
-    else if (name == "name" and not in_maintainer)
-        in_herd_name = true;
-    else if (name == "email" and not in_maintainer)
-        in_herd_email = true;
-    else if (name == "description" and not in_maintainer)
-        in_herd_desc = true;
-    else if (name == "maintainer")
-        in_maintainer = true;
-    else if (name == "email" and in_maintainer)
-        in_maintainer_email = true;
-    else if (name == "name" and in_maintainer)
-        in_maintainer_name = true;
-    else if (name == "role")
-        in_maintainer_role = true;
-    else if (name == "maintainingproject")
-        in_maintaining_prj = true;
+    /* inside a <herd> that doesn't match the query */
+    if (_skip)
+        return true;
+
+    switch (id)
+    {
+        case HERD:
+            in_herd = true;
+            _cur_herd = Herd();
+            break;
+        case NAME:
+            if (in_maintainer) in_maintainer_name = true;
+            else in_herd_name = true;
+            _text.clear();
+            break;
+        case EMAIL:
+            if (in_maintainer) in_maintainer_email = true;
+            else in_herd_email = true;
+            _text.clear();
+            break;
+        case DESCRIPTION:
+            if (not in_maintainer) in_herd_desc = true;
+            _text.clear();
+            break;
+        case MAINTAINER:
+            in_maintainer = true;
+            _cur_dev = Developer();
+            break;
+        case ROLE:
+            in_maintainer_role = true;
+            _text.clear();
+            break;
+        case MAINTAININGPROJECT:
+            in_maintaining_prj = true;
+            _text.clear();
+            break;
+    }
 
     return true;
 }
 /****************************************************************************/
 bool
-HerdsXML::end_element(const std::string& name)
+HerdsXML::end_element(xml::element_id id)
 {
     if (meter())
         ++*meter();
 
-    if (name == "herd")
-        in_herd = false;
-    else if (name == "name" and not in_maintainer)
-        in_herd_name = false;
-    else if (name == "email" and not in_maintainer)
-        in_herd_email = false;
-    else if (name == "description" and not in_maintainer)
-        in_herd_desc = false;
-    else if (name == "maintainer")
-        in_maintainer = false;
-    else if (name == "email" and in_maintainer)
-        in_maintainer_email = false;
-    else if (name == "name" and in_maintainer)
-        in_maintainer_name = false;
-    else if (name == "role")
-        in_maintainer_role = false;
-    else if (name == "maintainingproject")
-        in_maintaining_prj = false;
+    if (_skip)
+    {
+        if (id == HERD)
+            _skip = in_herd = false;
+        return true;
+    }
+
+    switch (id)
+    {
+        case HERD:
+        {
+            in_herd = false;
+            if (_cur_herd.name().empty())
+                break;
+
+            std::pair<Herds::iterator, bool> p = _herds.insert(_cur_herd);
+            if (not p.second)
+            {
+                /* herd listed twice; merge developers */
+                Herd herd(*(p.first));
+                herd.insert(_cur_herd.begin(), _cur_herd.end());
+                _herds.erase(p.first);
+                _herds.insert(herd);
+            }
+
+            /* found the queried herd; stop parsing */
+            if (not this->query().empty())
+                return false;
+            break;
+        }
+        case NAME:
+            if (in_maintainer)
+            {
+                in_maintainer_name = false;
+                _cur_dev.set_name(_text);
+            }
+            else if (in_herd_name)
+            {
+                in_herd_name = false;
+                /* <name> comes first; Herd() defaults the email from it */
+                _cur_herd = Herd(_text);
+
+                /* skip the rest of herds not matching the query */
+                if (not this->wanted(_cur_herd.name()))
+                {
+                    _cur_herd = Herd();
+                    _skip = true;
+                }
+            }
+            break;
+        case EMAIL:
+            if (in_maintainer)
+            {
+                in_maintainer_email = false;
+
+                const std::string email(util::lowercase(_text));
+                _cur_dev.set_user(email.substr(0, email.find('@')));
+                _cur_dev.set_email(email);
+            }
+            else if (in_herd_email)
+            {
+                in_herd_email = false;
+                _cur_herd.set_email(_text);
+            }
+            break;
+        case DESCRIPTION:
+            if (in_herd_desc)
+            {
+                in_herd_desc = false;
+                _cur_herd.set_desc(_text);
+            }
+            break;
+        case MAINTAINER:
+            in_maintainer = false;
+            if (not _cur_dev.user().empty())
+                _cur_herd.insert(_cur_dev);
+            break;
+        case ROLE:
+            in_maintainer_role = false;
+            _cur_dev.set_role(_text);
+            break;
+        case MAINTAININGPROJECT:
+            /*
+             * special case - for <maintainingproject> we must fetch
+             * the listed XML, parse it, and then fill the developer
+             * container.  That's done once we're done parsing (see
+             * resolve_projects()).
+             */
+            in_maintaining_prj = false;
+            _projects.push_back(std::make_pair(_cur_herd.name(), _text));
+            break;
+    }
 
     return true;
 }
 /****************************************************************************/
 bool
-HerdsXML::do_text(const std::string& text)
+HerdsXML::do_text(const util::StringView& text)
 {
     if (meter())
         ++*meter();
 
-    if (in_herd_name)
-        _cur_herd = _herds.insert(Herd(text)).first;
-    else if (in_herd_desc)
-        const_cast<Herd&>(*_cur_herd).set_desc(text);
-    else if (in_herd_email)
-        const_cast<Herd&>(*_cur_herd).set_email(text);        
-    else if (in_maintainer_email)
-        _cur_dev = const_cast<Herd&>(*_cur_herd).insert(
-                Developer(util::lowercase(text))).first;
-    else if (in_maintainer_name)
-        const_cast<Developer&>(*_cur_dev).set_name(_cur_dev->name() + text);
-    else if (in_maintainer_role)
-        const_cast<Developer&>(*_cur_dev).set_role(text);
-
-    else if (in_maintaining_prj)
-    {
-        /* 
-         * special case - for <maintainingproject> we must fetch
-         * the listed XML, parse it, and then fill the developer
-         * container.
-         */
-
-        try
-        {
-            ProjectXML mp(text, _cvsdir, _force_fetch);
-            mp.set_meter(this->meter());
-            const_cast<Herd&>(*_cur_herd).insert(
-                mp.devs().begin(), mp.devs().end());
-        }
-        catch (const FileException& e)
-        {
-            std::cerr << e.what() << std::endl;            
-        }
-    }
+    if (in_herd_name or in_herd_desc or in_herd_email or
+        in_maintainer_email or in_maintainer_name or in_maintainer_role or
+        in_maintaining_prj)
+        text.append_to(_text);
 
     return true;
 }
@@ -33,6 +33,9 @@
  */
 
 #include <algorithm>
+#include <map>
+#include <vector>
+#include <utility>
 #include <herdstat/fetcher/fetcher.hh>
 #include <herdstat/portage/data_source.hh>
 #include <herdstat/portage/herd.hh>
@@ -51,6 +54,20 @@ namespace portage {
      * you may get the underlying portage::Herds container via the herds()
      * member.
      *
+     * The projectxml files listed in <maintainingproject> elements are
+     * only recorded while parsing herds.xml.  Afterwards they (and any
+     * subprojects they inherit members from) are fetched and parsed
+     * concurrently by a portage::ProjectResolver, and their developers are
+     * merged into the respective herds.  This is done even if herds.xml
+     * itself was loaded from a snapshot (see DataSource), so the project
+     * files are still re-fetched once they expire.
+     *
+     * Once parsed, an index of developer (user name) to the herds they
+     * belong to is built, so fill_developer() doesn't have to search every
+     * herd.  The index holds copies of what it needs, as of the last
+     * parse(); changes made via herds() afterwards aren't seen by
+     * fill_developer() until the next parse().
+     *
      * @include herds.xml/main.cc
      */
 
@@ -115,17 +132,50 @@ namespace portage {
 
             ///@{
             /// SAX2 Callbacks
-            virtual bool start_element(const std::string &name,
-                                       const attrs_type  &attrs);
-            virtual bool end_element(const std::string &name);
-            virtual bool do_text(const std::string &text);
+            virtual const xml::ElementTable& elements() const;
+            virtual bool start_element(xml::element_id id,
+                                       const attrs_type& attrs);
+            virtual bool end_element(xml::element_id id);
+            virtual bool do_text(const util::StringView& text);
+            ///@}
+
+            ///@{
+            /// Snapshot support.
+            virtual bool do_load_snapshot(io::BinaryIStream& stream);
+            virtual bool do_save_snapshot(io::BinaryOStream& stream) const;
             ///@}
 
         private:
+            /// herds.xml elements.
+            enum { HERD = 1, NAME, EMAIL, DESCRIPTION, MAINTAINER, ROLE,
+                   MAINTAININGPROJECT };
+
+            /// Herd a developer is listed in, and their name and email
+            /// there.
+            struct DevEntry
+            {
+                DevEntry(const std::string& h, const Developer& d)
+                    : herd(h), name(d.name()), email(d.email()) { }
+
+                std::string herd, name, email;
+            };
+
+            /// user name -> herds the developer is listed in (in order).
+            typedef std::map<std::string, std::vector<DevEntry> >
+                dev_index_type;
+
+            /// Resolve <maintainingproject>'s recorded while parsing.
+            void resolve_projects();
+            /// Build _dev_index from _herds.
+            void build_dev_index();
+
             Herds _herds;
             std::string _cvsdir;
             bool _force_fetch;
             Fetcher _fetch; /* for fetching <maintainingproject> XML's */
+            /// herd and the projectxml it lists in <maintainingproject>.
+            std::vector<std::pair<std::string, std::string> > _projects;
+            dev_index_type _dev_index;
             static const char * const _local_default;
 
             /* internal state variables */
@@ -139,8 +189,13 @@ namespace portage {
                  in_maintainer_role,
                  in_maintaining_prj;
 
-            Herds::iterator _cur_herd;
-            Herd::iterator  _cur_dev;
+            /// herd/developer being parsed (inserted at </herd>/</maintainer>).
+            Herd _cur_herd;
+            Developer _cur_dev;
+            /// text of the current element.
+            std::string _text;
+            /// skipping a <herd> that doesn't match the query?
+            bool _skip;
     };
 
     inline HerdsXML::operator Herds::container_type() const { return _herds; }
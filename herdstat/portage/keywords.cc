@@ -133,6 +133,19 @@ Keywords::assign(const Ebuild& e) throw (Exception)
 }
 /****************************************************************************/
 void
+Keywords::assign(const std::string& path, const std::string& keywords)
+    throw (Exception)
+{
+    _ebuild.clear();
+    _ebuild.set_path(path);
+    _ebuild["KEYWORDS"] = keywords;
+
+    _str.clear();
+    this->fill();
+    this->format();
+}
+/****************************************************************************/
+void
 Keywords::fill() throw (Exception)
 {
     BacktraceContext c("portage::Keywords::fill()");
@@ -264,6 +264,15 @@ namespace portage {
              */
             void assign(const Ebuild& e) throw (Exception);
 
+            /** Assign keywords already read from an ebuild (e.g. from a
+             * cache), without reading it again.
+             * @param path Path to ebuild.
+             * @param keywords Value of its KEYWORDS variable.
+             * @exception Exception
+             */
+            void assign(const std::string& path, const std::string& keywords)
+                throw (Exception);
+
             /// Get formatted keywords string.
             inline const std::string& str() const throw();
 
@@ -0,0 +1,683 @@
+/*
+ * libherdstat -- herdstat/portage/metadata_index.cc
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <cerrno>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <herdstat/exceptions.hh>
+#include <herdstat/util/string.hh>
+#include <herdstat/util/file.hh>
+#include <herdstat/io/binary_stream.hh>
+#include <herdstat/io/mapped_binary_reader.hh>
+#include <herdstat/xml/fast_saxparser.hh>
+#include <herdstat/portage/config.hh>
+#include <herdstat/portage/util.hh>
+#include <herdstat/portage/metadata_index.hh>
+
+namespace herdstat {
+namespace portage {
+/*** static members *********************************************************/
+const unsigned int MetadataIndex::cache_version = 2;
+const MetadataIndex::size_type MetadataIndex::chunk_size = 16;
+/* "HSMI" */
+static const unsigned int cache_magic = 0x48534d49;
+/****************************************************************************
+ * Read the file at @a path into @a buf (which is reused across calls so its
+ * capacity only ever grows).  Failure isn't exceptional here, so no
+ * exceptions are used.
+ ****************************************************************************/
+static bool
+read_file(const std::string& path, std::string& buf)
+{
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    buf.resize(st.st_size);
+
+    std::string::size_type pos = 0;
+    while (pos < buf.size())
+    {
+        const ssize_t n = read(fd, &buf[pos], buf.size() - pos);
+        if (n < 0 and errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        pos += n;
+    }
+
+    close(fd);
+    buf.resize(pos);
+    return true;
+}
+/****************************************************************************/
+static void
+write_strings(io::BinaryOStream& stream, const std::vector<std::string>& v)
+{
+    stream.write_varint(v.size());
+
+    std::vector<std::string>::const_iterator i;
+    for (i = v.begin() ; i != v.end() ; ++i)
+        stream << *i;
+}
+/****************************************************************************/
+/* can n more strings (or anything at least as big) possibly be left?  each
+ * takes at least a byte (its length) */
+static bool
+fits(const io::MappedBinaryReader& stream, std::size_t n)
+{
+    return (n <= stream.size() - stream.tell());
+}
+/****************************************************************************/
+static bool
+read_strings(io::MappedBinaryReader& stream, std::vector<std::string>& v)
+{
+    std::vector<std::string>::size_type n = 0;
+    stream.read_varint(n);
+    if (not stream or not fits(stream, n))
+        return false;
+
+    v.resize(n);
+
+    std::vector<std::string>::iterator i;
+    for (i = v.begin() ; i != v.end() and stream ; ++i)
+        stream >> *i;
+
+    return stream;
+}
+/****************************************************************************
+ * Parses metadata.xml's handed out by MetadataIndex::next_chunk() until there
+ * are none left.  Each worker owns a single FastSAXParser (the only backend
+ * that is safe to run concurrently) and a single read buffer.
+ ****************************************************************************/
+class MetadataIndex::Worker : public util::Thread,
+                              protected xml::SAXHandler
+{
+    public:
+        Worker(MetadataIndex& index)
+            : util::Thread(), xml::SAXHandler(), _index(index),
+              _parser(this), _buf(), _text(), _entry(NULL),
+              in_herd(false), in_maintainer(false), in_email(false) { }
+
+        virtual ~Worker() throw() { }
+
+    protected:
+        virtual void run();
+
+        virtual const xml::ElementTable& elements() const;
+        virtual bool start_element(xml::element_id id,
+                                   const attrs_type& attrs);
+        virtual bool end_element(xml::element_id id);
+        virtual bool do_text(const util::StringView& text);
+
+    private:
+        enum { CATMETADATA = 1, HERD, MAINTAINER, EMAIL };
+
+        void parse(MetadataIndexEntry& entry);
+
+        MetadataIndex& _index;
+        xml::FastSAXParser _parser;
+        std::string _buf;
+        std::string _text;
+        MetadataIndexEntry *_entry;
+
+        bool in_herd,
+             in_maintainer,
+             in_email;
+};
+/****************************************************************************/
+void
+MetadataIndex::Worker::run()
+{
+    size_type begin, end;
+    while (_index.next_chunk(&begin, &end))
+    {
+        for (; begin != end ; ++begin)
+            this->parse(_index[_index._pending[begin]]);
+    }
+}
+/****************************************************************************/
+void
+MetadataIndex::Worker::parse(MetadataIndexEntry& entry)
+{
+    _entry = &entry;
+    _entry->category = false;
+    _entry->herds.clear();
+    _entry->devs.clear();
+    in_herd = in_maintainer = in_email = false;
+
+    if (not read_file(entry.path, _buf))
+    {
+        /* make sure it's retried next time if cached */
+        entry.mtime = 0;
+        _index.add_failed(entry.path);
+        return;
+    }
+
+    try
+    {
+        _parser.parse(_buf.data(), _buf.data() + _buf.size(), entry.path);
+    }
+    catch (const xml::ParserException&)
+    {
+        entry.herds.clear();
+        entry.devs.clear();
+        entry.mtime = 0;
+        _index.add_failed(entry.path);
+    }
+}
+/****************************************************************************/
+const xml::ElementTable&
+MetadataIndex::Worker::elements() const
+{
+    static const xml::ElementTableEntry entries[] = {
+        { "catmetadata",        CATMETADATA },
+        { "herd",               HERD },
+        { "maintainer",         MAINTAINER },
+        { "email",              EMAIL }
+    };
+    static const xml::ElementTable table(entries,
+        sizeof(entries) / sizeof(entries[0]));
+    return table;
+}
+/****************************************************************************/
+bool
+MetadataIndex::Worker::start_element(xml::element_id id,
+                                     const attrs_type& attrs LIBHERDSTAT_UNUSED)
+{
+    switch (id)
+    {
+        case CATMETADATA:
+            _entry->category = true;
+            break;
+        case HERD:
+            in_herd = true;
+            _text.clear();
+            break;
+        case MAINTAINER:
+            in_maintainer = true;
+            break;
+        case EMAIL:
+            if (in_maintainer)
+            {
+                in_email = true;
+                _text.clear();
+            }
+            break;
+    }
+
+    return true;
+}
+/****************************************************************************/
+bool
+MetadataIndex::Worker::end_element(xml::element_id id)
+{
+    std::vector<std::string>& herds(_entry->herds);
+    std::vector<std::string>& devs(_entry->devs);
+
+    switch (id)
+    {
+        case HERD:
+            in_herd = false;
+            _text.erase(0, _text.find_first_not_of(" \t\n"));
+            _text.erase(_text.find_last_not_of(" \t\n") + 1);
+            _text.erase(std::min(_text.find('@'), _text.size()));
+            if (not _text.empty() and
+                std::find(herds.begin(), herds.end(), _text) == herds.end())
+                herds.push_back(_text);
+            break;
+        case MAINTAINER:
+            in_maintainer = false;
+            break;
+        case EMAIL:
+        {
+            if (not in_email)
+                break;
+            in_email = false;
+
+            _text.erase(0, _text.find_first_not_of(" \t\n"));
+            _text.erase(_text.find_last_not_of(" \t\n") + 1);
+            if (_text.empty())
+                break;
+
+            /* only insert it if it's not a herd */
+            const std::string user(_text.substr(0, _text.find('@')));
+            if (std::find(herds.begin(), herds.end(), user) != herds.end())
+                break;
+
+            const std::string email(util::lowercase(_text));
+            if (std::find(devs.begin(), devs.end(), email) == devs.end())
+                devs.push_back(email);
+            break;
+        }
+    }
+
+    return true;
+}
+/****************************************************************************/
+bool
+MetadataIndex::Worker::do_text(const util::StringView& text)
+{
+    if (in_herd or in_email)
+        text.append_to(_text);
+    return true;
+}
+/****************************************************************************/
+MetadataIndex::MetadataIndex(bool fill)
+    : _portdir(GlobalConfig().portdir()),
+      _overlays(GlobalConfig().overlays()),
+      _filled(false), _cache(), _failed(), _herds(), _devs(),
+      _pending(), _mutex(), _next(0)
+{
+    if (fill)
+        this->fill();
+}
+/****************************************************************************/
+MetadataIndex::MetadataIndex(const std::string& portdir,
+                             const std::vector<std::string>& overlays,
+                             bool fill)
+    : _portdir(portdir), _overlays(overlays),
+      _filled(false), _cache(), _failed(), _herds(), _devs(),
+      _pending(), _mutex(), _next(0)
+{
+    if (fill)
+        this->fill();
+}
+/****************************************************************************/
+MetadataIndex::~MetadataIndex() throw()
+{
+}
+/****************************************************************************/
+void
+MetadataIndex::fill(unsigned int jobs) throw (Exception)
+{
+    BacktraceContext c("herdstat::portage::MetadataIndex::fill()");
+
+    if (_filled)
+        return;
+
+    this->discover();
+
+    _failed.clear();
+    _pending.clear();
+
+    bool dirty = true;
+    if (_cache.empty())
+    {
+        _pending.reserve(this->size());
+        for (size_type n = 0 ; n < this->size() ; ++n)
+            _pending.push_back(n);
+    }
+    else
+        dirty = this->merge_cache();
+
+    if (jobs == 0)
+        jobs = util::Thread::hardware_concurrency();
+    /* no point in having workers that would never get a chunk */
+    jobs = std::min<size_type>(jobs, (_pending.size() + chunk_size - 1) /
+                                     chunk_size);
+
+    _next = 0;
+
+    std::vector<Worker *> workers;
+    workers.reserve(jobs);
+
+    try
+    {
+        for (unsigned int i = 0 ; i < jobs ; ++i)
+        {
+            workers.push_back(new Worker(*this));
+            workers.back()->start();
+        }
+    }
+    catch (const ErrnoException&)
+    {
+        /* only fatal if we couldn't start a single thread */
+        if (not workers.back()->running())
+        {
+            delete workers.back();
+            workers.pop_back();
+        }
+
+        if (workers.empty())
+            throw;
+    }
+
+    /* join every worker before reporting one that failed */
+    std::string error;
+    std::vector<Worker *>::iterator i;
+    for (i = workers.begin() ; i != workers.end() ; ++i)
+    {
+        try
+        {
+            (*i)->join();
+        }
+        catch (const Exception& e)
+        {
+            if (error.empty())
+                error.assign(e.what());
+        }
+
+        delete *i;
+    }
+
+    if (not error.empty())
+        throw Exception("%s", error.c_str());
+
+    std::sort(_failed.begin(), _failed.end());
+    this->build_reverse();
+
+    /* failing to write the cache only costs us next time */
+    if (dirty and not _cache.empty())
+    {
+        try
+        {
+            this->dump_cache();
+        }
+        catch (const FileException&)
+        {
+        }
+    }
+
+    _filled = true;
+}
+/****************************************************************************/
+MetadataIndex::iterator
+MetadataIndex::find(const std::string& pkg)
+{
+    MetadataIndexEntry key;
+    key.pkg.assign(pkg);
+
+    iterator i = std::lower_bound(this->begin(), this->end(), key);
+    return ((i != this->end() and i->pkg == pkg) ? i : this->end());
+}
+/****************************************************************************/
+MetadataIndex::const_iterator
+MetadataIndex::find(const std::string& pkg) const
+{
+    MetadataIndexEntry key;
+    key.pkg.assign(pkg);
+
+    const_iterator i = std::lower_bound(this->begin(), this->end(), key);
+    return ((i != this->end() and i->pkg == pkg) ? i : this->end());
+}
+/****************************************************************************/
+const MetadataIndex::ids_type&
+MetadataIndex::herd_packages(const std::string& herd) const
+{
+    static const ids_type empty;
+    const reverse_type::const_iterator i = _herds.find(herd);
+    return (i == _herds.end() ? empty : i->second);
+}
+/****************************************************************************/
+const MetadataIndex::ids_type&
+MetadataIndex::dev_packages(const std::string& email) const
+{
+    static const ids_type empty;
+    const reverse_type::const_iterator i = _devs.find(util::lowercase(email));
+    return (i == _devs.end() ? empty : i->second);
+}
+/****************************************************************************/
+const MetadataIndex::ids_type&
+MetadataIndex::user_packages(const std::string& user) const
+{
+    return this->dev_packages(user+"@gentoo.org");
+}
+/****************************************************************************/
+void
+MetadataIndex::discover()
+{
+    /* pkg -> metadata.xml and its mtime; later trees (overlays) override
+     * earlier ones */
+    std::map<std::string, std::pair<std::string, std::time_t> > paths;
+    util::Stat st;
+
+    std::vector<std::string> trees(1, _portdir);
+    trees.insert(trees.end(), _overlays.begin(), _overlays.end());
+
+    const Categories& categories(GlobalConfig().categories());
+    std::string path;
+
+    std::vector<std::string>::const_iterator t;
+    for (t = trees.begin() ; t != trees.end() ; ++t)
+    {
+        Categories::const_iterator ci;
+        for (ci = categories.begin() ; ci != categories.end() ; ++ci)
+        {
+            path.assign(*t+"/"+(*ci));
+            if (not util::is_dir(path))
+                continue;
+
+            const util::Directory cat(path);
+
+            st.assign(path+"/metadata.xml");
+            if (st.exists() and st.type() == util::REGULAR)
+                paths[*ci] = std::make_pair(st.path(), st.mtime());
+
+            util::Directory::const_iterator i;
+            for (i = cat.begin() ; i != cat.end() ; ++i)
+            {
+                st.assign(*i+"/metadata.xml");
+                if (st.exists() and st.type() == util::REGULAR)
+                    paths[get_pkg_from_path(*i)] =
+                        std::make_pair(st.path(), st.mtime());
+            }
+        }
+    }
+
+    this->clear();
+    this->reserve(paths.size());
+
+    /* std::map is already sorted by package */
+    std::map<std::string, std::pair<std::string, std::time_t> >::const_iterator i;
+    for (i = paths.begin() ; i != paths.end() ; ++i)
+    {
+        this->push_back(MetadataIndexEntry());
+        this->back().pkg.assign(i->first);
+        this->back().path.assign(i->second.first);
+        this->back().mtime = i->second.second;
+    }
+}
+/****************************************************************************/
+bool
+MetadataIndex::merge_cache()
+{
+    container_type cached;
+    if (not this->load_cache(cached))
+    {
+        _pending.reserve(this->size());
+        for (size_type n = 0 ; n < this->size() ; ++n)
+            _pending.push_back(n);
+        return true;
+    }
+
+    /* both are sorted by package */
+    container_type::iterator c = cached.begin();
+    for (size_type n = 0 ; n < this->size() ; ++n)
+    {
+        MetadataIndexEntry& entry((*this)[n]);
+
+        while (c != cached.end() and c->pkg < entry.pkg)
+            ++c;
+
+        if (c != cached.end() and c->pkg == entry.pkg and
+            c->path == entry.path and c->mtime == entry.mtime)
+        {
+            entry.category = c->category;
+            entry.herds.swap(c->herds);
+            entry.devs.swap(c->devs);
+            ++c;
+        }
+        else
+            _pending.push_back(n);
+    }
+
+    /* packages may have been removed */
+    return (not _pending.empty() or cached.size() != this->size());
+}
+/****************************************************************************/
+bool
+MetadataIndex::load_cache(container_type& entries) const
+{
+    if (not util::is_file(_cache))
+        return false;
+
+    /* mapped, so loading costs one copy (into the entries) */
+    io::MappedBinaryReader stream(_cache);
+
+    unsigned int magic = 0, version = 0;
+    stream >> magic >> version;
+    if (not stream or magic != cache_magic or version != cache_version)
+        return false;
+
+    std::string portdir;
+    std::vector<std::string> overlays;
+    stream >> portdir;
+    if (not read_strings(stream, overlays) or
+        portdir != _portdir or overlays != _overlays)
+        return false;
+
+    size_type n = 0;
+    stream.read_varint(n);
+    if (not stream or not fits(stream, n))
+        return false;
+
+    entries.resize(n);
+
+    container_type::iterator i;
+    for (i = entries.begin() ; i != entries.end() ; ++i)
+    {
+        stream >> i->pkg >> i->path >> i->mtime >> i->category;
+        if (not read_strings(stream, i->herds) or
+            not read_strings(stream, i->devs))
+            return false;
+    }
+
+    return true;
+}
+/****************************************************************************/
+void
+MetadataIndex::dump_cache() const throw (FileException)
+{
+    /* write to a temporary and rename it so readers never see a partial
+     * cache */
+    const std::string tmp(util::tmp_path(_cache));
+
+    {
+        io::BinaryOStream stream(tmp);
+        if (not stream)
+            throw FileException(tmp);
+
+        stream << cache_magic << cache_version << _portdir;
+        write_strings(stream, _overlays);
+        stream.write_varint(this->size());
+
+        const_iterator i;
+        for (i = this->begin() ; i != this->end() ; ++i)
+        {
+            stream << i->pkg << i->path << i->mtime << i->category;
+            write_strings(stream, i->herds);
+            write_strings(stream, i->devs);
+        }
+
+        if (not stream.close())
+        {
+            std::remove(tmp.c_str());
+            throw FileException(tmp);
+        }
+    }
+
+    if (std::rename(tmp.c_str(), _cache.c_str()) != 0)
+    {
+        std::remove(tmp.c_str());
+        throw FileException(_cache);
+    }
+}
+/****************************************************************************/
+void
+MetadataIndex::build_reverse()
+{
+    _herds.clear();
+    _devs.clear();
+
+    for (size_type n = 0 ; n < this->size() ; ++n)
+    {
+        const MetadataIndexEntry& entry((*this)[n]);
+
+        std::vector<std::string>::const_iterator i;
+        for (i = entry.herds.begin() ; i != entry.herds.end() ; ++i)
+        {
+            ids_type& ids(_herds[*i]);
+            if (ids.empty() or ids.back() != n)
+                ids.push_back(n);
+        }
+
+        /* devs are keyed by (lowercased) email address */
+        for (i = entry.devs.begin() ; i != entry.devs.end() ; ++i)
+        {
+            ids_type& ids(_devs[*i]);
+            if (ids.empty() or ids.back() != n)
+                ids.push_back(n);
+        }
+    }
+}
+/****************************************************************************/
+bool
+MetadataIndex::next_chunk(size_type *begin, size_type *end)
+{
+    util::MutexLock lock(_mutex);
+
+    if (_next >= _pending.size())
+        return false;
+
+    *begin = _next;
+    *end = _next = std::min(_next + chunk_size, _pending.size());
+    return true;
+}
+/****************************************************************************/
+void
+MetadataIndex::add_failed(const std::string& path)
+{
+    util::MutexLock lock(_mutex);
+    _failed.push_back(path);
+}
+/****************************************************************************/
+} // namespace portage
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,264 @@
+/*
+ * libherdstat -- herdstat/portage/metadata_index.hh
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_METADATA_INDEX_HH
+#define _HAVE_METADATA_INDEX_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/portage/metadata_index.hh
+ * @brief Defines the MetadataIndex class.
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+#include <ctime>
+
+#include <herdstat/noncopyable.hh>
+#include <herdstat/util/container_base.hh>
+#include <herdstat/util/thread.hh>
+
+namespace herdstat {
+namespace portage {
+
+    /**
+     * @struct MetadataIndexEntry metadata_index.hh herdstat/portage/metadata_index.hh
+     * @brief Herds and developers listed in a single metadata.xml.
+     */
+
+    struct MetadataIndexEntry
+    {
+        /// Package ("cat/pkg") or category name.
+        std::string pkg;
+        /// Path to metadata.xml.
+        std::string path;
+        /// Modification time of metadata.xml when it was parsed.
+        std::time_t mtime;
+        /// Is this a category metadata.xml?
+        bool category;
+        /// Herd names.
+        std::vector<std::string> herds;
+        /// Developer email addresses (lowercase).
+        std::vector<std::string> devs;
+
+        MetadataIndexEntry() : pkg(), path(), mtime(0), category(false),
+                               herds(), devs() { }
+
+        bool operator< (const MetadataIndexEntry& that) const
+        { return (pkg < that.pkg); }
+    };
+
+    /**
+     * @class MetadataIndex metadata_index.hh herdstat/portage/metadata_index.hh
+     * @brief Package to herds/developers table for the whole tree.
+     *
+     * @section overview Overview
+     *
+     * fill() finds every category and package metadata.xml in PORTDIR and
+     * any overlays (a package's metadata.xml in an overlay supersedes the
+     * one in PORTDIR) and parses them concurrently on a pool of worker
+     * threads.  Each worker uses a single SAXParser for all the files it
+     * parses and only records herd names and maintainer email addresses,
+     * so this is considerably cheaper than instantiating a MetadataXML
+     * object per package.
+     *
+     * Files that fail to parse are skipped and are available via failed().
+     *
+     * @section cache Cache
+     *
+     * If a cache file has been set via set_cache(), fill() loads it first
+     * and only parses the metadata.xml's whose mtime differs from the one
+     * recorded in the cache (or that weren't in the cache at all).  The
+     * cache is re-written afterwards if anything changed; failing to write
+     * it is not an error.  A cache written
+     * for a different PORTDIR/overlays or by a different version of this
+     * class is ignored.
+     *
+     * @section usage Usage
+     *
+     * MetadataIndex is a sorted (by package name) vector of
+     * MetadataIndexEntry objects.  Use find() to look up a package.  The
+     * position of an entry in the index is its package ID; use
+     * herd_packages() and dev_packages() to get the IDs of all packages
+     * maintained by a herd or developer (by email address, since
+     * maintainers from outside gentoo.org may share a user name with a
+     * Gentoo developer).  user_packages() looks up a Gentoo developer by
+     * user name.
+     *
+     * @section example Example
+     *
+@code
+herdstat::portage::MetadataIndex index(false);
+index.set_cache("/var/cache/herdstat/metadata_index");
+index.fill();
+
+const herdstat::portage::MetadataIndex::ids_type& ids(
+    index.herd_packages("netmon"));
+herdstat::portage::MetadataIndex::ids_type::const_iterator i;
+for (i = ids.begin() ; i != ids.end() ; ++i)
+    std::cout << index[*i].pkg << std::endl;
+@endcode
+     */
+
+    class MetadataIndex : public util::VectorBase<MetadataIndexEntry>,
+                          private Noncopyable
+    {
+        public:
+            /// Package IDs (positions in the index).
+            typedef std::vector<size_type> ids_type;
+
+            /// Cache format version.
+            static const unsigned int cache_version;
+
+            /** Default constructor.  Uses PORTDIR and overlays from
+             * GlobalConfig().
+             * @param fill Fill the index? (defaults to true).
+             */
+            MetadataIndex(bool fill = true);
+
+            /** Constructor.
+             * @param portdir PORTDIR to search.
+             * @param overlays Overlays to search (defaults to empty).
+             * @param fill Fill the index? (defaults to true).
+             */
+            MetadataIndex(const std::string& portdir,
+                          const std::vector<std::string>& overlays =
+                                std::vector<std::string>(),
+                          bool fill = true);
+
+            /// Destructor.
+            ~MetadataIndex() throw();
+
+            /** Fill the index, loading/updating the cache if one is set.
+             * @param jobs Number of worker threads (defaults to 0, meaning
+             * one per online processor).
+             * @exception ErrnoException if no worker could be started,
+             * Exception if one failed.
+             */
+            void fill(unsigned int jobs = 0) throw (Exception);
+            /// Has the index been fill()'d?
+            bool filled() const { return _filled; }
+
+            ///@{
+            /** Find the entry for the specified package.
+             * @param pkg Package ("cat/pkg") or category name.
+             * @returns iterator to the entry or end() if not found.
+             */
+            iterator find(const std::string& pkg);
+            const_iterator find(const std::string& pkg) const;
+            ///@}
+
+            ///@{
+            /** Get IDs of packages maintained by the specified herd.
+             * @param herd Herd name.
+             * @returns const reference to a sorted vector of IDs (empty if
+             * the herd maintains nothing).
+             */
+            const ids_type& herd_packages(const std::string& herd) const;
+            /** Get IDs of packages maintained by the specified developer.
+             * @param email Developer's email address (case-insensitive).
+             * @returns const reference to a sorted vector of IDs (empty if
+             * the developer maintains nothing).
+             */
+            const ids_type& dev_packages(const std::string& email) const;
+            /** Get IDs of packages maintained by the specified Gentoo
+             * developer (user@gentoo.org).
+             * @param user Developer user name.
+             * @returns const reference to a sorted vector of IDs (empty if
+             * the developer maintains nothing).
+             */
+            const ids_type& user_packages(const std::string& user) const;
+            ///@}
+
+            /** Set path of cache file (defaults to none).
+             * @param path Path.
+             */
+            void set_cache(const std::string& path) { _cache.assign(path); }
+            /// Get path of cache file.
+            const std::string& cache() const { return _cache; }
+
+            /// Get paths of metadata.xml's that failed to parse.
+            const std::vector<std::string>& failed() const { return _failed; }
+            /// Get number of metadata.xml's actually parsed by fill().
+            size_type parsed() const { return _pending.size(); }
+
+            /// Get portdir used when filling the index.
+            const std::string& portdir() const { return _portdir; }
+            /// Get overlays used when filling the index.
+            const std::vector<std::string>& overlays() const
+            { return _overlays; }
+
+        private:
+            class Worker;
+            friend class Worker;
+
+            /// Number of entries handed to a worker at a time.
+            static const size_type chunk_size;
+
+            typedef std::map<std::string, ids_type> reverse_type;
+
+            /// Find all metadata.xml's, initializing an entry for each.
+            void discover();
+            /** Copy herds/devs of unchanged entries from the cache and
+             * queue the rest for parsing.
+             * @returns true if the cache needs to be re-written.
+             */
+            bool merge_cache();
+            /** Load the cache.
+             * @returns false if it doesn't exist or is unusable.
+             */
+            bool load_cache(container_type& entries) const;
+            /// Write the cache.
+            void dump_cache() const throw (FileException);
+            /// Build the herd/developer -> packages tables.
+            void build_reverse();
+            /** Get the next chunk of entries to parse.
+             * @returns false if there's nothing left.
+             */
+            bool next_chunk(size_type *begin, size_type *end);
+            /// Record a metadata.xml that failed to parse.
+            void add_failed(const std::string& path);
+
+            const std::string _portdir;
+            const std::vector<std::string> _overlays;
+            bool _filled;
+            std::string _cache;
+            std::vector<std::string> _failed;
+            reverse_type _herds;
+            reverse_type _devs;
+
+            /// Indices of entries that need to be parsed.
+            ids_type _pending;
+            util::Mutex _mutex;
+            size_type _next;
+    };
+
+} // namespace portage
+} // namespace herdstat
+
+#endif /* _HAVE_METADATA_INDEX_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
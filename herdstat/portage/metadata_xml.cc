@@ -37,7 +37,7 @@ namespace portage {
 MetadataXML::MetadataXML() throw()
     : Parsable(), _data(), in_herd(false), in_maintainer(false),
       in_email(false), in_name(false), in_desc(false), in_longdesc(false),
-      in_en_longdesc(false), _cur_dev(), _longdesc()
+      in_en_longdesc(false), _cur_dev(), _longdesc(), _text()
 {
 }
 /****************************************************************************/
@@ -45,7 +45,7 @@ MetadataXML::MetadataXML(const std::string& path, const std::string& pkg)
     throw (FileException, xml::ParserException)
     : Parsable(path), _data(pkg), in_herd(false), in_maintainer(false),
       in_email(false), in_name(false), in_desc(false), in_longdesc(false),
-      in_en_longdesc(false), _cur_dev(), _longdesc()
+      in_en_longdesc(false), _cur_dev(), _longdesc(), _text()
 {
     this->parse();
 }
@@ -63,106 +63,152 @@ MetadataXML::do_parse(const std::string& path)
     BacktraceContext c("portage::MetadataXML::parse("+this->path()+")");
 
     if (not util::file_exists(this->path())) throw FileException(this->path());
-    this->parse_file(this->path().c_str());
+    this->parse_file(this->path());
 
     if (_data.longdesc().empty() and not _longdesc.empty())
         _data.set_longdesc(_longdesc);
 }
 /****************************************************************************/
+const xml::ElementTable&
+MetadataXML::elements() const
+{
+    static const xml::ElementTableEntry entries[] = {
+        { "catmetadata",        CATMETADATA },
+        { "herd",               HERD },
+        { "maintainer",         MAINTAINER },
+        { "email",              EMAIL },
+        { "name",               NAME },
+        { "description",        DESCRIPTION },
+        { "longdescription",    LONGDESCRIPTION }
+    };
+    static const xml::ElementTable table(entries,
+        sizeof(entries) / sizeof(entries[0]));
+    return table;
+}
+/****************************************************************************/
 bool
-MetadataXML::start_element(const std::string& name, const attrs_type& attrs)
+MetadataXML::start_element(xml::element_id id, const attrs_type& attrs)
 {
     if (meter())
         ++*meter();
 
-    if (name == "catmetadata")
-        _data.set_category(true);
-    else if (name == "herd")
-        in_herd = true;
-    else if (name == "maintainer")
-        in_maintainer = true;
-    else if (name == "email" and in_maintainer)
-        in_email = true;
-    else if (name == "name" and in_maintainer)
-        in_name = true;
-    else if (name == "description")
-        in_desc = true;
-    else if (name == "longdescription")
+    switch (id)
     {
-        attrs_type::const_iterator i = attrs.find("lang");
-        if (i != attrs.end())
+        case CATMETADATA:
+            _data.set_category(true);
+            break;
+        case HERD:
+            in_herd = true;
+            _text.clear();
+            break;
+        case MAINTAINER:
+            in_maintainer = true;
+            _cur_dev = Developer();
+            break;
+        case EMAIL:
+            if (in_maintainer) in_email = true;
+            _text.clear();
+            break;
+        case NAME:
+            if (in_maintainer) in_name = true;
+            _text.clear();
+            break;
+        case DESCRIPTION:
+            if (in_maintainer) in_desc = true;
+            _text.clear();
+            break;
+        case LONGDESCRIPTION:
         {
-            if (i->second.empty() or (i->second == "en"))
+            _text.clear();
+
+            attrs_type::const_iterator i = attrs.find("lang");
+            if (i != attrs.end())
             {
-                in_en_longdesc = true;
-                return true;
+                if (i->second.empty() or (i->second == "en"))
+                    in_en_longdesc = true;
+                else if (i->second == std::locale("").name().substr(0, 2))
+                    in_longdesc = true;
             }
-        
-            if (i->second == std::locale("").name().substr(0, 2))
-                in_longdesc = true;
+            else
+                in_en_longdesc = true;
+            break;
         }
-        else
-            in_en_longdesc = true;
     }
 
     return true;
 }
 /****************************************************************************/
 bool
-MetadataXML::end_element(const std::string& name)
+MetadataXML::end_element(xml::element_id id)
 {
     if (meter())
         ++*meter();
 
-    if (name == "herd")
-        in_herd = false;
-    else if (name == "maintainer")
-        in_maintainer = false;
-    else if (name == "email" and in_maintainer)
-        in_email = false;
-    else if (name == "name" and in_maintainer)
-        in_name = false;
-    else if (name == "description")
-        in_desc = false;
-    else if (name == "longdescription" and in_en_longdesc)
-        in_en_longdesc = false;
-    else if (name == "longdescription")
-        in_longdesc = false;
+    switch (id)
+    {
+        case HERD:
+            in_herd = false;
+            if (not _text.empty())
+                _data.herds().insert(Herd(_text));
+            break;
+        case MAINTAINER:
+            in_maintainer = false;
+            if (not _cur_dev.user().empty())
+                _data.devs().insert(_cur_dev);
+            break;
+        case EMAIL:
+        {
+            if (not in_email)
+                break;
+            in_email = false;
+
+            /* only insert it if it's not a herd */
+            const std::string user(_text.substr(0, _text.find('@')));
+            if (_data.herds().find(user) == _data.herds().end())
+            {
+                const std::string email(util::lowercase(_text));
+                _cur_dev.set_user(email.substr(0, email.find('@')));
+                _cur_dev.set_email(email);
+            }
+            else
+                _cur_dev.set_user("");
+            break;
+        }
+        case NAME:
+            if (not in_name)
+                break;
+            in_name = false;
+            _cur_dev.set_name(_text);
+            break;
+        case DESCRIPTION:
+            if (not in_desc)
+                break;
+            in_desc = false;
+            _cur_dev.set_role(_text);
+            break;
+        case LONGDESCRIPTION:
+            if (in_en_longdesc) in_en_longdesc = false;
+            else if (in_longdesc)
+            {
+                in_longdesc = false;
+                _data.set_longdesc(_data.longdesc() + _text);
+            }
+            break;
+    }
 
     return true;
 }
 /****************************************************************************/
 bool
-MetadataXML::do_text(const std::string& text)
+MetadataXML::do_text(const util::StringView& text)
 {
     if (meter())
         ++*meter();
 
-    if (in_herd)
-        _data.herds().insert(Herd(text));
-    else if (in_email)
-    {
-        /* only insert it if it's not a herd */
-        if (_data.herds().find(text.substr(0, text.find('@'))) ==
-                _data.herds().end())
-            _cur_dev = _data.devs().insert(Developer(util::lowercase(text))).first;
-        else
-            _cur_dev = _data.devs().end();
-    }
-    else if (in_name)
-    {
-        if (_cur_dev != _data.devs().end())
-            const_cast<Developer&>(*_cur_dev).set_name(_cur_dev->name() + text);
-    }
-    else if (in_desc)
-    {
-        if (_cur_dev != _data.devs().end())
-            const_cast<Developer&>(*_cur_dev).set_role(text);
-    }
-    else if (in_en_longdesc)
-        _longdesc += text;
-    else if (in_longdesc)
-        _data.set_longdesc(_data.longdesc() + text);
+    if (in_en_longdesc)
+        text.append_to(_longdesc);
+    else if (in_herd or in_email or in_name or in_desc or in_longdesc)
+        text.append_to(_text);
 
     return true;
 }
@@ -92,12 +92,17 @@ namespace portage {
             virtual void do_parse(const std::string& path = "")
                 throw (FileException, xml::ParserException);
 
-            virtual bool start_element(const std::string& name,
+            virtual const xml::ElementTable& elements() const;
+            virtual bool start_element(xml::element_id id,
                                        const attrs_type& attrs);
-            virtual bool end_element(const std::string& name);
-            virtual bool do_text(const std::string& text);
+            virtual bool end_element(xml::element_id id);
+            virtual bool do_text(const util::StringView& text);
 
         private:
+            /// metadata.xml elements.
+            enum { CATMETADATA = 1, HERD, MAINTAINER, EMAIL, NAME, DESCRIPTION,
+                   LONGDESCRIPTION };
+
             Metadata _data;
 
             bool in_herd,
@@ -108,8 +113,11 @@ namespace portage {
                  in_longdesc,
                  in_en_longdesc;
 
-            Developers::iterator _cur_dev;
+            /// maintainer being parsed (inserted at </maintainer>).
+            Developer _cur_dev;
             std::string _longdesc;
+            /// text of the current element.
+            std::string _text;
     };
 
     inline const Metadata& MetadataXML::data() const { return _data; }
@@ -0,0 +1,88 @@
+/*
+ * libherdstat -- herdstat/portage/project_cache.cc
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <herdstat/portage/project_cache.hh>
+
+namespace herdstat {
+namespace portage {
+/****************************************************************************/
+ProjectCache::ProjectCache() throw()
+    : _mutex(), _entries()
+{
+}
+/****************************************************************************/
+ProjectCache::~ProjectCache() throw()
+{
+}
+/****************************************************************************/
+bool
+ProjectCache::lookup(const std::string& path, const util::Stat& st,
+                     ProjectXML::members_type& members) const
+{
+    util::MutexLock lock(_mutex);
+
+    const entries_type::const_iterator i = _entries.find(path);
+    if (i == _entries.end() or not st.exists() or
+        i->second.mtime != st.mtime() or i->second.size != st.size())
+        return false;
+
+    members = i->second.members;
+    return true;
+}
+/****************************************************************************/
+void
+ProjectCache::insert(const std::string& path, const util::Stat& st,
+                     const ProjectXML::members_type& members)
+{
+    if (not st.exists())
+        return;
+
+    util::MutexLock lock(_mutex);
+
+    Entry& entry(_entries[path]);
+    entry.mtime = st.mtime();
+    entry.size = st.size();
+    entry.members = members;
+}
+/****************************************************************************/
+void
+ProjectCache::clear()
+{
+    util::MutexLock lock(_mutex);
+    _entries.clear();
+}
+/****************************************************************************/
+std::size_t
+ProjectCache::size() const
+{
+    util::MutexLock lock(_mutex);
+    return _entries.size();
+}
+/****************************************************************************/
+} // namespace portage
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,132 @@
+/*
+ * libherdstat -- herdstat/portage/project_cache.hh
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_PROJECT_CACHE_HH
+#define _HAVE_PROJECT_CACHE_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/portage/project_cache.hh
+ * @brief Defines the ProjectCache class.
+ */
+
+#include <map>
+#include <string>
+#include <ctime>
+
+#include <herdstat/noncopyable.hh>
+#include <herdstat/util/file.hh>
+#include <herdstat/util/thread.hh>
+#include <herdstat/portage/project_xml.hh>
+
+namespace herdstat {
+namespace portage {
+
+    /**
+     * @class ProjectCache project_cache.hh herdstat/portage/project_cache.hh
+     * @brief Process-wide cache of parsed projectxml files.
+     *
+     * @section overview Overview
+     *
+     * ProjectXML stores the members (developers and inherited subprojects)
+     * of every file it parses here, keyed by path.  Any later ProjectXML
+     * for the same path gets the cached members instead of parsing the
+     * file again, unless its mtime or size has changed since it was cached.
+     *
+     * @section usage Usage
+     *
+     * Like EclassCache, ProjectCache is a singleton that can only be
+     * accessed via GlobalProjectCache().  All public members are
+     * thread-safe.  Files aren't parsed with the cache locked, so several
+     * threads may parse (different) projects at the same time.
+     */
+
+    class ProjectCache : private Noncopyable
+    {
+        public:
+            /** Look up a cached projectxml file.
+             * @param path Path to projectxml file.
+             * @param st util::Stat object for @a path.
+             * @param members Reference to members; assigned the cached
+             * members if found.
+             * @returns True if @a path is cached and up-to-date.
+             */
+            bool lookup(const std::string& path, const util::Stat& st,
+                        ProjectXML::members_type& members) const;
+
+            /** Cache a parsed projectxml file.
+             * @param path Path to projectxml file.
+             * @param st util::Stat object for @a path, taken before it was
+             * parsed.
+             * @param members Parsed members.
+             */
+            void insert(const std::string& path, const util::Stat& st,
+                        const ProjectXML::members_type& members);
+
+            /// Remove all cached projects.
+            void clear();
+
+            /// Get number of cached projects.
+            std::size_t size() const;
+
+        private:
+            friend ProjectCache& GlobalProjectCache();
+
+            struct Entry
+            {
+                std::time_t mtime;
+                util::Stat::size_type size;
+                ProjectXML::members_type members;
+            };
+
+            typedef std::map<std::string, Entry> entries_type;
+
+            /// Only GlobalProjectCache() can instantiate this class.
+            ProjectCache() throw();
+            /// Destructor.
+            ~ProjectCache() throw();
+
+            mutable util::Mutex _mutex;
+            entries_type _entries;
+    };
+
+    /**
+     * Sole access point to the ProjectCache class.
+     * @returns reference to a local static instance of portage::ProjectCache.
+     */
+
+    inline ProjectCache&
+    GlobalProjectCache()
+    {
+        static ProjectCache c;
+        return c;
+    }
+
+} // namespace portage
+} // namespace herdstat
+
+#endif /* _HAVE_PROJECT_CACHE_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,250 @@
+/*
+ * libherdstat -- herdstat/portage/project_resolver.cc
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <iostream>
+
+#include <herdstat/portage/project_resolver.hh>
+
+namespace herdstat {
+namespace portage {
+/*** static members *********************************************************/
+const unsigned int ProjectResolver::default_jobs = 8;
+/****************************************************************************
+ * Fetches and parses queued projects, queueing any subprojects they inherit
+ * members from, until the queue is empty and no other worker is busy (and
+ * thus able to queue more).
+ ****************************************************************************/
+class ProjectResolver::Worker : public util::Thread
+{
+    public:
+        Worker(ProjectResolver& resolver)
+            : util::Thread(), _resolver(resolver) { }
+
+    protected:
+        virtual void run();
+
+    private:
+        ProjectResolver& _resolver;
+};
+/****************************************************************************/
+void
+ProjectResolver::Worker::run()
+{
+    ProjectResolver& r(_resolver);
+
+    for (;;)
+    {
+        std::string ref;
+
+        {
+            util::MutexLock lock(r._mutex);
+
+            while (r._queue.empty() and r._busy > 0)
+                r._cond.wait(r._mutex);
+
+            if (r._queue.empty())
+                return;
+
+            ref = r._queue.back();
+            r._queue.pop_back();
+            ++r._busy;
+        }
+
+        Node node;
+
+        try
+        {
+            /* FastSAXParser is the only backend that is safe to run
+             * concurrently */
+            const ProjectXML project(ref, r._cvsdir, r._force_fetch, false,
+                                     "fast");
+            node.members = project.members();
+        }
+        catch (const FileException& e)
+        {
+            node.error.assign(e.what());
+        }
+        catch (const xml::ParserException& e)
+        {
+            node.error.assign(e.file()+": "+e.error());
+        }
+        catch (const std::exception& e)
+        {
+            node.error.assign(e.what());
+        }
+
+        {
+            util::MutexLock lock(r._mutex);
+
+            Node& n(r._nodes[ref]);
+            n.members.swap(node.members);
+            n.error.swap(node.error);
+
+            ProjectXML::members_type::const_iterator i;
+            for (i = n.members.begin() ; i != n.members.end() ; ++i)
+            {
+                if (i->subproject.empty())
+                    continue;
+
+                if (r._nodes.insert(std::make_pair(i->subproject,
+                                                   Node())).second)
+                {
+                    r._queue.push_back(i->subproject);
+                    r._cond.signal();
+                }
+            }
+
+            /* wake everybody up if there's nothing left to do */
+            if (--r._busy == 0 and r._queue.empty())
+                r._cond.broadcast();
+        }
+    }
+}
+/****************************************************************************/
+ProjectResolver::ProjectResolver(const std::string& cvsdir, bool force_fetch)
+    : _cvsdir(cvsdir), _force_fetch(force_fetch), _nodes(),
+      _mutex(), _cond(), _queue(), _busy(0)
+{
+}
+/****************************************************************************/
+ProjectResolver::~ProjectResolver() throw()
+{
+}
+/****************************************************************************/
+void
+ProjectResolver::add(const std::string& ref)
+{
+    if (_nodes.insert(std::make_pair(ref, Node())).second)
+        _queue.push_back(ref);
+}
+/****************************************************************************/
+void
+ProjectResolver::resolve(unsigned int jobs) throw (ErrnoException)
+{
+    BacktraceContext c("portage::ProjectResolver::resolve()");
+
+    if (_queue.empty())
+        return;
+
+    if (jobs == 0)
+        jobs = default_jobs;
+
+    std::vector<Worker *> workers;
+    workers.reserve(jobs);
+
+    try
+    {
+        for (unsigned int i = 0 ; i < jobs ; ++i)
+        {
+            workers.push_back(new Worker(*this));
+            workers.back()->start();
+        }
+    }
+    catch (const ErrnoException&)
+    {
+        /* only fatal if we couldn't start a single thread */
+        if (not workers.back()->running())
+        {
+            delete workers.back();
+            workers.pop_back();
+        }
+
+        if (workers.empty())
+            throw;
+    }
+
+    std::vector<Worker *>::iterator i;
+    for (i = workers.begin() ; i != workers.end() ; ++i)
+    {
+        try
+        {
+            (*i)->join();
+        }
+        catch (const Exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+        }
+
+        delete *i;
+    }
+
+    nodes_type::iterator n;
+    for (n = _nodes.begin() ; n != _nodes.end() ; ++n)
+    {
+        if (not n->second.error.empty() and not n->second.reported)
+        {
+            std::cerr << n->second.error << std::endl;
+            n->second.reported = true;
+        }
+    }
+}
+/****************************************************************************/
+void
+ProjectResolver::merge(const std::string& ref, Herd& devs) const
+{
+    const nodes_type::const_iterator n = _nodes.find(ref);
+    if (n == _nodes.end())
+        return;
+
+    std::set<std::string> merging;
+    merging.insert(ref);
+    this->do_merge(n->second.members, devs, merging);
+}
+/****************************************************************************/
+void
+ProjectResolver::merge(const ProjectXML::members_type& members,
+                       Herd& devs) const
+{
+    std::set<std::string> merging;
+    this->do_merge(members, devs, merging);
+}
+/****************************************************************************/
+void
+ProjectResolver::do_merge(const ProjectXML::members_type& members,
+                          Herd& devs, std::set<std::string>& merging) const
+{
+    ProjectXML::members_type::const_iterator i;
+    for (i = members.begin() ; i != members.end() ; ++i)
+    {
+        if (i->subproject.empty())
+        {
+            ProjectXML::merge(i->dev, devs);
+            continue;
+        }
+
+        const nodes_type::const_iterator n = _nodes.find(i->subproject);
+        if (n == _nodes.end() or not merging.insert(n->first).second)
+            continue;
+
+        this->do_merge(n->second.members, devs, merging);
+        merging.erase(n->first);
+    }
+}
+/****************************************************************************/
+} // namespace portage
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,155 @@
+/*
+ * libherdstat -- herdstat/portage/project_resolver.hh
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_PROJECT_RESOLVER_HH
+#define _HAVE_PROJECT_RESOLVER_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/portage/project_resolver.hh
+ * @brief Defines the ProjectResolver class.
+ */
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <herdstat/exceptions.hh>
+#include <herdstat/noncopyable.hh>
+#include <herdstat/util/thread.hh>
+#include <herdstat/portage/project_xml.hh>
+
+namespace herdstat {
+namespace portage {
+
+    /**
+     * @class ProjectResolver project_resolver.hh herdstat/portage/project_resolver.hh
+     * @brief Concurrently fetches and parses a set of projectxml files and
+     * the subprojects they inherit members from.
+     *
+     * @section overview Overview
+     *
+     * Projects are add()'ed by reference (as used in herds.xml's
+     * <maintainingproject> and projectxml's <subproject ref="...">).
+     * resolve() then fetches and parses every added project, and every
+     * project they (indirectly) inherit members from, on a pool of worker
+     * threads.  Each project is fetched and parsed only once, no matter how
+     * many times it is referenced.  Workers always parse with the "fast"
+     * xml::SAXParser backend, since xmlwrapp isn't safe to run
+     * concurrently.
+     *
+     * merge() flattens the resulting graph: the developers of a project and
+     * of its inherited subprojects are merged (in document order) using
+     * ProjectXML::merge(), which gives the same role precedence as parsing
+     * the projects one after the other.  Cycles are broken by skipping any
+     * project that is already being merged.
+     *
+     * Projects that fail to be fetched or parsed are reported on stderr
+     * and treated as having no members.  So are worker threads that fail
+     * (see util::Thread::join()).
+     */
+
+    class ProjectResolver : private Noncopyable
+    {
+        public:
+            /// Default number of worker threads.
+            static const unsigned int default_jobs;
+
+            /** Constructor.
+             * @param cvsdir Path to Gentoo cvs checkout directory (see
+             * ProjectXML).
+             * @param force_fetch Whether or not to force fetching.
+             */
+            ProjectResolver(const std::string& cvsdir, bool force_fetch);
+
+            /// Destructor.
+            ~ProjectResolver() throw();
+
+            /** Add a project.
+             * @param ref Project reference.
+             */
+            void add(const std::string& ref);
+
+            /** Fetch and parse all added projects (and their inherited
+             * subprojects) that haven't been already.
+             * @param jobs Number of worker threads (defaults to 0, meaning
+             * default_jobs).
+             * @exception ErrnoException
+             */
+            void resolve(unsigned int jobs = 0) throw (ErrnoException);
+
+            /** Merge developers of a resolved project into @a devs.
+             * @param ref Project reference.
+             * @param devs reference to a Herd.
+             */
+            void merge(const std::string& ref, Herd& devs) const;
+
+            /** Merge members (as returned by ProjectXML::members()) into
+             * @a devs, resolving subprojects.
+             * @param members const reference to members.
+             * @param devs reference to a Herd.
+             */
+            void merge(const ProjectXML::members_type& members,
+                       Herd& devs) const;
+
+        private:
+            class Worker;
+            friend class Worker;
+
+            struct Node
+            {
+                ProjectXML::members_type members;
+                /// Error message, if it couldn't be fetched/parsed.
+                std::string error;
+                /// Has the error been reported?
+                bool reported;
+
+                Node() : members(), error(), reported(false) { }
+            };
+
+            typedef std::map<std::string, Node> nodes_type;
+
+            void do_merge(const ProjectXML::members_type& members, Herd& devs,
+                          std::set<std::string>& merging) const;
+
+            const std::string _cvsdir;
+            const bool _force_fetch;
+            nodes_type _nodes;
+
+            util::Mutex _mutex;
+            util::Condition _cond;
+            /// References waiting to be fetched/parsed.
+            std::vector<std::string> _queue;
+            /// Number of workers currently fetching/parsing.
+            unsigned int _busy;
+    };
+
+} // namespace portage
+} // namespace herdstat
+
+#endif /* _HAVE_PROJECT_RESOLVER_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -25,9 +25,12 @@
 #endif
 
 #include <iostream>
+#include <memory>
 #include <herdstat/util/string.hh>
 #include <herdstat/util/file.hh>
 #include <herdstat/portage/project_xml.hh>
+#include <herdstat/portage/project_resolver.hh>
+#include <herdstat/portage/project_cache.hh>
 
 #define EXPIRE  169200
 
@@ -36,14 +39,96 @@ namespace portage {
 /*** static members *********************************************************/
 const char * const ProjectXML::_baseURL = "http://www.gentoo.org/cgi-bin/viewcvs.cgi/*checkout*/xml/htdocs%s?rev=HEAD&root=gentoo&content-type=text/plain";
 const char * const ProjectXML::_baseLocal = "%s/gentoo/xml/htdocs/%s";
-std::set<std::string> ProjectXML::_parsed;
+/****************************************************************************
+ * Feeds the document to the SAX callbacks as it is being fetched, so that
+ * it doesn't have to be read back from disk afterwards.  A document that
+ * doesn't parse is rejected, which keeps the previously fetched copy.
+ ****************************************************************************/
+class ProjectXML::Stream : public FetchSink
+{
+    public:
+        explicit Stream(ProjectXML& xml)
+            : _xml(xml), _parser(), _stopped(false), _size(0),
+              _complete(false) { }
+
+        virtual void begin()
+        {
+            /* a retry starts the document over */
+            _parser.reset();
+            _stopped = false;
+            _size = 0;
+            _complete = false;
+            _xml._devs.clear();
+            _xml._members.clear();
+            _xml.in_sub = _xml.in_dev = _xml.in_task = false;
+            _xml._text.clear();
+        }
+
+        virtual bool write(const char *data, std::size_t len)
+        {
+            try
+            {
+                if (not _parser.get())
+                {
+                    _parser.reset(xml::SAXParser::create(&_xml,
+                                                         _xml._backend));
+                    _parser->set_document(_xml.path());
+                }
+
+                _size += len;
+                if (not _stopped)
+                    _stopped = not _parser->parse_chunk(data, len);
+                return true;
+            }
+            catch (const xml::ParserException&)
+            {
+                return false;
+            }
+        }
+
+        virtual bool finish()
+        {
+            /* an empty document is as good as a failed fetch */
+            if (_size == 0)
+                return false;
+
+            try
+            {
+                if (not _stopped)
+                    _parser->parse_finish();
+            }
+            catch (const xml::ParserException&)
+            {
+                return false;
+            }
+
+            return (_complete = true);
+        }
+
+        /// Record the outcome of the fetch.
+        void fetched(bool ok) { _complete = (_complete and ok); }
+
+        /// Was the document fetched and parsed?
+        bool complete() const { return _complete; }
+
+    private:
+        ProjectXML& _xml;
+        std::auto_ptr<xml::SAXParser> _parser;
+        bool _stopped;
+        std::size_t _size;
+        bool _complete;
+};
 /****************************************************************************/
 ProjectXML::ProjectXML(const std::string& path, const std::string& cvsdir,
-                         bool force_fetch)
+                         bool force_fetch, bool inherit,
+                         const std::string& backend)
     throw (FileException, xml::ParserException)
-    : _devs(), _cvsdir(cvsdir), _force_fetch(force_fetch),
-      in_sub(false), in_dev(false), in_task(false), _cur_role()
+    : _devs(), _members(), _cvsdir(cvsdir), _force_fetch(force_fetch),
+      _backend(backend), in_sub(false), in_dev(false), in_task(false),
+      _cur_role(), _text(), _stream(NULL)
 {
+    Stream stream(*this);
+
     if (_cvsdir.empty())
     {
         std::vector<std::string> parts;
@@ -51,6 +136,8 @@ ProjectXML::ProjectXML(const std::string& path, const std::string& cvsdir,
         assert(parts.size() > 1);
         this->set_path(util::sprintf("%s/%s.xml", LOCALSTATEDIR,
             (*(parts.end() - 2)).c_str()));
+
+        _stream = &stream;
         this->fetch(path);
     }
     else
@@ -60,10 +147,28 @@ ProjectXML::ProjectXML(const std::string& path, const std::string& cvsdir,
     }
 
     this->parse();
+    _stream = NULL;
+
+    if (not inherit)
+        return;
+
+    ProjectResolver resolver(_cvsdir, _force_fetch);
+    members_type::const_iterator i;
+    for (i = _members.begin() ; i != _members.end() ; ++i)
+    {
+        if (not i->subproject.empty())
+            resolver.add(i->subproject);
+    }
+
+    resolver.resolve();
+
+    _devs.clear();
+    resolver.merge(_members, _devs);
 }
 /****************************************************************************/
 ProjectXML::~ProjectXML() throw()
 {
+    this->wait_fetch();
 }
 /****************************************************************************/
 void
@@ -76,39 +181,22 @@ ProjectXML::do_fetch(const std::string& p) const throw (FetchException)
 
     assert(not p.empty());
     const std::string url(util::sprintf(_baseURL, p.c_str()));
-    util::Stat mps(this->path());
+    const util::Stat mps(this->path());
 
-    try
-    {
-        if (not mps.exists() or (mps.size() == 0) or
-            (mps.exists() and ((std::time(NULL) - mps.mtime()) > EXPIRE)) or
-            _force_fetch)
-        {
-            if (mps.exists())
-                util::copy_file(this->path(), this->path()+".bak");
+    if (mps.exists() and (mps.size() > 0) and
+        ((std::time(NULL) - mps.mtime()) <= EXPIRE) and not _force_fetch)
+        return;
 
-            const Fetcher& fetcher(this->fetcher());
-            fetcher(url, this->path());
+    /* path is only replaced if the fetch succeeds (and, when streaming,
+     * the new document parses), so there's no need for a backup */
+    FetchRequest req(url, this->path());
+    req.sink = _stream;
+    this->fetcher()(req);
 
-            if (not mps() or (mps.size() == 0))
-                throw FetchException();
+    if (_stream)
+        _stream->fetched(req.ok and req.modified);
 
-            unlink((this->path()+".bak").c_str());
-        }
-    }
-    catch (const FetchException)
-    {
-        if (util::is_file(this->path()+".bak"))
-            util::move_file(this->path()+".bak", this->path());
-
-        if (not mps() or (mps.size() == 0))
-        {
-            unlink(this->path().c_str());
-            return;
-        }
-    }
-
-    if (not mps())
+    if (not req.ok and not util::is_file(this->path()))
         std::cerr << "Failed to save '" << url << "' to" << std::endl
             << "'" << this->path() << "'." << std::endl;
 }
@@ -124,93 +212,152 @@ ProjectXML::do_parse(const std::string& path)
     if (not util::is_file(this->path()))
         throw FileException(this->path());
 
-    /* if inserting into the set fails, we've already parsed it.
-     * this prevents recursively instantiating this class unneededly. */
-    if (not _parsed.insert(this->path()).second)
+    ProjectCache& cache(GlobalProjectCache());
+    const util::Stat st(this->path());
+
+    /* already parsed while fetching */
+    if (_stream and _stream->complete())
+    {
+        cache.insert(this->path(), st, _members);
         return;
+    }
+
+    _devs.clear();
+    _members.clear();
 
-    this->parse_file(this->path().c_str());
+    if (cache.lookup(this->path(), st, _members))
+    {
+        members_type::const_iterator i;
+        for (i = _members.begin() ; i != _members.end() ; ++i)
+        {
+            if (i->subproject.empty())
+                merge(i->dev, _devs);
+        }
+    }
+    else
+    {
+        this->parse_file(this->path(), _backend);
+        cache.insert(this->path(), st, _members);
+    }
+}
+/****************************************************************************/
+void
+ProjectXML::merge(const Developer& dev, Herd& devs)
+{
+    Herd::iterator i = devs.find(dev);
+    if (i == devs.end())
+        devs.insert(dev);
+    /* otherwise, set it's role if unset */
+    else if (not dev.role().empty() and i->role().empty())
+    {
+        Developer d(*i);
+        d.set_role(dev.role());
+        devs.erase(i);
+        devs.insert(d);
+    }
+}
+/****************************************************************************/
+const xml::ElementTable&
+ProjectXML::elements() const
+{
+    static const xml::ElementTableEntry entries[] = {
+        { "task",       TASK },
+        { "subproject", SUBPROJECT },
+        { "dev",        DEV }
+    };
+    static const xml::ElementTable table(entries,
+        sizeof(entries) / sizeof(entries[0]));
+    return table;
 }
 /****************************************************************************/
 bool
-ProjectXML::start_element(const std::string& name, const attrs_type& attrs)
+ProjectXML::start_element(xml::element_id id, const attrs_type& attrs)
 {
     if (meter())
         ++*meter();
 
-    if (name == "task")
-        in_task = true;
-    else if (name == "subproject")
+    switch (id)
     {
-        /*
-         * If inheritmembers == "yes", fetch the file listed in the ref attr,
-         * and treat it as another projectxml, recursing into ourselves.
-         */
-
-        attrs_type::const_iterator pos = attrs.find("inheritmembers");
-        if ((pos != attrs.end()) and (pos->second == "yes"))
+        case TASK:
+            in_task = true;
+            break;
+        case SUBPROJECT:
         {
-            if ((pos = attrs.find("ref")) != attrs.end())
-            {
-                in_sub = true;
+            /*
+             * If inheritmembers == "yes", the file listed in the ref attr
+             * is another projectxml whose members we inherit.  It's
+             * resolved once we're done (see ProjectResolver).
+             */
 
-                ProjectXML mp(pos->second, _cvsdir, _force_fetch);
-                mp.set_meter(this->meter());
-                Herd::const_iterator i;
-                for (i = mp.devs().begin() ; i != mp.devs().end() ; ++i)
-                {
-                    /* if dev doesn't exist, insert it */
-                    Herd::iterator d = _devs.find(*i);
-                    if (d == _devs.end())
-                        _devs.insert(*i);
-                    /* otherwise, set it's role if unset */
-                    else if (not i->role().empty() and d->role().empty())
-                        const_cast<Developer&>(*d).set_role(i->role());
-                }
-            }
+            attrs_type::const_iterator pos = attrs.find("inheritmembers");
+            if ((pos == attrs.end()) or (pos->second != "yes") or
+                ((pos = attrs.find("ref")) == attrs.end()))
+                break;
+
+            in_sub = true;
+
+            _members.push_back(Member());
+            _members.back().subproject.assign(pos->second.str());
+            break;
         }
-    }
-    else if (name == "dev" and not in_task)
-    {
-        in_dev = true;
+        case DEV:
+        {
+            if (in_task)
+                break;
+
+            in_dev = true;
+            _cur_role.clear();
+            _text.clear();
 
-        attrs_type::const_iterator pos = attrs.find("description");
-        if (pos != attrs.end())
-            _cur_role.assign(pos->second);
+            attrs_type::const_iterator pos = attrs.find("description");
+            if (pos != attrs.end())
+                _cur_role.assign(pos->second.str());
+            break;
+        }
     }
 
     return true;
 }
 /****************************************************************************/
 bool
-ProjectXML::end_element(const std::string& name)
+ProjectXML::end_element(xml::element_id id)
 {
     if (meter())
         ++*meter();
 
-    if (name == "task")             in_task = false;
-    else if (name == "subproject")  in_sub = false;
-    else if (name == "dev")         in_dev = false;
+    switch (id)
+    {
+        case TASK:          in_task = false; break;
+        case SUBPROJECT:    in_sub = false; break;
+        case DEV:
+        {
+            if (not in_dev)
+                break;
+            in_dev = false;
+            if (_text.empty())
+                break;
+
+            _members.push_back(Member());
+            Developer& dev(_members.back().dev);
+            dev = Developer(util::lowercase(_text));
+            dev.set_role(_cur_role);
+
+            merge(dev, _devs);
+            break;
+        }
+    }
+
     return true;
 }
 /****************************************************************************/
 bool
-ProjectXML::do_text(const std::string& text)
+ProjectXML::do_text(const util::StringView& text)
 {
     if (meter())
         ++*meter();
 
     if (in_dev)
-    {
-        Developer dev(util::lowercase(text));
-        dev.set_role(_cur_role);
-
-        Herd::iterator i = _devs.find(dev);
-        if (i == _devs.end())
-            _devs.insert(dev);
-        else if (not dev.role().empty() and i->role().empty())
-            const_cast<Developer&>(*i).set_role(dev.role());
-    }
+        text.append_to(_text);
 
     return true;
 }
@@ -32,7 +32,8 @@
  * @brief Defines the interface for Gentoo projectxml files.
  */
 
-#include <set>
+#include <string>
+#include <vector>
 #include <herdstat/progressable.hh>
 #include <herdstat/noncopyable.hh>
 #include <herdstat/fetchable.hh>
@@ -53,6 +54,15 @@ namespace portage {
      * portage::HerdsXML class with the exception that the underlying data is
      * stored in a portage::Herd object (accessible via the devs() member).
      *
+     * Subprojects with inheritmembers="yes" are fetched and parsed
+     * concurrently by a portage::ProjectResolver once the document itself
+     * has been parsed.  Pass inherit = false to the constructor to only
+     * parse the document itself; members() then lists the inherited
+     * subprojects so the caller can resolve them.
+     *
+     * Parsed files are cached process-wide (see portage::ProjectCache), so
+     * a file is only parsed again if it has been modified.
+     *
      * @see portage::HerdsXML documentation.
      */
 
@@ -63,6 +73,18 @@ namespace portage {
                        private Noncopyable
     {
         public:
+            /// A <dev> or an inherited <subproject>.
+            struct Member
+            {
+                /// Reference of subproject (empty for a <dev>).
+                std::string subproject;
+                /// Developer (if not a subproject).
+                Developer dev;
+            };
+
+            /// Members in document order.
+            typedef std::vector<Member> members_type;
+
             /** Constructor.
              * @param path Path of projectxml file relative to
              * $cvsdir/gentoo/xml/htdocs.  If cvsdir is empty, we look in
@@ -70,10 +92,15 @@ namespace portage {
              * @param cvsdir Path to Gentoo cvs checkout directory.
              * @param force_fetch Whether or not to force fetching of the
              * projectxml file.
+             * @param inherit Whether or not to resolve inherited subprojects
+             * (defaults to true).
+             * @param backend xml::SAXParser backend (defaults to the default
+             * one).
              * @exception FileException, xml::ParserException
              */
             ProjectXML(const std::string& path,
-                       const std::string& cvsdir, bool force_fetch)
+                       const std::string& cvsdir, bool force_fetch,
+                       bool inherit = true, const std::string& backend = "")
                 throw (FileException, xml::ParserException);
 
             /// Destructor.
@@ -82,6 +109,17 @@ namespace portage {
             /// Get Herd.
             inline const Herd& devs() const;
 
+            /// Get members in document order.
+            inline const members_type& members() const;
+
+            /** Merge a developer into @a devs.  The developer is inserted if
+             * not already present, otherwise its role is used if the
+             * existing developer has none.
+             * @param dev const reference to a Developer.
+             * @param devs reference to a Herd.
+             */
+            static void merge(const Developer& dev, Herd& devs);
+
         protected:
             /** Parse projectxml file.
              * @param path Path to projectxml file (defaults to empty).
@@ -99,26 +137,38 @@ namespace portage {
 
             ///@{
             /// SAX2 Callbacks
-            virtual bool start_element(const std::string& name,
-                                       const attrs_type&  attrs);
-            virtual bool end_element(const std::string& name);
-            virtual bool do_text(const std::string& text);
+            virtual const xml::ElementTable& elements() const;
+            virtual bool start_element(xml::element_id id,
+                                       const attrs_type& attrs);
+            virtual bool end_element(xml::element_id id);
+            virtual bool do_text(const util::StringView& text);
             ///@}
 
         private:
+            class Stream;
+            friend class Stream;
+
+            /// project XML elements.
+            enum { TASK = 1, SUBPROJECT, DEV };
+
             Herd _devs;
+            members_type _members;
             const std::string& _cvsdir;
             const bool _force_fetch;
+            const std::string _backend;
             bool in_sub, in_dev, in_task;
             std::string _cur_role;
+            /// text of the current <dev>.
+            std::string _text;
+            /// parses the document while it's being fetched (if not NULL).
+            Stream *_stream;
             static const char * const _baseURL;
             static const char * const _baseLocal;
-            /* for keeping track of what we've parsed already
-             * to prevent infinite recursion. */
-            static std::set<std::string> _parsed;
     };
 
     inline const Herd& ProjectXML::devs() const { return _devs; }
+    inline const ProjectXML::members_type& ProjectXML::members() const
+    { return _members; }
 
 } // namespace portage
 } // namespace herdstat
@@ -0,0 +1,255 @@
+/*
+ * libherdstat -- herdstat/portage/serialize.cc
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <herdstat/exceptions.hh>
+#include <herdstat/portage/exceptions.hh>
+#include <herdstat/portage/serialize.hh>
+
+namespace herdstat {
+namespace io {
+/****************************************************************************/
+void
+Serializer<portage::Package>::save(BinaryOStream& stream,
+                                   const portage::Package& v)
+{
+    stream << v.portdir() << v.full() << v.category();
+}
+/****************************************************************************/
+void
+Serializer<portage::Package>::load(BinaryIStream& stream, portage::Package& v)
+{
+    std::string portdir, full, category;
+    stream >> portdir >> full >> category;
+    if (not stream)
+        return;
+
+    try
+    {
+        v.set_portdir(portdir);
+        v.set_name(full);
+        v.set_category(category);
+    }
+    catch (const Exception&)
+    {
+        stream.fail();
+    }
+}
+/****************************************************************************/
+/* ${PN}-${PV}, with the leading '-' that VersionComponents gives a
+ * ${PN} containing a '-' taken off again */
+static std::string
+ebuild_name(const std::string& pn, const std::string& pv)
+{
+    if (not pn.empty() and pn[0] == '-')
+        return pn.substr(1) + "-" + pv;
+    return pn + "-" + pv;
+}
+/****************************************************************************/
+void
+Serializer<portage::VersionString>::save(BinaryOStream& stream,
+                                         const portage::VersionString& v)
+{
+    const std::string& ebuild(v.ebuild());
+    const portage::VersionComponents& c(v.components());
+    std::string dir, revision;
+
+    if (not ebuild.empty())
+    {
+        const std::string::size_type pos = ebuild.rfind('/');
+        if (pos != std::string::npos)
+            dir.assign(ebuild, 0, pos + 1);
+
+        /* the revision is only stored if it's in the file name */
+        std::string name(dir + ebuild_name(c["PN"], c["PV"]));
+        if (name + ".ebuild" != ebuild)
+        {
+            revision = c["PR"];
+            name += "-" + revision;
+        }
+
+        if (name + ".ebuild" != ebuild)
+        {
+            stream.fail();
+            return;
+        }
+    }
+
+    stream << dir << c["PN"] << c["PV"] << revision;
+}
+/****************************************************************************/
+void
+Serializer<portage::VersionString>::load(BinaryIStream& stream,
+                                         portage::VersionString& v)
+{
+    std::string dir, pn, pv, revision;
+    stream >> dir >> pn >> pv >> revision;
+    if (not stream)
+        return;
+
+    if (pn.empty())
+    {
+        v = portage::VersionString();
+        return;
+    }
+
+    std::string ebuild(dir + ebuild_name(pn, pv));
+    if (not revision.empty())
+        ebuild += "-" + revision;
+    ebuild += ".ebuild";
+
+    portage::VersionComponents c;
+    c.assign(pn, pv, (revision.empty() ? "r0" : revision));
+    v.assign(ebuild, c);
+}
+/****************************************************************************/
+void
+Serializer<portage::Keywords>::save(BinaryOStream& stream,
+                                    const portage::Keywords& v)
+{
+    std::string keywords;
+
+    portage::Keywords::const_iterator i;
+    for (i = v.begin() ; i != v.end() ; ++i)
+    {
+        if (not keywords.empty())
+            keywords += ' ';
+        if (i->mask())
+            keywords += i->mask();
+        keywords += i->arch();
+    }
+
+    stream << v.path() << keywords;
+}
+/****************************************************************************/
+void
+Serializer<portage::Keywords>::load(BinaryIStream& stream,
+                                    portage::Keywords& v)
+{
+    std::string path, keywords;
+    stream >> path >> keywords;
+    if (not stream)
+        return;
+
+    try
+    {
+        v.assign(path, keywords);
+    }
+    catch (const Exception&)
+    {
+        stream.fail();
+    }
+}
+/****************************************************************************/
+void
+Serializer<portage::Developer>::save(BinaryOStream& stream,
+                                     const portage::Developer& v)
+{
+    stream << v.user() << v.email() << v.name() << v.pgpkey()
+           << v.joined() << v.birthday() << v.status() << v.role()
+           << v.location() << v.awaymsg() << v.is_away();
+    serialize(stream, v.herds());
+}
+/****************************************************************************/
+void
+Serializer<portage::Developer>::load(BinaryIStream& stream,
+                                     portage::Developer& v)
+{
+    std::string user, email, name, pgpkey, joined, birth, status, role,
+                location, awaymsg;
+    std::vector<std::string> herds;
+    bool away = false;
+
+    stream >> user >> email >> name >> pgpkey >> joined >> birth
+           >> status >> role >> location >> awaymsg >> away;
+    deserialize(stream, herds);
+    if (not stream)
+        return;
+
+    v.set_user(user);
+    v.set_email(email);
+    v.set_name(name);
+    v.set_pgpkey(pgpkey);
+    v.set_joined(joined);
+    v.set_birthday(birth);
+    v.set_status(status);
+    v.set_role(role);
+    v.set_location(location);
+    v.set_awaymsg(awaymsg);
+    v.set_away(away);
+    v.set_herds(herds);
+}
+/****************************************************************************/
+void
+Serializer<portage::Herd>::save(BinaryOStream& stream, const portage::Herd& v)
+{
+    stream << v.name() << v.email() << v.desc();
+    Serializer<portage::Developers>::save(stream, v);
+}
+/****************************************************************************/
+void
+Serializer<portage::Herd>::load(BinaryIStream& stream, portage::Herd& v)
+{
+    std::string name, email, desc;
+    stream >> name >> email >> desc;
+    if (not stream)
+        return;
+
+    v.set_name(name);
+    v.set_email(email);
+    v.set_desc(desc);
+    Serializer<portage::Developers>::load(stream, v);
+}
+/****************************************************************************/
+void
+Serializer<portage::Metadata>::save(BinaryOStream& stream,
+                                    const portage::Metadata& v)
+{
+    stream << v.pkg() << v.longdesc() << v.is_category();
+    serialize(stream, v.herds());
+    serialize(stream, v.devs());
+}
+/****************************************************************************/
+void
+Serializer<portage::Metadata>::load(BinaryIStream& stream,
+                                    portage::Metadata& v)
+{
+    std::string pkg, longdesc;
+    bool category = false;
+    stream >> pkg >> longdesc >> category;
+    if (not stream)
+        return;
+
+    v.set_pkg(pkg);
+    v.set_longdesc(longdesc);
+    v.set_category(category);
+    deserialize(stream, v.herds());
+    deserialize(stream, v.devs());
+}
+/****************************************************************************/
+} // namespace io
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
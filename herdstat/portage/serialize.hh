@@ -0,0 +1,145 @@
+/*
+ * libherdstat -- herdstat/portage/serialize.hh
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_PORTAGE_SERIALIZE_HH
+#define _HAVE_PORTAGE_SERIALIZE_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/portage/serialize.hh
+ * @brief Specializes io::Serializer for the core portage types.
+ */
+
+#include <herdstat/io/serialize.hh>
+#include <herdstat/portage/package.hh>
+#include <herdstat/portage/version.hh>
+#include <herdstat/portage/keywords.hh>
+#include <herdstat/portage/developer.hh>
+#include <herdstat/portage/herd.hh>
+#include <herdstat/portage/metadata.hh>
+
+namespace herdstat {
+namespace io {
+
+    /**
+     * @struct Serializer<portage::Package> serialize.hh herdstat/portage/serialize.hh
+     * @brief Serializer for portage::Package (its portdir, full name and
+     * category).
+     */
+
+    template <>
+    struct Serializer<portage::Package>
+    {
+        static void save(BinaryOStream& stream, const portage::Package& v);
+        static void load(BinaryIStream& stream, portage::Package& v);
+    };
+
+    /**
+     * @struct Serializer<portage::VersionString> serialize.hh herdstat/portage/serialize.hh
+     * @brief Serializer for portage::VersionString (the ebuild's directory
+     * and its ${PN}, ${PV} and ${PR}, which the file name is made of again
+     * on loading, without parsing it).  Saving fails if the ebuild isn't
+     * named ${PN}-${PV}[-${PR}].ebuild.
+     */
+
+    template <>
+    struct Serializer<portage::VersionString>
+    {
+        static void save(BinaryOStream& stream,
+                         const portage::VersionString& v);
+        static void load(BinaryIStream& stream, portage::VersionString& v);
+    };
+
+    /**
+     * @struct Serializer<portage::Keywords> serialize.hh herdstat/portage/serialize.hh
+     * @brief Serializer for portage::Keywords (the ebuild path and the
+     * keywords as one string).  Loading doesn't read the ebuild, but fails
+     * on keywords that are no longer valid.
+     */
+
+    template <>
+    struct Serializer<portage::Keywords>
+    {
+        static void save(BinaryOStream& stream, const portage::Keywords& v);
+        static void load(BinaryIStream& stream, portage::Keywords& v);
+    };
+
+    /**
+     * @struct Serializer<portage::Developer> serialize.hh herdstat/portage/serialize.hh
+     * @brief Serializer for portage::Developer (all fields).
+     */
+
+    template <>
+    struct Serializer<portage::Developer>
+    {
+        static void save(BinaryOStream& stream, const portage::Developer& v);
+        static void load(BinaryIStream& stream, portage::Developer& v);
+    };
+
+    /**
+     * @struct Serializer<portage::Herd> serialize.hh herdstat/portage/serialize.hh
+     * @brief Serializer for portage::Herd (its name, email and description,
+     * then its developers).
+     */
+
+    template <>
+    struct Serializer<portage::Herd>
+    {
+        static void save(BinaryOStream& stream, const portage::Herd& v);
+        static void load(BinaryIStream& stream, portage::Herd& v);
+    };
+
+    /**
+     * @struct Serializer<portage::Metadata> serialize.hh herdstat/portage/serialize.hh
+     * @brief Serializer for portage::Metadata (including its herds and
+     * developers).
+     */
+
+    template <>
+    struct Serializer<portage::Metadata>
+    {
+        static void save(BinaryOStream& stream, const portage::Metadata& v);
+        static void load(BinaryIStream& stream, portage::Metadata& v);
+    };
+
+    ///@{
+    /// Serializers for the portage containers (Versions hides
+    /// SetBase::insert(), so is loaded through its base).
+    template <> struct Serializer<portage::Versions>
+        : public SetSerializer<util::SetBase<portage::VersionString> > { };
+    template <> struct Serializer<portage::KeywordsMap>
+        : public MapSerializer<portage::KeywordsMap> { };
+    template <> struct Serializer<portage::Developers>
+        : public SetSerializer<portage::Developers> { };
+    template <> struct Serializer<portage::Herds>
+        : public SetSerializer<portage::Herds> { };
+    ///@}
+
+} // namespace io
+} // namespace herdstat
+
+#endif /* _HAVE_PORTAGE_SERIALIZE_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
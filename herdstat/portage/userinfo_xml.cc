@@ -26,6 +26,7 @@
 
 #include <herdstat/exceptions.hh>
 #include <herdstat/util/file.hh>
+#include <herdstat/portage/serialize.hh>
 #include <herdstat/portage/userinfo_xml.hh>
 
 namespace herdstat {
@@ -37,7 +38,7 @@ UserinfoXML::UserinfoXML() throw()
     : DataSource(), _devs(), in_user(false), in_firstname(false),
       in_familyname(false), in_pgpkey(false), in_email(false), in_joined(false),
       in_birth(false), in_roles(false), in_status(false), in_location(false),
-      _cur_dev()
+      _cur_dev(), _text(), _skip(false)
 {
 }
 /****************************************************************************/
@@ -46,7 +47,7 @@ UserinfoXML::UserinfoXML(const std::string& path)
     : DataSource(path), _devs(), in_user(false),
       in_firstname(false), in_familyname(false), in_pgpkey(false),
       in_email(false), in_joined(false), in_birth(false), in_roles(false),
-      in_status(false), in_location(false), _cur_dev()
+      in_status(false), in_location(false), _cur_dev(), _text(), _skip(false)
 {
     this->parse();
 }
@@ -64,7 +65,30 @@ UserinfoXML::do_parse(const std::string& path)
     BacktraceContext c("portage::UserinfoXML::parse("+this->path()+")");
 
     if (not util::is_file(this->path())) throw FileException(this->path());
-    this->parse_file(this->path().c_str());
+
+    if (not this->load_snapshot())
+    {
+        this->parse_file(this->path());
+        this->save_snapshot();
+    }
+}
+/****************************************************************************/
+bool
+UserinfoXML::do_load_snapshot(io::BinaryIStream& stream)
+{
+    io::deserialize(stream, _devs);
+    if (stream)
+        return true;
+
+    _devs.clear();
+    return false;
+}
+/****************************************************************************/
+bool
+UserinfoXML::do_save_snapshot(io::BinaryOStream& stream) const
+{
+    io::serialize(stream, _devs);
+    return true;
 }
 /****************************************************************************/
 void
@@ -90,92 +114,154 @@ UserinfoXML::fill_developer(Developer& dev) const throw (Exception)
     }
 }
 /****************************************************************************/
+const xml::ElementTable&
+UserinfoXML::elements() const
+{
+    static const xml::ElementTableEntry entries[] = {
+        { "user",       USER },
+        { "firstname",  FIRSTNAME },
+        { "familyname", FAMILYNAME },
+        { "pgpkey",     PGPKEY },
+        { "email",      EMAIL },
+        { "joined",     JOINED },
+        { "birthday",   BIRTHDAY },
+        { "status",     STATUS },
+        { "roles",      ROLES },
+        { "location",   LOCATION }
+    };
+    static const xml::ElementTable table(entries,
+        sizeof(entries) / sizeof(entries[0]));
+    return table;
+}
+/****************************************************************************/
 bool
-UserinfoXML::start_element(const std::string& name, const attrs_type& attrs)
+UserinfoXML::start_element(xml::element_id id, const attrs_type& attrs)
 {
     if (meter())
         ++*meter();
 
-    if (name == "user")
-    {
-        attrs_type::const_iterator pos = attrs.find("username");
-        if (pos == attrs.end())
-            throw Exception("<user> tag with no username attribute!");
-
-        Developer dev(pos->second);
-        dev.set_status("Active");
-        _cur_dev = _devs.insert(dev).first;
-        in_user = true;
-    }
-    else if (name == "firstname")
-        in_firstname = true;
-    else if (name == "familyname")
-        in_familyname = true;
-    else if (name == "pgpkey")
-        in_pgpkey = true;
-    else if (name == "email")
+    /* inside a <user> that doesn't match the query */
+    if (_skip)
+        return true;
+
+    switch (id)
     {
-        /* we only care about gentoo.org email addy's */
-        if (attrs.find("gentoo") != attrs.end())
-            in_email = true;
+        case USER:
+        {
+            attrs_type::const_iterator pos = attrs.find("username");
+            if (pos == attrs.end())
+                throw Exception("<user> tag with no username attribute!");
+
+            if (not this->wanted(pos->second.str()))
+            {
+                _skip = true;
+                break;
+            }
+
+            _cur_dev = Developer(pos->second.str());
+            _cur_dev.set_status("Active");
+            in_user = true;
+            break;
+        }
+        case FIRSTNAME:     in_firstname = true; break;
+        case FAMILYNAME:    in_familyname = true; break;
+        case PGPKEY:        in_pgpkey = true; break;
+        case EMAIL:
+            /* we only care about gentoo.org email addy's */
+            if (attrs.find("gentoo") != attrs.end())
+                in_email = true;
+            break;
+        case JOINED:        in_joined = true; break;
+        case BIRTHDAY:      in_birth = true; break;
+        case STATUS:        in_status = true; break;
+        case ROLES:         in_roles = true; break;
+        case LOCATION:      in_location = true; break;
     }
-    else if (name == "joined")
-        in_joined = true;
-    else if (name == "birthday")
-        in_birth = true;
-    else if (name == "status")
-        in_status = true;
-    else if (name == "roles")
-        in_roles = true;
-    else if (name == "location")
-        in_location = true;
+
+    _text.clear();
 
     return true;
 }
 /****************************************************************************/
 bool
-UserinfoXML::end_element(const std::string& name)
+UserinfoXML::end_element(xml::element_id id)
 {
     if (meter())
         ++*meter();
 
-    if      (name == "user")        in_user = false;
-    else if (name == "firstname")   in_firstname = false;
-    else if (name == "familyname")  in_familyname = false;
-    else if (name == "pgpkey")      in_pgpkey = false;
-    else if (name == "email")       in_email = false;
-    else if (name == "joined")      in_joined = false;
-    else if (name == "birthday")    in_birth = false;
-    else if (name == "roles")       in_roles = false;
-    else if (name == "status")      in_status = false;
-    else if (name == "location")    in_location = false;
+    if (_skip)
+    {
+        if (id == USER)
+            _skip = false;
+        return true;
+    }
+
+    switch (id)
+    {
+        case USER:
+            if (not in_user)
+                break;
+            in_user = false;
+            _devs.insert(_cur_dev);
+
+            /* found the queried developer; stop parsing */
+            if (not this->query().empty())
+                return false;
+            break;
+        case FIRSTNAME:
+            in_firstname = false;
+            _cur_dev.set_name(_cur_dev.name() + _text);
+            break;
+        case FAMILYNAME:
+            in_familyname = false;
+            if (not _text.empty())
+                _cur_dev.set_name(_cur_dev.name() + " " + _text);
+            break;
+        case PGPKEY:
+            in_pgpkey = false;
+            _cur_dev.set_pgpkey(_text);
+            break;
+        case EMAIL:
+            if (not in_email)
+                break;
+            in_email = false;
+            _cur_dev.set_email(_text);
+            break;
+        case JOINED:
+            in_joined = false;
+            _cur_dev.set_joined(_text);
+            break;
+        case BIRTHDAY:
+            in_birth = false;
+            _cur_dev.set_birthday(_text);
+            break;
+        case ROLES:
+            in_roles = false;
+            _cur_dev.set_role(_text);
+            break;
+        case STATUS:
+            in_status = false;
+            if (not _text.empty())
+                _cur_dev.set_status(_text);
+            break;
+        case LOCATION:
+            in_location = false;
+            _cur_dev.set_location(_text);
+            break;
+    }
+
     return true;
 }
 /****************************************************************************/
 bool
-UserinfoXML::do_text(const std::string& text)
+UserinfoXML::do_text(const util::StringView& text)
 {
     if (meter())
         ++*meter();
 
-    if (in_firstname)
-        const_cast<Developer&>(*_cur_dev).set_name(_cur_dev->name() + text);
-    else if (in_familyname)
-        const_cast<Developer&>(*_cur_dev).set_name(_cur_dev->name() + " " + text);
-    else if (in_pgpkey)
-        const_cast<Developer&>(*_cur_dev).set_pgpkey(text);
-    else if (in_email)
-        const_cast<Developer&>(*_cur_dev).set_email(text);
-    else if (in_joined)
-        const_cast<Developer&>(*_cur_dev).set_joined(text);
-    else if (in_birth)
-        const_cast<Developer&>(*_cur_dev).set_birthday(text);
-    else if (in_roles)
-        const_cast<Developer&>(*_cur_dev).set_role(_cur_dev->role() + text);
-    else if (in_status)
-        const_cast<Developer&>(*_cur_dev).set_status(text);
-    else if (in_location)
-        const_cast<Developer&>(*_cur_dev).set_location(_cur_dev->location() + text);
+    if (in_firstname or in_familyname or in_pgpkey or in_email or
+        in_joined or in_birth or in_roles or in_status or in_location)
+        text.append_to(_text);
 
     return true;
 }
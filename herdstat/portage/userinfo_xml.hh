@@ -96,13 +96,24 @@ namespace portage {
 
             ///@{
             /// SAX2 Callbacks
-            virtual bool start_element(const std::string& name,
+            virtual const xml::ElementTable& elements() const;
+            virtual bool start_element(xml::element_id id,
                                        const attrs_type& attrs);
-            virtual bool end_element(const std::string& name);
-            virtual bool do_text(const std::string& text);
+            virtual bool end_element(xml::element_id id);
+            virtual bool do_text(const util::StringView& text);
+            ///@}
+
+            ///@{
+            /// Snapshot support.
+            virtual bool do_load_snapshot(io::BinaryIStream& stream);
+            virtual bool do_save_snapshot(io::BinaryOStream& stream) const;
             ///@}
 
         private:
+            /// userinfo.xml elements.
+            enum { USER = 1, FIRSTNAME, FAMILYNAME, PGPKEY, EMAIL, JOINED,
+                   BIRTHDAY, STATUS, ROLES, LOCATION };
+
             Developers _devs;
             static const char * const _local_default;
 
@@ -117,7 +128,12 @@ namespace portage {
                  in_status,
                  in_location;
 
-            Developers::iterator _cur_dev;
+            /// developer being parsed (inserted at </user>).
+            Developer _cur_dev;
+            /// text of the current element.
+            std::string _text;
+            /// skipping a <user> that doesn't match the query?
+            bool _skip;
     };
 
     inline const Developers& UserinfoXML::devs() const { return _devs; }
@@ -129,6 +129,15 @@ VersionComponents::assign(const std::string& path) throw()
 }
 /****************************************************************************/
 void
+VersionComponents::assign(const std::string& pn, const std::string& pv,
+                          const std::string& pr) throw()
+{
+    _verstr.assign(pv + "-" + pr);
+    _vmap.clear();
+    this->insert(pn, pv, pr);
+}
+/****************************************************************************/
+void
 VersionComponents::parse() throw()
 {
     /* append -r0 if necessary */
@@ -162,15 +171,7 @@ VersionComponents::parse() throw()
     /* this should NEVER != 3. */
     assert(parts.size() == 3);
 
-    /* fill our map with the components */
-    std::pair<iterator, bool> pn = _vmap.insert(value_type("PN", parts[0]));
-    std::pair<iterator, bool> pv = _vmap.insert(value_type("PV", parts[1]));
-    std::pair<iterator, bool> pr = _vmap.insert(value_type("PR", parts[2]));
-    assert(pn.second and pv.second and pr.second);
-    _vmap.insert(value_type("P", pn.first->second+"-"+pv.first->second));
-    std::pair<iterator, bool> pvr = _vmap.insert(value_type("PVR",
-        pv.first->second+"-"+pr.first->second));
-    _vmap.insert(value_type("PF", pn.first->second+"-"+pvr.first->second));
+    this->insert(parts[0], parts[1], parts[2]);
 
     /* remove $PN from _verstr */
     std::string::size_type len(_vmap["PN"].length());
@@ -178,6 +179,19 @@ VersionComponents::parse() throw()
         ++len;
     _verstr.erase(0, len);
 }
+/****************************************************************************/
+void
+VersionComponents::insert(const std::string& pn, const std::string& pv,
+                          const std::string& pr) throw()
+{
+    /* fill our map with the components */
+    _vmap.insert(value_type("PN", pn));
+    _vmap.insert(value_type("PV", pv));
+    _vmap.insert(value_type("PR", pr));
+    _vmap.insert(value_type("P", pn+"-"+pv));
+    _vmap.insert(value_type("PVR", pv+"-"+pr));
+    _vmap.insert(value_type("PF", pn+"-"+pv+"-"+pr));
+}
 // }}}
 /****************************************************************************/
 // {{{ VersionString::suffix
@@ -437,6 +451,17 @@ VersionString::assign(const std::string& path) throw()
     _version.assign(_v["PV"]);
 }
 /****************************************************************************/
+void
+VersionString::assign(const std::string& path,
+                      const VersionComponents& v) throw()
+{
+    _ebuild.assign(path);
+    _v = v;
+    _verstr.assign(_v.version());
+    _suffix.assign(_v["PVR"]);
+    _version.assign(_v["PV"]);
+}
+/****************************************************************************/
 std::string
 VersionString::str() const throw()
 {
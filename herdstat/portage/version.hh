@@ -101,6 +101,15 @@ namespace portage {
              */
             void assign(const std::string& path) throw();
 
+            /** Assign components that are already known (e.g. read back
+             * from a cache), without parsing a path.
+             * @param pn ${PN}.
+             * @param pv ${PV}.
+             * @param pr ${PR}.
+             */
+            void assign(const std::string& pn, const std::string& pv,
+                        const std::string& pr) throw();
+
             /** Get value mapped to given version component.
              * @param key version component (P, PN, etc).
              * @returns const reference to value mapped to @a key.
@@ -124,6 +133,10 @@ namespace portage {
             /// Parse version string and insert components into map.
             void parse() throw();
 
+            /// Insert components (and the ones made of them) into map.
+            void insert(const std::string& pn, const std::string& pv,
+                        const std::string& pr) throw();
+
             std::string _verstr;
             mutable container_type _vmap;
     };
@@ -197,6 +210,13 @@ std::cout << v1.str() << std::endl;
              */
             void assign(const std::string& path) throw();
 
+            /** Assign a new path whose components are already known.
+             * @param path Path to ebuild.
+             * @param v Version components of @a path.
+             */
+            void assign(const std::string& path,
+                        const VersionComponents& v) throw();
+
             /// Implicit conversion to std::string.
             operator std::string() const throw() { return this->str(); }
 
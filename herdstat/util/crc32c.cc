@@ -0,0 +1,108 @@
+/*
+ * libherdstat -- herdstat/util/crc32c.cc
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cstring>
+#include <pthread.h>
+#ifdef __SSE4_2__
+# include <nmmintrin.h>
+#endif
+
+#include <herdstat/util/crc32c.hh>
+
+namespace herdstat {
+namespace util {
+#ifndef __SSE4_2__
+/****************************************************************************
+ * Tables for processing eight bytes at a time ("slicing-by-8"); table[0] is
+ * the classic byte-at-a-time table of the reflected polynomial.
+ ****************************************************************************/
+static uint32_t crc32c_table[8][256];
+static pthread_once_t crc32c_once = PTHREAD_ONCE_INIT;
+
+static void
+crc32c_init()
+{
+    for (uint32_t n = 0 ; n < 256 ; ++n)
+    {
+        uint32_t crc = n;
+        for (int k = 0 ; k < 8 ; ++k)
+            crc = (crc >> 1) ^ (0x82f63b78 & (0 - (crc & 1)));
+        crc32c_table[0][n] = crc;
+    }
+
+    for (uint32_t n = 0 ; n < 256 ; ++n)
+    {
+        uint32_t crc = crc32c_table[0][n];
+        for (int k = 1 ; k < 8 ; ++k)
+        {
+            crc = crc32c_table[0][crc & 0xff] ^ (crc >> 8);
+            crc32c_table[k][n] = crc;
+        }
+    }
+}
+#endif /* __SSE4_2__ */
+/****************************************************************************/
+uint32_t
+crc32c(const void *data, std::size_t len, uint32_t crc) throw()
+{
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+    crc = ~crc;
+
+#ifdef __SSE4_2__
+    for (; len >= 8 ; p += 8, len -= 8)
+    {
+        uint64_t v;
+        std::memcpy(&v, p, 8);
+        crc = static_cast<uint32_t>(_mm_crc32_u64(crc, v));
+    }
+
+    for (; len > 0 ; ++p, --len)
+        crc = _mm_crc32_u8(crc, *p);
+#else
+    pthread_once(&crc32c_once, crc32c_init);
+    const uint32_t (*t)[256] = crc32c_table;
+
+    for (; len >= 8 ; p += 8, len -= 8)
+    {
+        /* the byte order doesn't depend on the host's */
+        const uint32_t lo = crc ^ (p[0] | (p[1] << 8) | (p[2] << 16) |
+                                   (static_cast<uint32_t>(p[3]) << 24));
+        crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^
+              t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+              t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+    }
+
+    for (; len > 0 ; ++p, --len)
+        crc = t[0][(crc ^ *p) & 0xff] ^ (crc >> 8);
+#endif /* __SSE4_2__ */
+
+    return ~crc;
+}
+/****************************************************************************/
+} // namespace util
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,58 @@
+/*
+ * libherdstat -- herdstat/util/crc32c.hh
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_UTIL_CRC32C_HH
+#define _HAVE_UTIL_CRC32C_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/util/crc32c.hh
+ * @brief Defines the crc32c() function.
+ */
+
+#include <cstddef>
+#include <stdint.h>
+
+namespace herdstat {
+namespace util {
+
+    /** Compute the CRC-32C (Castagnoli) checksum of a range of bytes, as
+     * used by iSCSI, ext4 and others.  Uses the SSE4.2 crc32 instruction
+     * when built for it, and a table-driven implementation (eight bytes at
+     * a time) otherwise.
+     * @param data Pointer to data.
+     * @param len Length of data.
+     * @param crc Checksum of preceding data (to checksum in pieces).
+     * @returns checksum.
+     */
+    uint32_t crc32c(const void *data, std::size_t len, uint32_t crc = 0)
+        throw();
+
+} // namespace util
+} // namespace herdstat
+
+#endif /* _HAVE_UTIL_CRC32C_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
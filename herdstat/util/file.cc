@@ -30,9 +30,16 @@
 #include <utility>
 #include <cstring>
 #include <cassert>
+#include <cstdio>
+#include <fcntl.h>
+#include <pthread.h>
+#ifdef HAVE_SYS_SENDFILE_H
+# include <sys/sendfile.h>
+#endif
 
 #include <herdstat/exceptions.hh>
 #include <herdstat/util/functional.hh>
+#include <herdstat/util/string.hh>
 #include <herdstat/util/file.hh>
 
 namespace herdstat {
@@ -409,6 +416,62 @@ Directory::find(const Regex& regex) const throw()
     return std::find_if(this->begin(), this->end(),
         std::bind1st(regexMatch(), regex));
 }
+/*****************************************************************************
+ * Copy everything remaining in 'in' to 'out', preferring copy_file_range(2),
+ * then sendfile(2), and finally plain read(2)/write(2).  The former two
+ * leave the file offsets where the copy stopped, so each fallback simply
+ * carries on from there.  Returns false with errno set on failure.
+ *****************************************************************************/
+static bool
+copy_fd(int in, int out)
+{
+    ssize_t n;
+
+#ifdef HAVE_COPY_FILE_RANGE
+    while ((n = copy_file_range(in, NULL, out, NULL, 1 << 30, 0)) > 0)
+        ;
+    if (n == 0)
+        return true;
+    if (errno != ENOSYS and errno != EXDEV and errno != EINVAL and
+        errno != EOPNOTSUPP)
+        return false;
+#endif /* HAVE_COPY_FILE_RANGE */
+
+#if defined(HAVE_SENDFILE) && defined(HAVE_SYS_SENDFILE_H)
+    while ((n = sendfile(out, in, NULL, 1 << 30)) > 0)
+        ;
+    if (n == 0)
+        return true;
+    if (errno != ENOSYS and errno != EINVAL)
+        return false;
+#endif /* HAVE_SENDFILE */
+
+    char buf[BUFSIZ * 8];
+    while ((n = read(in, buf, sizeof(buf))) != 0)
+    {
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+
+        for (char *p = buf ; n > 0 ; )
+        {
+            const ssize_t w = write(out, p, n);
+            if (w < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return false;
+            }
+            p += w;
+            n -= w;
+        }
+    }
+
+    return true;
+}
 /*****************************************************************************
  * general purpose file-related functions                                    *
  *****************************************************************************/
@@ -417,36 +480,108 @@ copy_file(const std::string& from, const std::string& to) throw (FileException)
 {
     BacktraceContext c("herdstat::util::copy_file("+from+", "+to+")");
 
+    const int in = open(from.c_str(), O_RDONLY);
+    if (in < 0)
+        throw FileException(from);
+
     /* remove to if it exists */
     if (is_file(to) and (unlink(to.c_str()) != 0))
-	throw FileException(to);
+    {
+        close(in);
+        throw FileException(to);
+    }
+
+    const int out = open(to.c_str(), O_WRONLY|O_CREAT|O_TRUNC, 0666);
+    if (out < 0)
+    {
+        close(in);
+        throw FileException(to);
+    }
+
+    if (not copy_fd(in, out))
+    {
+        const int saved_errno = errno;
+        close(in);
+        close(out);
+        errno = saved_errno;
+        throw FileException(to);
+    }
+
+    close(in);
+    if (close(out) != 0)
+        throw FileException(to);
+}
+/*****************************************************************************/
+void
+copy_file_atomic(const std::string& from, const std::string& to)
+    throw (FileException)
+{
+    BacktraceContext c("herdstat::util::copy_file_atomic("+from+", "+to+")");
 
-    std::ifstream ffrom(from.c_str());
-    if (not ffrom)
-	throw FileException(from);
+    const int in = open(from.c_str(), O_RDONLY);
+    if (in < 0)
+        throw FileException(from);
 
-    std::ofstream fto(to.c_str());
-    if (not fto)
-	throw FileException(to);
+    struct stat st;
+    if (fstat(in, &st) != 0)
+    {
+        close(in);
+        throw FileException(from);
+    }
 
-    /* read from ffrom and write to fto */
+    /* same directory as to, so the rename can't cross file systems */
+    std::vector<char> tmp(to.begin(), to.end());
+    const char suffix[] = ".XXXXXX";
+    tmp.insert(tmp.end(), suffix, suffix + sizeof(suffix));
 
-//    std::copy(std::istream_iterator<std::string>(ffrom),
-//              std::istream_iterator<std::string>(),
-//              std::ostream_iterator<std::string>(fto, "\n"));
+    const int out = mkstemp(&tmp[0]);
+    if (out < 0)
+    {
+        close(in);
+        throw FileException(to);
+    }
 
-    std::string line;
-    while (std::getline(ffrom, line))
-        fto << line << std::endl;
+    if (fchmod(out, st.st_mode & 0777) != 0 or not copy_fd(in, out))
+    {
+        const int saved_errno = errno;
+        close(in);
+        close(out);
+        unlink(&tmp[0]);
+        errno = saved_errno;
+        throw FileException(to);
+    }
+
+    close(in);
+    if (close(out) != 0 or rename(&tmp[0], to.c_str()) != 0)
+    {
+        const int saved_errno = errno;
+        unlink(&tmp[0]);
+        errno = saved_errno;
+        throw FileException(to);
+    }
 }
 /*****************************************************************************/
 void
 move_file(const std::string& from, const std::string& to) throw (FileException)
 {
     BacktraceContext c("herdstat::util::move_file("+from+", "+to+")");
-    copy_file(from, to);
+
+    if (rename(from.c_str(), to.c_str()) == 0)
+        return;
+    if (errno != EXDEV)
+        throw FileException(from);
+
+    copy_file_atomic(from, to);
     if (unlink(from.c_str()) != 0)
-	throw FileException(from);
+        throw FileException(from);
+}
+/*****************************************************************************/
+std::string
+tmp_path(const std::string& path)
+{
+    return util::sprintf("%s.%d.%lx.tmp", path.c_str(),
+        static_cast<int>(getpid()),
+        static_cast<unsigned long>(pthread_self()));
 }
 /*****************************************************************************/
 } // namespace util
@@ -122,25 +122,51 @@ namespace util {
     }
 
     /**
-     * Copy file 'from' to file 'to'.
+     * Copy file 'from' to file 'to'.  The contents are copied byte for byte,
+     * in the kernel where possible (copy_file_range(2) or sendfile(2)).
      * @param from Source location.
      * @param to Destination location.
      * @exception FileException
      */
 
-    void copy_file(const std::string &to, const std::string &from)
+    void copy_file(const std::string &from, const std::string &to)
         throw (FileException);
 
     /**
-     * Move file 'from' to file 'to'.
+     * Copy file 'from' to file 'to' atomically.  The copy is made in a
+     * temporary file next to 'to', which is then renamed over it, so 'to'
+     * is never seen partially written.
      * @param from Source location.
      * @param to Destination location.
      * @exception FileException
      */
 
-    void move_file(const std::string &to, const std::string &from)
+    void copy_file_atomic(const std::string &from, const std::string &to)
         throw (FileException);
 
+    /**
+     * Move file 'from' to file 'to'.  Uses rename(2), falling back to
+     * copy_file_atomic() and unlink(2) if they're on different file
+     * systems.
+     * @param from Source location.
+     * @param to Destination location.
+     * @exception FileException
+     */
+
+    void move_file(const std::string &from, const std::string &to)
+        throw (FileException);
+
+    /**
+     * Get the name of a temporary file next to the given path, to be
+     * renamed over it once written.  The name is unique per process and
+     * thread, so concurrent writers of the same path don't trample each
+     * other.
+     * @param path Path.
+     * @returns Temporary file name.
+     */
+
+    std::string tmp_path(const std::string &path);
+
     /**
      * @enum ftype
      * @brief Denotes file type.
@@ -0,0 +1,138 @@
+/*
+ * libherdstat -- herdstat/util/mapped_file.cc
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef HAVE_MMAP
+# include <sys/mman.h>
+#endif
+
+#include <herdstat/util/mapped_file.hh>
+
+namespace herdstat {
+namespace util {
+/****************************************************************************/
+MappedFile::MappedFile() throw()
+    : _path(), _data(NULL), _size(0), _mapped(false)
+{
+}
+/****************************************************************************/
+MappedFile::MappedFile(const std::string& path) throw (FileException)
+    : _path(), _data(NULL), _size(0), _mapped(false)
+{
+    this->open(path);
+}
+/****************************************************************************/
+MappedFile::~MappedFile() throw()
+{
+    this->close();
+}
+/****************************************************************************/
+void
+MappedFile::open(const std::string& path) throw (FileException)
+{
+    BacktraceContext c("herdstat::util::MappedFile::open("+path+")");
+
+    this->close();
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw FileException(path);
+
+    struct stat s;
+    if (::fstat(fd, &s) != 0)
+    {
+        ::close(fd);
+        throw FileException(path);
+    }
+
+    _path.assign(path);
+    _size = s.st_size;
+
+    /* mmap() of a zero-length file fails; give empty files a valid pointer */
+    if (_size == 0)
+    {
+        ::close(fd);
+        _data = new char[1];
+        return;
+    }
+
+#ifdef HAVE_MMAP
+    void *p = ::mmap(NULL, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p != MAP_FAILED)
+    {
+        ::close(fd);
+        _data = static_cast<const char *>(p);
+        _mapped = true;
+        return;
+    }
+#endif /* HAVE_MMAP */
+
+    char *buf = new char[_size];
+    std::size_t total = 0;
+    while (total < _size)
+    {
+        const ssize_t n = ::read(fd, buf + total, _size - total);
+        if (n <= 0)
+        {
+            delete[] buf;
+            ::close(fd);
+            _path.clear();
+            _size = 0;
+            throw FileException(path);
+        }
+        total += n;
+    }
+
+    ::close(fd);
+    _data = buf;
+}
+/****************************************************************************/
+void
+MappedFile::close() throw()
+{
+    if (not _data)
+        return;
+
+#ifdef HAVE_MMAP
+    if (_mapped)
+        ::munmap(const_cast<char *>(_data), _size);
+    else
+#endif /* HAVE_MMAP */
+        delete[] _data;
+
+    _path.clear();
+    _data = NULL;
+    _size = 0;
+    _mapped = false;
+}
+/****************************************************************************/
+} // namespace util
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
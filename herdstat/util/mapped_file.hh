@@ -0,0 +1,99 @@
+/*
+ * libherdstat -- herdstat/util/mapped_file.hh
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_UTIL_MAPPED_FILE_HH
+#define _HAVE_UTIL_MAPPED_FILE_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/util/mapped_file.hh
+ * @brief Defines the MappedFile class.
+ */
+
+#include <string>
+#include <cstddef>
+#include <herdstat/noncopyable.hh>
+#include <herdstat/exceptions.hh>
+
+namespace herdstat {
+namespace util {
+
+    /**
+     * @class MappedFile mapped_file.hh herdstat/util/mapped_file.hh
+     * @brief Read-only memory mapping of an entire file.
+     *
+     * If mmap() isn't available (or fails), the file is read into a heap
+     * buffer instead, so callers need not care either way.
+     */
+
+    class MappedFile : private Noncopyable
+    {
+        public:
+            /// Default constructor.
+            MappedFile() throw();
+
+            /** Constructor.  Maps the specified file.
+             * @param path Path.
+             * @exception FileException
+             */
+            explicit MappedFile(const std::string& path) throw (FileException);
+
+            /// Destructor.  Unmaps file.
+            ~MappedFile() throw();
+
+            /** Map the specified file (unmapping any previously mapped file).
+             * @param path Path.
+             * @exception FileException
+             */
+            void open(const std::string& path) throw (FileException);
+
+            /// Unmap file.
+            void close() throw();
+
+            /// Get path of mapped file.
+            inline const std::string& path() const { return _path; }
+            /// Get pointer to the mapped data.
+            inline const char *data() const { return _data; }
+            /// Get size of the mapped data.
+            inline std::size_t size() const { return _size; }
+            /// Get pointer to one past the end of the mapped data.
+            inline const char *end() const { return _data + _size; }
+            /// Is a file mapped?
+            inline bool is_open() const { return (_data != NULL); }
+
+        private:
+            std::string _path;
+            const char *_data;
+            std::size_t _size;
+            /// whether _data was mmap()'d (as opposed to new[]'d).
+            bool _mapped;
+    };
+
+} // namespace util
+} // namespace herdstat
+
+#endif /* _HAVE_UTIL_MAPPED_FILE_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
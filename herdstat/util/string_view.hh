@@ -0,0 +1,149 @@
+/*
+ * libherdstat -- herdstat/util/string_view.hh
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_UTIL_STRING_VIEW_HH
+#define _HAVE_UTIL_STRING_VIEW_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/util/string_view.hh
+ * @brief Defines the StringView class.
+ */
+
+#include <string>
+#include <cstring>
+#include <ostream>
+
+namespace herdstat {
+namespace util {
+
+    /**
+     * @class StringView string_view.hh herdstat/util/string_view.hh
+     * @brief Non-owning reference to a range of characters.
+     *
+     * A StringView is only valid for as long as the characters it refers to.
+     * Use str() to get a copy that outlives it.
+     */
+
+    class StringView
+    {
+        public:
+            typedef std::string::size_type size_type;
+            typedef const char * const_iterator;
+
+            /// Default constructor (empty view).
+            StringView() throw() : _data(""), _size(0) { }
+
+            /** Constructor.
+             * @param data Pointer to first character.
+             * @param size Number of characters.
+             */
+            StringView(const char *data, size_type size) throw()
+                : _data(data), _size(size) { }
+
+            /** Constructor.
+             * @param str NUL-terminated string.
+             */
+            StringView(const char *str) throw()
+                : _data(str), _size(std::strlen(str)) { }
+
+            /** Constructor.
+             * @param str std::string (must outlive this view).
+             */
+            StringView(const std::string& str) throw()
+                : _data(str.data()), _size(str.size()) { }
+
+            inline const char *data() const { return _data; }
+            inline size_type size() const { return _size; }
+            inline size_type length() const { return _size; }
+            inline bool empty() const { return (_size == 0); }
+            inline const_iterator begin() const { return _data; }
+            inline const_iterator end() const { return _data + _size; }
+            inline char operator[](size_type n) const { return _data[n]; }
+
+            /// Get a copy of the referenced characters.
+            inline std::string str() const { return std::string(_data, _size); }
+
+            /// Append the referenced characters to @a s.
+            inline void append_to(std::string& s) const
+            { s.append(_data, _size); }
+
+            /** Find a character.
+             * @param c character.
+             * @param pos position to start searching at.
+             * @returns position of @a c or std::string::npos.
+             */
+            inline size_type find(char c, size_type pos = 0) const;
+
+            /// Get a view of a subrange.
+            inline StringView substr(size_type pos,
+                                     size_type n = std::string::npos) const;
+
+            inline bool operator==(const StringView& that) const;
+            inline bool operator!=(const StringView& that) const
+            { return not (*this == that); }
+
+        private:
+            const char *_data;
+            size_type _size;
+    };
+
+    inline StringView::size_type
+    StringView::find(char c, size_type pos) const
+    {
+        if (pos >= _size)
+            return std::string::npos;
+
+        const void *p = std::memchr(_data + pos, c, _size - pos);
+        return (p ? static_cast<const char *>(p) - _data : std::string::npos);
+    }
+
+    inline StringView
+    StringView::substr(size_type pos, size_type n) const
+    {
+        if (pos > _size) pos = _size;
+        if (n > _size - pos) n = _size - pos;
+        return StringView(_data + pos, n);
+    }
+
+    inline bool
+    StringView::operator==(const StringView& that) const
+    {
+        return (_size == that._size and
+                std::memcmp(_data, that._data, _size) == 0);
+    }
+
+    inline std::ostream&
+    operator<< (std::ostream& stream, const StringView& v)
+    {
+        return stream.write(v.data(), v.size());
+    }
+
+} // namespace util
+} // namespace herdstat
+
+#endif /* _HAVE_UTIL_STRING_VIEW_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,207 @@
+/*
+ * libherdstat -- herdstat/util/thread.cc
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cassert>
+#include <cerrno>
+#include <stdint.h>
+#include <exception>
+#include <unistd.h>
+#include <sys/time.h>
+#include <herdstat/util/thread.hh>
+
+namespace herdstat {
+namespace util {
+/****************************************************************************/
+Mutex::Mutex() throw()
+    : _mutex()
+{
+    pthread_mutex_init(&_mutex, NULL);
+}
+/****************************************************************************/
+Mutex::~Mutex() throw()
+{
+    pthread_mutex_destroy(&_mutex);
+}
+/****************************************************************************/
+void
+Mutex::lock() throw (ErrnoException)
+{
+    const int result = pthread_mutex_lock(&_mutex);
+    if (result != 0)
+    {
+        errno = result;
+        throw ErrnoException("pthread_mutex_lock");
+    }
+}
+/****************************************************************************/
+void
+Mutex::unlock() throw (ErrnoException)
+{
+    const int result = pthread_mutex_unlock(&_mutex);
+    if (result != 0)
+    {
+        errno = result;
+        throw ErrnoException("pthread_mutex_unlock");
+    }
+}
+/****************************************************************************/
+Condition::Condition() throw()
+    : _cond()
+{
+    pthread_cond_init(&_cond, NULL);
+}
+/****************************************************************************/
+Condition::~Condition() throw()
+{
+    pthread_cond_destroy(&_cond);
+}
+/****************************************************************************/
+void
+Condition::wait(Mutex& mutex) throw (ErrnoException)
+{
+    const int result = pthread_cond_wait(&_cond, &mutex._mutex);
+    if (result != 0)
+    {
+        errno = result;
+        throw ErrnoException("pthread_cond_wait");
+    }
+}
+/****************************************************************************/
+bool
+Condition::wait(Mutex& mutex, unsigned long ms) throw (ErrnoException)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+
+    const uint64_t nsec = (static_cast<uint64_t>(now.tv_usec) * 1000) +
+        (static_cast<uint64_t>(ms % 1000) * 1000000);
+
+    struct timespec until;
+    until.tv_sec = now.tv_sec + (ms / 1000) + (nsec / 1000000000);
+    until.tv_nsec = nsec % 1000000000;
+
+    const int result = pthread_cond_timedwait(&_cond, &mutex._mutex, &until);
+    if (result != 0 and result != ETIMEDOUT)
+    {
+        errno = result;
+        throw ErrnoException("pthread_cond_timedwait");
+    }
+    return (result == 0);
+}
+/****************************************************************************/
+void
+Condition::signal() throw()
+{
+    pthread_cond_signal(&_cond);
+}
+/****************************************************************************/
+void
+Condition::broadcast() throw()
+{
+    pthread_cond_broadcast(&_cond);
+}
+/****************************************************************************/
+Thread::Thread() throw()
+    : _thread(), _running(false), _error(), _failed(false)
+{
+}
+/****************************************************************************/
+Thread::~Thread() throw()
+{
+    assert(not _running);
+}
+/****************************************************************************/
+void
+Thread::start() throw (ErrnoException)
+{
+    assert(not _running);
+    _failed = false;
+    _error.clear();
+
+    const int result = pthread_create(&_thread, NULL, &Thread::entry, this);
+    if (result != 0)
+    {
+        errno = result;
+        throw ErrnoException("pthread_create");
+    }
+
+    _running = true;
+}
+/****************************************************************************/
+void
+Thread::join() throw (Exception)
+{
+    if (not _running)
+        return;
+
+    pthread_join(_thread, NULL);
+    _running = false;
+
+    if (_failed)
+        throw Exception("thread failed: %s", _error.c_str());
+}
+/****************************************************************************/
+void *
+Thread::entry(void *arg)
+{
+    /* libebt's context stack is process-wide */
+    BacktraceContext::disable();
+
+    Thread * const thread = static_cast<Thread *>(arg);
+
+    try
+    {
+        thread->run();
+    }
+    catch (const std::exception& e)
+    {
+        thread->_error.assign(e.what());
+        thread->_failed = true;
+    }
+    catch (...)
+    {
+        thread->_error.assign("unknown exception");
+        thread->_failed = true;
+    }
+
+    return NULL;
+}
+/****************************************************************************/
+unsigned int
+Thread::hardware_concurrency() throw()
+{
+#ifdef _SC_NPROCESSORS_ONLN
+    const long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n > 0)
+        return static_cast<unsigned int>(n);
+#endif
+    return 1;
+}
+/****************************************************************************/
+} // namespace util
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,201 @@
+/*
+ * libherdstat -- herdstat/util/thread.hh
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_UTIL_THREAD_HH
+#define _HAVE_UTIL_THREAD_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/util/thread.hh
+ * @brief Defines thin wrappers around POSIX threads primitives.
+ */
+
+#include <string>
+#include <pthread.h>
+#include <herdstat/noncopyable.hh>
+#include <herdstat/exceptions.hh>
+
+namespace herdstat {
+namespace util {
+
+    class Condition;
+
+    /**
+     * @class Mutex thread.hh herdstat/util/thread.hh
+     * @brief pthread_mutex_t wrapper.
+     */
+
+    class Mutex : private Noncopyable
+    {
+        public:
+            /// Default constructor.
+            Mutex() throw();
+
+            /// Destructor.
+            virtual ~Mutex() throw();
+
+            /// Lock mutex (blocks until available).
+            void lock() throw (ErrnoException);
+
+            /// Unlock mutex.
+            void unlock() throw (ErrnoException);
+
+        private:
+            friend class Condition;
+            pthread_mutex_t _mutex;
+    };
+
+    /**
+     * @class MutexLock thread.hh herdstat/util/thread.hh
+     * @brief Locks a Mutex for the lifetime of the MutexLock object.
+     *
+     * @section example Example
+     *
+@code
+herdstat::util::Mutex mutex;
+...
+{
+    herdstat::util::MutexLock lock(mutex);
+    ...
+} // mutex is unlocked here
+@endcode
+     */
+
+    class MutexLock : private Noncopyable
+    {
+        public:
+            /** Constructor.  Locks @a mutex.
+             * @param mutex reference to a Mutex object.
+             */
+            explicit MutexLock(Mutex& mutex) throw (ErrnoException)
+                : _mutex(mutex) { _mutex.lock(); }
+
+            /** Destructor.  Unlocks mutex.  Since we hold the lock,
+             * unlocking can only fail on a corrupted mutex, which is fatal.
+             */
+            virtual ~MutexLock() throw() { _mutex.unlock(); }
+
+        private:
+            Mutex& _mutex;
+    };
+
+    /**
+     * @class Condition thread.hh herdstat/util/thread.hh
+     * @brief pthread_cond_t wrapper.
+     *
+     * As with any condition variable, wait() should be called in a loop
+     * that re-checks the predicate, with the associated Mutex locked.
+     */
+
+    class Condition : private Noncopyable
+    {
+        public:
+            /// Default constructor.
+            Condition() throw();
+
+            /// Destructor.
+            virtual ~Condition() throw();
+
+            /** Atomically unlock @a mutex and wait to be signalled.  @a
+             * mutex is locked again when wait() returns.
+             * @param mutex reference to a locked Mutex.
+             */
+            void wait(Mutex& mutex) throw (ErrnoException);
+
+            /** Like wait(), but give up after @a ms milliseconds.
+             * @param mutex reference to a locked Mutex.
+             * @param ms Maximum time to wait, in milliseconds.
+             * @returns False if the wait timed out.
+             */
+            bool wait(Mutex& mutex, unsigned long ms)
+                throw (ErrnoException);
+
+            /// Wake up one waiting thread.
+            void signal() throw();
+
+            /// Wake up all waiting threads.
+            void broadcast() throw();
+
+        private:
+            pthread_cond_t _cond;
+    };
+
+    /**
+     * @class Thread thread.hh herdstat/util/thread.hh
+     * @brief pthread_t wrapper.  Derivatives implement run(), which is
+     * executed in a new thread once start() is called.
+     *
+     * An exception escaping run() ends the thread; join() then reports it.
+     * A started thread must be join()'d before the Thread object is
+     * destroyed.  BacktraceContext's are not recorded in the new
+     * thread (see BacktraceContext::disable()).
+     */
+
+    class Thread : private Noncopyable
+    {
+        public:
+            /// Default constructor.
+            Thread() throw();
+
+            /// Destructor.
+            virtual ~Thread() throw();
+
+            /** Start executing run() in a new thread.
+             * @exception ErrnoException
+             */
+            void start() throw (ErrnoException);
+
+            /** Wait for the thread to finish (no-op if not started).
+             * @exception Exception if run() threw (the thread has been
+             * joined nonetheless).
+             */
+            void join() throw (Exception);
+
+            /// Has the thread been started (and not yet joined)?
+            bool running() const { return _running; }
+
+            /// Get the number of online processors (at least 1).
+            static unsigned int hardware_concurrency() throw();
+
+        protected:
+            /// Thread body.
+            virtual void run() = 0;
+
+        private:
+            static void *entry(void *arg);
+
+            pthread_t _thread;
+            bool _running;
+            /// what() of the exception that escaped run(), if any.
+            std::string _error;
+            bool _failed;
+    };
+
+} // namespace util
+} // namespace herdstat
+
+#endif /* _HAVE_UTIL_THREAD_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,91 @@
+/*
+ * libherdstat -- herdstat/xml/attributes.hh
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_XML_ATTRIBUTES_HH
+#define _HAVE_XML_ATTRIBUTES_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/xml/attributes.hh
+ * @brief Defines the Attributes class.
+ */
+
+#include <utility>
+#include <herdstat/util/container_base.hh>
+#include <herdstat/util/string_view.hh>
+
+namespace herdstat {
+namespace xml {
+
+    /**
+     * @class Attributes attributes.hh herdstat/xml/attributes.hh
+     * @brief Attributes of an element, as (name, value) views.
+     *
+     * Names and values refer to the parser's buffer and are only valid for
+     * the duration of the start_element() callback.  Elements rarely have
+     * more than a couple of attributes, so lookups are linear.
+     */
+
+    class Attributes
+        : public util::VectorBase<std::pair<util::StringView, util::StringView> >
+    {
+        public:
+            /// Default constructor.
+            Attributes() throw() { }
+
+            /// Destructor.
+            virtual ~Attributes() throw() { }
+
+            /** Find an attribute by name.
+             * @param name Attribute name.
+             * @returns const_iterator to the attribute or end().
+             */
+            inline const_iterator find(const util::StringView& name) const;
+
+            /** Add an attribute.
+             * @param name Attribute name.
+             * @param value Attribute value.
+             */
+            inline void insert(const util::StringView& name,
+                               const util::StringView& value)
+            { this->push_back(std::make_pair(name, value)); }
+    };
+
+    inline Attributes::const_iterator
+    Attributes::find(const util::StringView& name) const
+    {
+        const_iterator i;
+        for (i = this->begin() ; i != this->end() ; ++i)
+            if (i->first == name)
+                break;
+        return i;
+    }
+
+} // namespace xml
+} // namespace herdstat
+
+#endif /* _HAVE_XML_ATTRIBUTES_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
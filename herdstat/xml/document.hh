@@ -108,9 +108,9 @@ namespace xml {
     {
         const std::string file(path.empty() ? this->path() : path);
         BacktraceContext c("herdstat::xml::Document::parse("+file+")");
-        SAXParser p(this->_handler.get());
+        const std::auto_ptr<SAXParser> p(SAXParser::create(this->_handler.get()));
         this->timer().start();
-        p.parse(file);
+        p->parse(file);
         this->timer().stop();
     }
 
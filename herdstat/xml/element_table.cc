@@ -0,0 +1,105 @@
+/*
+ * libherdstat -- herdstat/xml/element_table.cc
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cstring>
+#include <herdstat/xml/element_table.hh>
+
+namespace herdstat {
+namespace xml {
+/*** static members *********************************************************/
+const element_id ElementTable::unknown = 0;
+/****************************************************************************/
+ElementTable::ElementTable(const ElementTableEntry *entries,
+                           std::size_t n) throw()
+    : _entries(entries), _size(n), _slots(), _mask(0)
+{
+    /* keep the load factor at or below 1/2 so probe chains stay short */
+    std::size_t nslots = 8;
+    while (nslots < (n * 2))
+        nslots <<= 1;
+
+    _slots.assign(nslots, 0);
+    _mask = nslots - 1;
+
+    for (std::size_t i = 0 ; i < n ; ++i)
+    {
+        std::size_t slot =
+            hash(entries[i].name, std::strlen(entries[i].name)) & _mask;
+        while (_slots[slot] != 0)
+            slot = (slot + 1) & _mask;
+        _slots[slot] = i + 1;
+    }
+}
+/****************************************************************************/
+ElementTable::~ElementTable() throw()
+{
+}
+/****************************************************************************/
+std::size_t
+ElementTable::hash(const char *s, std::size_t len) throw()
+{
+    /* FNV-1a */
+    std::size_t h = 2166136261U;
+    for (std::size_t i = 0 ; i < len ; ++i)
+    {
+        h ^= static_cast<unsigned char>(s[i]);
+        h *= 16777619U;
+    }
+    return h;
+}
+/****************************************************************************/
+element_id
+ElementTable::operator()(const util::StringView& name) const throw()
+{
+    std::size_t slot = hash(name.data(), name.size()) & _mask;
+    while (_slots[slot] != 0)
+    {
+        const ElementTableEntry& e(_entries[_slots[slot] - 1]);
+        if (std::strlen(e.name) == name.size() and
+            std::memcmp(e.name, name.data(), name.size()) == 0)
+            return e.id;
+        slot = (slot + 1) & _mask;
+    }
+
+    return unknown;
+}
+/****************************************************************************/
+const char *
+ElementTable::name(element_id id) const throw()
+{
+    for (std::size_t i = 0 ; i < _size ; ++i)
+    {
+        if (_entries[i].id == id)
+            return _entries[i].name;
+    }
+
+    return NULL;
+}
+/****************************************************************************/
+} // namespace xml
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,128 @@
+/*
+ * libherdstat -- herdstat/xml/element_table.hh
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_XML_ELEMENT_TABLE_HH
+#define _HAVE_XML_ELEMENT_TABLE_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/xml/element_table.hh
+ * @brief Defines the ElementTable class.
+ */
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <herdstat/noncopyable.hh>
+#include <herdstat/util/string_view.hh>
+
+namespace herdstat {
+namespace xml {
+
+    /// Interned element ID.
+    typedef int element_id;
+
+    /**
+     * @struct ElementTableEntry element_table.hh herdstat/xml/element_table.hh
+     * @brief Element name to element ID mapping.
+     */
+
+    struct ElementTableEntry
+    {
+        const char *name;
+        element_id id;
+    };
+
+    /**
+     * @class ElementTable element_table.hh herdstat/xml/element_table.hh
+     * @brief Maps the element names of a document type to interned IDs.
+     *
+     * Each document type (herds.xml, metadata.xml, etc) defines a static
+     * array of ElementTableEntry's and an ElementTable built from it.
+     * Lookups hash the element name once and compare it against at most a
+     * couple of candidates, so SAXHandler derivatives can switch on the
+     * resulting ID instead of comparing strings.
+     *
+     * @section example Example
+     *
+@code
+enum { HERD = 1, NAME, EMAIL };
+static const xml::ElementTableEntry entries[] = {
+    { "herd", HERD }, { "name", NAME }, { "email", EMAIL }
+};
+static const xml::ElementTable table(entries, 3);
+...
+switch (table("name"))
+{
+    case NAME:
+    ...
+}
+@endcode
+     */
+
+    class ElementTable : private Noncopyable
+    {
+        public:
+            /// ID returned for elements not in the table.
+            static const element_id unknown;
+
+            /** Constructor.
+             * @param entries Array of entries.
+             * @param n Number of entries.
+             */
+            ElementTable(const ElementTableEntry *entries,
+                         std::size_t n) throw();
+
+            /// Destructor.
+            ~ElementTable() throw();
+
+            /** Look up an element name.
+             * @param name Element name.
+             * @returns element ID or ElementTable::unknown.
+             */
+            element_id operator()(const util::StringView& name) const throw();
+
+            /** Get the name of an element ID.
+             * @param id Element ID.
+             * @returns element name or NULL if the ID is unknown.
+             */
+            const char *name(element_id id) const throw();
+
+        private:
+            static std::size_t hash(const char *s, std::size_t len) throw();
+
+            const ElementTableEntry *_entries;
+            std::size_t _size;
+            /// open-addressed slots holding (index into _entries)+1.
+            std::vector<std::size_t> _slots;
+            std::size_t _mask;
+    };
+
+} // namespace xml
+} // namespace herdstat
+
+#endif /* _HAVE_XML_ELEMENT_TABLE_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
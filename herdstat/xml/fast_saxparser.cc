@@ -0,0 +1,555 @@
+/*
+ * libherdstat -- herdstat/xml/fast_saxparser.cc
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+#include <herdstat/util/string.hh>
+#include <herdstat/util/mapped_file.hh>
+#include <herdstat/xml/fast_saxparser.hh>
+
+namespace herdstat {
+namespace xml {
+/****************************************************************************/
+static inline bool
+is_ws(char c)
+{
+    return (c == ' ' or c == '\t' or c == '\n' or c == '\r');
+}
+/****************************************************************************/
+static inline bool
+is_name_end(char c)
+{
+    return (is_ws(c) or c == '>' or c == '/' or c == '=');
+}
+/****************************************************************************
+ * Append code point as UTF-8.
+ ****************************************************************************/
+static void
+append_utf8(std::string& out, unsigned long cp)
+{
+    if (cp < 0x80)
+        out += static_cast<char>(cp);
+    else if (cp < 0x800)
+    {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+    else if (cp < 0x10000)
+    {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+    else
+    {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+/****************************************************************************
+ * Thrown (and caught by parse_document()) when a construct continues past
+ * the data we have so far.
+ ****************************************************************************/
+class FastSAXParser::Incomplete : public ParserException
+{
+};
+/****************************************************************************/
+FastSAXParser::FastSAXParser(SAXHandler *handler) throw()
+    : SAXParser(handler), _begin(NULL), _cur(NULL), _end(NULL), _name(),
+      _stack(), _attrs(), _names(), _raw(), _decoded(), _text(), _chunks(),
+      _final(true), _seen_root(false), _streaming(false), _stopped(false)
+{
+}
+/****************************************************************************/
+FastSAXParser::~FastSAXParser() throw()
+{
+}
+/****************************************************************************/
+void
+FastSAXParser::parse(const std::string& path) throw (ParserException)
+{
+    BacktraceContext c("xml::FastSAXParser::parse("+path+")");
+
+    if (this->parse_compressed(path))
+        return;
+
+    util::MappedFile file;
+    try
+    {
+        file.open(path);
+    }
+    catch (const FileException& e)
+    {
+        throw ParserException(path, e.what());
+    }
+
+    this->parse(file.data(), file.end(), path);
+}
+/****************************************************************************/
+void
+FastSAXParser::parse(const char *begin, const char *end,
+                     const std::string& name) throw (ParserException)
+{
+    _begin = _cur = begin;
+    _end = end;
+    _name.assign(name);
+    _stack.clear();
+    _final = true;
+    _seen_root = false;
+
+    this->parse_document();
+}
+/****************************************************************************/
+bool
+FastSAXParser::parse_chunk(const char *data, std::size_t len)
+    throw (ParserException)
+{
+    if (not _streaming)
+    {
+        _chunks.clear();
+        _begin = _cur = _end = NULL;
+        _name.assign(this->document());
+        _stack.clear();
+        _seen_root = _stopped = false;
+        _streaming = true;
+    }
+    else if (_stopped)
+        return false;
+
+    const std::string::size_type offset = _cur - _begin;
+
+    /* grow the buffer ourselves so that the open element names (views
+     * into it) can be moved along */
+    if (_chunks.capacity() - _chunks.size() < len)
+    {
+        std::string buf;
+        buf.reserve(std::max(_chunks.size() + len, 2 * _chunks.capacity()));
+        buf.assign(_chunks);
+
+        std::vector<util::StringView>::iterator i;
+        for (i = _stack.begin() ; i != _stack.end() ; ++i)
+            *i = util::StringView(buf.data() + (i->begin() - _begin),
+                                  i->size());
+        _chunks.swap(buf);
+    }
+
+    _chunks.append(data, len);
+    _begin = _chunks.data();
+    _cur = _begin + offset;
+    _end = _begin + _chunks.size();
+    _final = false;
+
+    try
+    {
+        _stopped = not this->parse_document();
+    }
+    catch (const ParserException&)
+    {
+        _streaming = false;
+        throw;
+    }
+
+    return (not _stopped);
+}
+/****************************************************************************/
+void
+FastSAXParser::parse_finish() throw (ParserException)
+{
+    BacktraceContext c("xml::FastSAXParser::parse_finish()");
+
+    if (not _streaming)
+        throw ParserException(this->document(), "no document");
+
+    _streaming = false;
+    _final = true;
+
+    if (not _stopped)
+        this->parse_document();
+}
+/****************************************************************************/
+bool
+FastSAXParser::parse_document() throw (ParserException)
+{
+    /* skip UTF-8 BOM */
+    if (_cur == _begin)
+    {
+        const std::size_t len = std::min<std::size_t>(_end - _cur, 3);
+        if (len > 0 and std::memcmp(_cur, "\xEF\xBB\xBF", len) == 0)
+        {
+            if (len < 3 and not _final)
+                return true;
+            if (len == 3)
+                _cur += 3;
+        }
+    }
+
+    while (_cur < _end)
+    {
+        const char * const start = _cur;
+        try
+        {
+            if (not this->parse_next())
+                return false;
+        }
+        catch (const Incomplete&)
+        {
+            /* wait for the rest of it */
+            _cur = start;
+            return true;
+        }
+    }
+
+    if (not _final)
+        return true;
+
+    if (not _stack.empty())
+        this->error("premature end of data in tag <"+_stack.back().str()+">");
+    if (not _seen_root)
+        this->error("document is empty");
+
+    return true;
+}
+/****************************************************************************/
+bool
+FastSAXParser::parse_next() throw (ParserException)
+{
+    if (*_cur != '<')
+    {
+        if (_stack.empty())
+        {
+            this->skip_ws();
+            if (_cur < _end and *_cur != '<')
+                this->error("content outside of root element");
+            return true;
+        }
+
+        return this->parse_text();
+    }
+    else if (starts_with("</"))
+        return this->parse_end_tag();
+    else if (starts_with("<![CDATA["))
+    {
+        const char *begin = _cur + 9;
+        const char *end = std::search(begin, _end, "]]>", "]]>" + 3);
+        if (end == _end)
+            this->premature("unterminated CDATA section");
+        if (_stack.empty())
+            this->error("CDATA section outside of root element");
+
+        _cur = end + 3;
+        return this->text(util::StringView(begin, end - begin));
+    }
+    else if (starts_with("<?") or starts_with("<!"))
+    {
+        this->skip_markup();
+        return true;
+    }
+
+    if (_stack.empty() and _seen_root)
+        this->error("extra content at the end of the document");
+
+    const bool result = this->parse_start_tag();
+    _seen_root = true;
+    return result;
+}
+/****************************************************************************/
+bool
+FastSAXParser::parse_start_tag() throw (ParserException)
+{
+    ++_cur; /* '<' */
+    const util::StringView name(this->parse_name());
+
+    _attrs.clear();
+    _names.clear();
+    _raw.clear();
+
+    /* gather attribute names and raw values */
+    bool empty = false;
+    while (true)
+    {
+        this->skip_ws();
+        if (_cur >= _end)
+            this->premature("premature end of data in tag <"+name.str()+">");
+
+        if (*_cur == '>')
+        {
+            ++_cur;
+            break;
+        }
+        else if (*_cur == '/')
+        {
+            ++_cur;
+            this->expect('>');
+            empty = true;
+            break;
+        }
+
+        _names.push_back(this->parse_name());
+        this->skip_ws();
+        this->expect('=');
+        this->skip_ws();
+
+        if (_cur >= _end)
+            this->premature("attribute value must be quoted");
+        if (*_cur != '"' and *_cur != '\'')
+            this->error("attribute value must be quoted");
+
+        const char quote = *_cur++;
+        const char *begin = _cur;
+        const char *end = static_cast<const char *>(
+                std::memchr(begin, quote, _end - begin));
+        if (not end)
+            this->premature("unterminated attribute value");
+
+        _raw.push_back(util::StringView(begin, end - begin));
+        _cur = end + 1;
+    }
+
+    /* decode attribute values; views are made afterwards since _decoded
+     * may reallocate while growing */
+    if (_decoded.size() < _raw.size())
+        _decoded.resize(_raw.size());
+
+    for (std::vector<util::StringView>::size_type i = 0 ; i < _raw.size() ; ++i)
+        _raw[i] = decode(_raw[i].begin(), _raw[i].end(), _decoded[i], true);
+    for (std::vector<util::StringView>::size_type i = 0 ; i < _raw.size() ; ++i)
+        _attrs.insert(_names[i], _raw[i]);
+
+    if (not this->start_element(name, _attrs))
+        return false;
+
+    if (empty)
+        return this->end_element(name);
+
+    _stack.push_back(name);
+    return true;
+}
+/****************************************************************************/
+bool
+FastSAXParser::parse_end_tag() throw (ParserException)
+{
+    _cur += 2; /* "</" */
+    const util::StringView name(this->parse_name());
+    this->skip_ws();
+    this->expect('>');
+
+    if (_stack.empty())
+        this->error("unexpected end tag </"+name.str()+">");
+    if (_stack.back() != name)
+        this->error("opening and ending tag mismatch: <"+
+            _stack.back().str()+"> and </"+name.str()+">");
+
+    _stack.pop_back();
+    return this->end_element(name);
+}
+/****************************************************************************/
+bool
+FastSAXParser::parse_text() throw (ParserException)
+{
+    const char *begin = _cur;
+    const char *end = static_cast<const char *>(
+            std::memchr(begin, '<', _end - begin));
+    if (not end)
+    {
+        /* text may continue in the next chunk */
+        if (not _final)
+            throw Incomplete();
+        end = _end;
+    }
+
+    _cur = end;
+    return this->text(decode(begin, end, _text, false));
+}
+/****************************************************************************
+ * Skip processing instructions, comments and declarations (DOCTYPE, etc).
+ ****************************************************************************/
+void
+FastSAXParser::skip_markup() throw (ParserException)
+{
+    const char *end = NULL;
+
+    if (starts_with("<?"))
+    {
+        end = std::search(_cur + 2, _end, "?>", "?>" + 2);
+        if (end != _end)
+            end += 2;
+    }
+    else if (starts_with("<!--"))
+    {
+        end = std::search(_cur + 4, _end, "-->", "-->" + 3);
+        if (end != _end)
+            end += 3;
+    }
+    else
+    {
+        /* <!DOCTYPE ...> possibly with an internal subset in [] */
+        int depth = 0;
+        char quote = '\0';
+        for (end = _cur + 2 ; end < _end ; ++end)
+        {
+            if (quote)
+            {
+                if (*end == quote) quote = '\0';
+            }
+            else if (*end == '"' or *end == '\'') quote = *end;
+            else if (*end == '[') ++depth;
+            else if (*end == ']') --depth;
+            else if (*end == '>' and depth == 0) break;
+        }
+        if (end != _end)
+            ++end;
+    }
+
+    if (end == _end)
+        this->premature("unterminated markup declaration");
+
+    _cur = end;
+}
+/****************************************************************************/
+util::StringView
+FastSAXParser::parse_name() throw (ParserException)
+{
+    const char *begin = _cur;
+    while (_cur < _end and not is_name_end(*_cur))
+        ++_cur;
+
+    /* name may continue in the next chunk */
+    if (_cur == _end and not _final)
+        throw Incomplete();
+    if (_cur == begin)
+        this->error("expected a name");
+
+    return util::StringView(begin, _cur - begin);
+}
+/****************************************************************************/
+void
+FastSAXParser::skip_ws() throw()
+{
+    while (_cur < _end and is_ws(*_cur))
+        ++_cur;
+}
+/****************************************************************************/
+bool
+FastSAXParser::starts_with(const char *s) const throw()
+{
+    const std::size_t len = std::strlen(s);
+    return (static_cast<std::size_t>(_end - _cur) >= len and
+            std::memcmp(_cur, s, len) == 0);
+}
+/****************************************************************************/
+void
+FastSAXParser::expect(char c) throw (ParserException)
+{
+    if (_cur >= _end)
+        this->premature(std::string("expected '") + c + "'");
+    if (*_cur != c)
+        this->error(std::string("expected '") + c + "'");
+    ++_cur;
+}
+/****************************************************************************/
+void
+FastSAXParser::error(const std::string& msg) const throw (ParserException)
+{
+    const long line = std::count(_begin, std::min(_cur, _end), '\n') + 1;
+    throw ParserException(_name, util::sprintf("line %ld: %s", line,
+                                               msg.c_str()));
+}
+/****************************************************************************/
+void
+FastSAXParser::premature(const std::string& msg) const throw (ParserException)
+{
+    if (not _final)
+        throw Incomplete();
+    this->error(msg);
+}
+/****************************************************************************/
+util::StringView
+FastSAXParser::decode(const char *begin, const char *end,
+                      std::string& out, bool attr)
+{
+    const char *p = begin;
+    while (p < end and *p != '&' and
+          (not attr or (*p != '\t' and *p != '\n' and *p != '\r')))
+        ++p;
+
+    /* nothing to decode */
+    if (p == end)
+        return util::StringView(begin, end - begin);
+
+    out.assign(begin, p);
+    while (p < end)
+    {
+        if (*p != '&')
+        {
+            out += (attr and is_ws(*p)) ? ' ' : *p;
+            ++p;
+            continue;
+        }
+
+        const char *semi = static_cast<const char *>(
+                std::memchr(p, ';', end - p));
+        if (not semi)
+        {
+            out.append(p, end);
+            break;
+        }
+
+        const util::StringView ref(p + 1, semi - p - 1);
+        if (ref == "lt")        out += '<';
+        else if (ref == "gt")   out += '>';
+        else if (ref == "amp")  out += '&';
+        else if (ref == "quot") out += '"';
+        else if (ref == "apos") out += '\'';
+        else if (ref.size() > 1 and ref[0] == '#')
+        {
+            const std::string num(ref.substr(1).str());
+            char *invalid = NULL;
+            const unsigned long cp = (num[0] == 'x' or num[0] == 'X') ?
+                std::strtoul(num.c_str() + 1, &invalid, 16) :
+                std::strtoul(num.c_str(), &invalid, 10);
+            if (*invalid == '\0' and cp > 0 and cp <= 0x10FFFF)
+                append_utf8(out, cp);
+            else
+                out.append(p, semi + 1);
+        }
+        else
+            /* unknown (DTD-defined) entity - leave it alone */
+            out.append(p, semi + 1);
+
+        p = semi + 1;
+    }
+
+    return util::StringView(out);
+}
+/****************************************************************************/
+} // namespace xml
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,161 @@
+/*
+ * libherdstat -- herdstat/xml/fast_saxparser.hh
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_XML_FAST_SAXPARSER_HH
+#define _HAVE_XML_FAST_SAXPARSER_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/xml/fast_saxparser.hh
+ * @brief Defines the FastSAXParser class.
+ */
+
+#include <string>
+#include <vector>
+#include <herdstat/util/string_view.hh>
+#include <herdstat/xml/saxparser.hh>
+
+namespace herdstat {
+namespace xml {
+
+    /**
+     * @class FastSAXParser fast_saxparser.hh herdstat/xml/fast_saxparser.hh
+     * @brief Built-in, non-validating SAXParser backend.
+     *
+     * @section overview Overview
+     *
+     * FastSAXParser maps the file into memory and reports element names,
+     * attributes and text as views into the mapping, so no per-event
+     * allocations are done.  Only text and attribute values that contain
+     * character/entity references are decoded (into a reused buffer).
+     *
+     * It understands everything herds.xml, metadata.xml, userinfo.xml and
+     * friends use: elements, attributes, text, CDATA sections, comments,
+     * processing instructions and DOCTYPE declarations (which are skipped).
+     * Only the predefined entities and numeric character references are
+     * expanded; external subsets are never loaded.  Mismatched tags and
+     * premature end of data are reported as ParserException's.
+     *
+     * Documents passed with parse_chunk() are parsed as they arrive: each
+     * tag, text node or declaration is reported as soon as it's complete,
+     * and parsing resumes at the first incomplete one when the next chunk
+     * comes in.  The data is kept until parse_finish(), since open element
+     * names are views into it.
+     */
+
+    class FastSAXParser : public SAXParser
+    {
+        public:
+            /** Constructor.
+             * @param h pointer to a SAXHandler object.
+             */
+            explicit FastSAXParser(SAXHandler *h) throw();
+
+            /// Destructor.
+            virtual ~FastSAXParser() throw();
+
+            /** Parse file.
+             * @param path Path.
+             * @exception ParserException.
+             */
+            virtual void parse(const std::string& path)
+                throw (ParserException);
+
+            /** Parse a buffer.
+             * @param begin Pointer to first character.
+             * @param end Pointer to one past the last character.
+             * @param name Name used in error messages (defaults to empty).
+             * @exception ParserException.
+             */
+            void parse(const char *begin, const char *end,
+                       const std::string& name = "")
+                throw (ParserException);
+
+            /** Parse the next chunk of a document.
+             * @param data Pointer to data.
+             * @param len Length of data.
+             * @exception ParserException.
+             * @returns False if a callback stopped parsing.
+             */
+            virtual bool parse_chunk(const char *data, std::size_t len)
+                throw (ParserException);
+
+            /** Parse the document passed with parse_chunk().
+             * @exception ParserException.
+             */
+            virtual void parse_finish() throw (ParserException);
+
+        private:
+            class Incomplete;
+
+            /// Parse [_cur,_end).  Returns false if a callback stopped us.
+            bool parse_document() throw (ParserException);
+            /// Parse the construct at _cur.
+            bool parse_next() throw (ParserException);
+            bool parse_start_tag() throw (ParserException);
+            bool parse_end_tag() throw (ParserException);
+            bool parse_text() throw (ParserException);
+            void skip_markup() throw (ParserException);
+            util::StringView parse_name() throw (ParserException);
+            void skip_ws() throw();
+            bool starts_with(const char *s) const throw();
+            void expect(char c) throw (ParserException);
+            void error(const std::string& msg) const throw (ParserException);
+            /// Hit the end of data; only an error() if there's no more.
+            void premature(const std::string& msg) const
+                throw (ParserException);
+
+            /** Decode entity/character references (and, for attribute
+             * values, normalize whitespace) in [begin,end) into @a out.
+             * @returns view of the decoded text (possibly [begin,end)
+             * itself if nothing needed decoding).
+             */
+            static util::StringView decode(const char *begin, const char *end,
+                                           std::string& out, bool attr);
+
+            const char *_begin, *_cur, *_end;
+            std::string _name;
+            std::vector<util::StringView> _stack;
+            Attributes _attrs;
+            /// attribute names and raw values (before decoding).
+            std::vector<util::StringView> _names, _raw;
+            /// decoding buffers.
+            std::vector<std::string> _decoded;
+            std::string _text;
+            /// document passed with parse_chunk().
+            std::string _chunks;
+            /// is [_cur,_end) all there is?
+            bool _final;
+            bool _seen_root;
+            bool _streaming;
+            bool _stopped;
+    };
+
+} // namespace xml
+} // namespace herdstat
+
+#endif /* _HAVE_XML_FAST_SAXPARSER_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -24,27 +24,52 @@
 # include "config.h"
 #endif
 
-#include <herdstat/util/string.hh>
+#include <memory>
+#include <cstdlib>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <zlib.h>
+
 #include <herdstat/xml/saxparser.hh>
+#include <herdstat/xml/xmlwrapp_saxparser.hh>
+#include <herdstat/xml/fast_saxparser.hh>
 
 namespace herdstat {
 namespace xml {
 /****************************************************************************/
+SAXHandler::SAXHandler()
+    : _error()
+{
+}
+/****************************************************************************/
 SAXHandler::~SAXHandler()
 {
 }
 /****************************************************************************/
-bool
-SAXHandler::text(const std::string& str)
+void
+SAXHandler::parse_file(const std::string& path, const std::string& backend)
+    throw (ParserException)
 {
-    if (not util::is_all_whitespace(str))
-        return do_text(str);
+    _error.clear();
 
-    return true;
+    const std::auto_ptr<SAXParser> parser(SAXParser::create(this, backend));
+    parser->parse(path);
+
+    if (not _error.empty())
+        throw ParserException(path, _error);
+}
+/****************************************************************************/
+bool
+SAXHandler::error(const std::string& msg)
+{
+    _error.assign(msg);
+    return false;
 }
 /****************************************************************************/
 SAXParser::SAXParser(SAXHandler *handler) throw()
-    : _handler(handler)
+    : _handler(handler), _document()
 {
 }
 /****************************************************************************/
@@ -52,13 +77,99 @@ SAXParser::~SAXParser() throw()
 {
 }
 /****************************************************************************/
-void
-SAXParser::parse(const std::string &path) throw (ParserException)
+bool
+SAXParser::parse_compressed(const std::string& path) throw (ParserException)
+{
+    /* gzip magic */
+    unsigned char magic[2] = { 0, 0 };
+    std::FILE *fp = std::fopen(path.c_str(), "rb");
+    if (not fp)
+        return false;
+    const std::size_t n = std::fread(magic, 1, sizeof(magic), fp);
+    std::fclose(fp);
+
+    if (n != sizeof(magic) or magic[0] != 0x1f or magic[1] != 0x8b)
+        return false;
+
+    BacktraceContext c("xml::SAXParser::parse_compressed("+path+")");
+    this->set_document(path);
+
+    gzFile gz = gzopen(path.c_str(), "rb");
+    if (not gz)
+        throw ParserException(path, std::strerror(errno ? errno : ENOMEM));
+
+    try
+    {
+        char buf[16384];
+        int len;
+        bool more = true;
+
+        while (more and (len = gzread(gz, buf, sizeof(buf))) > 0)
+            more = this->parse_chunk(buf, len);
+
+        if (more and len < 0)
+        {
+            int err;
+            const std::string msg(gzerror(gz, &err));
+            throw ParserException(path, msg);
+        }
+
+        this->parse_finish();
+    }
+    catch (const ParserException& e)
+    {
+        gzclose(gz);
+        throw ParserException(path, e.error());
+    }
+
+    gzclose(gz);
+    return true;
+}
+/****************************************************************************/
+std::string
+SAXParser::default_backend() throw()
+{
+    const char * const result = std::getenv("HERDSTAT_XML_BACKEND");
+    return ((result and *result) ? result : DEFAULT_XML_BACKEND);
+}
+/****************************************************************************/
+SAXParser *
+SAXParser::create(SAXHandler *handler, const std::string& backend)
+    throw (ParserException)
+{
+    const std::string id(backend.empty() ? default_backend() : backend);
+
+    if (id == "xmlwrapp")
+        return new XmlwrappSAXParser(handler);
+    else if (id == "fast")
+        return new FastSAXParser(handler);
+
+    throw ParserException("", "unknown XML backend '"+id+"'");
+}
+/****************************************************************************/
+bool
+SAXParser::start_element(const util::StringView& name, const Attributes& attrs)
+{
+    return _handler->start_element(_handler->elements()(name), attrs);
+}
+/****************************************************************************/
+bool
+SAXParser::end_element(const util::StringView& name)
 {
-    BacktraceContext c("xml::saxparser::parse("+path+")");
+    return _handler->end_element(_handler->elements()(name));
+}
+/****************************************************************************/
+bool
+SAXParser::text(const util::StringView& text)
+{
+    util::StringView::const_iterator i;
+    for (i = text.begin() ; i != text.end() ; ++i)
+    {
+        if (not std::isspace(static_cast<unsigned char>(*i)))
+            return _handler->do_text(text);
+    }
 
-    if (not this->_handler->parse_file(path.c_str()))
-        throw ParserException(path, this->_handler->get_error_message());
+    return true;
 }
 /****************************************************************************/
 } // namespace xml
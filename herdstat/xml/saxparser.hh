@@ -32,43 +32,107 @@
  * @brief Defines the saxparser/saxhandler classes.
  */
 
-#include <xmlwrapp/event_parser.h>
+#include <string>
+#include <cstddef>
 #include <herdstat/noncopyable.hh>
+#include <herdstat/util/string_view.hh>
 #include <herdstat/xml/exceptions.hh>
+#include <herdstat/xml/element_table.hh>
+#include <herdstat/xml/attributes.hh>
+
+/**
+ * @def DEFAULT_XML_BACKEND
+ * @brief Default SAXParser backend to use.
+ */
+#define DEFAULT_XML_BACKEND     "xmlwrapp"
 
 namespace herdstat {
 namespace xml {
 
+    class SAXParser;
+
     /**
      * @class SAXHandler saxparser.hh herdstat/xml/saxparser.hh
      * @brief Abstract SAX2 Content Handler.
+     *
+     * Element names are interned via the ElementTable returned by
+     * elements(), so derivatives receive an element_id (which they can
+     * switch on) instead of the element name.  Text and attributes are
+     * passed as util::StringView's that are only valid for the duration of
+     * the callback.
+     *
+     * Returning false from any of the callbacks stops parsing (this is not
+     * considered an error).  To stop because the document is bad, return
+     * error() instead, which makes parse_file() throw.
      */
 
-    class SAXHandler : public ::xml::event_parser
+    class SAXHandler
     {
         public:
+            typedef Attributes attrs_type;
+
+            /// Default constructor.
+            SAXHandler();
+
             /// Destructor.
             virtual ~SAXHandler();
 
         protected:
+            /** Parse the specified file with this handler.
+             * @param path Path.
+             * @param backend SAXParser backend (defaults to the default one,
+             * see SAXParser::create()).
+             * @exception ParserException if the document is malformed or a
+             * callback returned error().
+             */
+            void parse_file(const std::string& path,
+                            const std::string& backend = "")
+                throw (ParserException);
+
+            /// Get the element table for this document type.
+            virtual const ElementTable& elements() const = 0;
+
             /// Callback called upon entering an element.
-            virtual bool start_element(const std::string &,
-                                       const attrs_type &) = 0;
+            virtual bool start_element(element_id id,
+                                       const attrs_type& attrs) = 0;
 
             /// Callback called upon exiting an element.
-            virtual bool end_element(const std::string &) = 0;
-
-            /** Callback called upon encountering the text of an element (does
-             * some common operations and then calls do_text()). */
-            virtual bool text(const std::string& str);
+            virtual bool end_element(element_id id) = 0;
 
             /// Callback called upon encountering the text of an element.
-            virtual bool do_text(const std::string& str) = 0;
+            virtual bool do_text(const util::StringView& text) = 0;
+
+            /** Record an error in the document, for a callback to return.
+             * @param msg Error message.
+             * @returns false (stopping the parse).
+             */
+            bool error(const std::string& msg);
+
+        private:
+            friend class SAXParser;
+
+            std::string _error;
     };
 
     /**
      * @class SAXParser saxparser.hh herdstat/xml/saxparser.hh
-     * @brief SAX2 parser interface.
+     * @brief SAX2 parser backend interface.
+     *
+     * @section overview Overview
+     *
+     * Concrete parsers implement parse(), parse_chunk() and parse_finish()
+     * and report events via the start_element(), end_element() and text()
+     * members, which take care of interning element names and filtering
+     * whitespace before calling the SAXHandler.  The following backends are available:
+     *
+     *  - "xmlwrapp" - XmlwrappSAXParser (libxml2 via xmlwrapp).
+     *  - "fast" - FastSAXParser (built-in, non-validating, zero-copy).
+     *
+     * @section usage Usage
+     *
+     * Use create() to instantiate a backend by name.  If no name is given,
+     * the value of the HERDSTAT_XML_BACKEND environment variable is used if
+     * set, otherwise DEFAULT_XML_BACKEND.
      */
 
     class SAXParser : private Noncopyable
@@ -87,14 +151,74 @@ namespace xml {
              * @exception ParserException.
              */
             virtual void parse(const std::string &path)
+                throw (ParserException) = 0;
+
+            /** Parse the next chunk of a document that arrives piecemeal
+             * (while it's being fetched, for instance).  Call parse_finish()
+             * once the document is complete.
+             * @param data Pointer to data.
+             * @param len Length of data.
+             * @exception ParserException.
+             * @returns False if a callback stopped parsing (subsequent
+             * chunks are ignored).
+             */
+            virtual bool parse_chunk(const char *data, std::size_t len)
+                throw (ParserException) = 0;
+
+            /** Finish parsing a document passed with parse_chunk().
+             * @exception ParserException.
+             */
+            virtual void parse_finish() throw (ParserException) = 0;
+
+            /** Set the name of the document passed with parse_chunk(), as
+             * reported by ParserException::file().
+             * @param name Document name (usually its path).
+             */
+            void set_document(const std::string& name) { _document = name; }
+
+            /// Get the name of the document passed with parse_chunk().
+            const std::string& document() const { return _document; }
+
+            /** Instantiate a parser backend.
+             * @param h pointer to a SAXHandler object.
+             * @param backend Backend name (defaults to empty).
+             * @returns pointer to a new SAXParser (caller owns it).
+             * @exception ParserException if the backend is unknown.
+             */
+            static SAXParser *create(SAXHandler *h,
+                                     const std::string& backend = "")
                 throw (ParserException);
 
+            /// Get the name of the default backend.
+            static std::string default_backend() throw();
+
         protected:
             /// Get pointer to underlying SAXHandler object.
             SAXHandler *handler() const { return _handler; }
 
+            /** If a file is gzip-compressed, parse its decompressed
+             * contents with parse_chunk() and parse_finish().  Backends
+             * call this from parse() so that compressed files are read
+             * transparently.
+             * @param path Path.
+             * @exception ParserException.
+             * @returns False if the file isn't compressed (nothing has been
+             * parsed).
+             */
+            bool parse_compressed(const std::string& path)
+                throw (ParserException);
+
+            ///@{
+            /// Report events to the handler.
+            bool start_element(const util::StringView& name,
+                               const Attributes& attrs);
+            bool end_element(const util::StringView& name);
+            bool text(const util::StringView& text);
+            ///@}
+
         private:
             SAXHandler *_handler;
+            std::string _document;
     };
 
 } // namespace xml
@@ -0,0 +1,141 @@
+/*
+ * libherdstat -- herdstat/xml/xmlwrapp_saxparser.cc
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <xmlwrapp/event_parser.h>
+#include <herdstat/xml/xmlwrapp_saxparser.hh>
+
+namespace herdstat {
+namespace xml {
+/****************************************************************************
+ * Forwards event_parser callbacks to the owning XmlwrappSAXParser.
+ ****************************************************************************/
+class XmlwrappSAXParser::EventParser : public ::xml::event_parser
+{
+    public:
+        explicit EventParser(XmlwrappSAXParser& owner)
+            : ::xml::event_parser(), _owner(owner), _attrs(), _stopped(false)
+        { }
+
+        /// Did a callback stop the parse?
+        bool stopped() const { return _stopped; }
+
+    protected:
+        virtual bool start_element(const std::string& name,
+                                   const attrs_type& attrs)
+        {
+            _attrs.clear();
+            attrs_type::const_iterator i;
+            for (i = attrs.begin() ; i != attrs.end() ; ++i)
+                _attrs.insert(i->first, i->second);
+
+            return this->check(_owner.start_element(name, _attrs));
+        }
+
+        virtual bool end_element(const std::string& name)
+        { return this->check(_owner.end_element(name)); }
+
+        virtual bool text(const std::string& str)
+        { return this->check(_owner.text(str)); }
+
+    private:
+        bool check(bool result)
+        {
+            if (not result)
+                _stopped = true;
+            return result;
+        }
+
+        XmlwrappSAXParser& _owner;
+        Attributes _attrs;
+        bool _stopped;
+};
+/****************************************************************************/
+XmlwrappSAXParser::XmlwrappSAXParser(SAXHandler *handler) throw()
+    : SAXParser(handler), _push(NULL)
+{
+}
+/****************************************************************************/
+XmlwrappSAXParser::~XmlwrappSAXParser() throw()
+{
+    delete _push;
+}
+/****************************************************************************/
+void
+XmlwrappSAXParser::parse(const std::string& path) throw (ParserException)
+{
+    BacktraceContext c("xml::XmlwrappSAXParser::parse("+path+")");
+
+    if (this->parse_compressed(path))
+        return;
+
+    EventParser parser(*this);
+    if (not parser.parse_file(path.c_str()) and not parser.stopped())
+        throw ParserException(path, parser.get_error_message());
+}
+/****************************************************************************/
+bool
+XmlwrappSAXParser::parse_chunk(const char *data, std::size_t len)
+    throw (ParserException)
+{
+    if (not _push)
+        _push = new EventParser(*this);
+    else if (_push->stopped())
+        return false;
+
+    if (_push->parse_chunk(data, len))
+        return true;
+    if (_push->stopped())
+        return false;
+
+    const std::string msg(_push->get_error_message());
+    delete _push;
+    _push = NULL;
+    throw ParserException(this->document(), msg);
+}
+/****************************************************************************/
+void
+XmlwrappSAXParser::parse_finish() throw (ParserException)
+{
+    BacktraceContext c("xml::XmlwrappSAXParser::parse_finish()");
+
+    if (not _push)
+        throw ParserException(this->document(), "no document");
+
+    const bool result = (_push->stopped() or _push->parse_finish() or
+                         _push->stopped());
+    const std::string msg(_push->get_error_message());
+
+    delete _push;
+    _push = NULL;
+
+    if (not result)
+        throw ParserException(this->document(), msg);
+}
+/****************************************************************************/
+} // namespace xml
+} // namespace herdstat
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
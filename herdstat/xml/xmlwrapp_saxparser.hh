@@ -0,0 +1,94 @@
+/*
+ * libherdstat -- herdstat/xml/xmlwrapp_saxparser.hh
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_XML_XMLWRAPP_SAXPARSER_HH
+#define _HAVE_XML_XMLWRAPP_SAXPARSER_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+/**
+ * @file herdstat/xml/xmlwrapp_saxparser.hh
+ * @brief Defines the XmlwrappSAXParser class.
+ */
+
+#include <herdstat/xml/saxparser.hh>
+
+namespace herdstat {
+namespace xml {
+
+    /**
+     * @class XmlwrappSAXParser xmlwrapp_saxparser.hh herdstat/xml/xmlwrapp_saxparser.hh
+     * @brief SAXParser backend using xmlwrapp's event_parser (libxml2).
+     *
+     * Honors the settings made via xml::GlobalInit() (entity substitution,
+     * external subsets, validation).
+     */
+
+    class XmlwrappSAXParser : public SAXParser
+    {
+        public:
+            /** Constructor.
+             * @param h pointer to a SAXHandler object.
+             */
+            explicit XmlwrappSAXParser(SAXHandler *h) throw();
+
+            /// Destructor.
+            virtual ~XmlwrappSAXParser() throw();
+
+            /** Parse file.
+             * @param path Path.
+             * @exception ParserException.
+             */
+            virtual void parse(const std::string& path)
+                throw (ParserException);
+
+            /** Parse the next chunk of a document.  Uses libxml2's push
+             * parser, so events are reported as soon as possible.
+             * @param data Pointer to data.
+             * @param len Length of data.
+             * @exception ParserException.
+             * @returns False if a callback stopped parsing.
+             */
+            virtual bool parse_chunk(const char *data, std::size_t len)
+                throw (ParserException);
+
+            /** Finish parsing a document passed with parse_chunk().
+             * @exception ParserException.
+             */
+            virtual void parse_finish() throw (ParserException);
+
+        private:
+            class EventParser;
+            friend class EventParser;
+
+            /// Parser of the document passed with parse_chunk().
+            EventParser *_push;
+    };
+
+} // namespace xml
+} // namespace herdstat
+
+#endif /* _HAVE_XML_XMLWRAPP_SAXPARSER_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
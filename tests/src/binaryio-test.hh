@@ -28,8 +28,11 @@
 #endif
 
 #include <vector>
+#include <cstdio>
 #include <unistd.h>
+#include <herdstat/util/crc32c.hh>
 #include <herdstat/io/binary_stream_iterator.hh>
+#include <herdstat/io/mapped_binary_reader.hh>
 #include "test_handler.hh"
 
 DECLARE_TEST_HANDLER(BinaryIO)
@@ -129,6 +132,216 @@ BinaryIO::operator()(const opts_type& null LIBHERDSTAT_UNUSED) const
     }
 
     unlink("bar");
+
+    /* values, arrays and strings straddling the buffer's end, and a string
+     * bigger than the buffer */
+    std::vector<int> ints(1000);
+    for (std::size_t i = 0 ; i < ints.size() ; ++i)
+        ints[i] = static_cast<int>(i * 7);
+    const std::string big(1000, 'x');
+
+    {
+        std::cout << "Testing buffered BinaryOStream..." << std::endl;
+
+        herdstat::io::BinaryOStream stream;
+        stream.set_buffer_size(61);
+        stream.open("baz");
+
+        stream.write_array(&ints[0], ints.size());
+        for (std::size_t i = 0 ; i < 50 ; ++i)
+            stream << static_cast<short>(i) << s[i % s.size()];
+        stream << big << ints.size();
+
+        const bool flushed = stream.flush();
+        assert(flushed);
+        std::cout << "buffer size " << stream.buffer_size() << std::endl;
+    }
+
+    {
+        std::cout << "Testing buffered BinaryIStream..." << std::endl;
+
+        herdstat::io::BinaryIStream stream;
+        stream.set_buffer_size(37);
+        stream.open("baz");
+
+        std::vector<int> ints2(ints.size());
+        stream.read_array(&ints2[0], ints2.size());
+        std::cout << "read " << ints2.size() << " ints: "
+            << (ints == ints2 ? "ok" : "mismatch") << std::endl;
+
+        bool ok = true;
+        for (std::size_t i = 0 ; i < 50 ; ++i)
+        {
+            short n;
+            std::string str;
+            stream >> n >> str;
+            ok = ok and n == static_cast<short>(i) and str == s[i % s.size()];
+        }
+        std::cout << "read 50 values and strings: " << (ok ? "ok" : "mismatch")
+            << std::endl;
+
+        /* shrinking the buffer keeps what's been read ahead */
+        stream.set_buffer_size(16);
+
+        std::string big2;
+        std::vector<int>::size_type n = 0;
+        stream >> big2 >> n;
+        std::cout << "read " << big2.size() << " byte string: "
+            << (big2 == big and n == ints.size() ? "ok" : "mismatch")
+            << std::endl;
+
+        assert(stream);
+        stream >> n;
+        std::cout << "read past end: " << (stream ? "ok" : "failed")
+            << std::endl;
+    }
+
+    {
+        std::cout << "Testing MappedBinaryReader..." << std::endl;
+
+        herdstat::io::MappedBinaryReader reader("baz");
+        assert(reader);
+
+        /* random access into the array */
+        int v = 0;
+        reader.seek(500 * sizeof(int));
+        reader >> v;
+        std::cout << "ints[500] = " << v << std::endl;
+
+        reader.seek(ints.size() * sizeof(int));
+        bool ok = true;
+        for (std::size_t i = 0 ; i < 50 ; ++i)
+        {
+            short n = -1;
+            herdstat::util::StringView str;
+            reader >> n >> str;
+            ok = ok and n == static_cast<short>(i) and str == s[i % s.size()];
+        }
+        std::cout << "read 50 values and views: " << (ok ? "ok" : "mismatch")
+            << std::endl;
+
+        herdstat::util::StringView big2;
+        reader >> big2;
+        std::cout << "view of " << big2.size() << " byte string: "
+            << (big2 == big and big2.data() > reader.data() and
+                big2.data() + big2.size() < reader.data() + reader.size() ?
+                "in mapping" : "elsewhere") << std::endl;
+
+        std::vector<int>::size_type n = 0;
+        reader >> n;
+        assert(reader and reader.eof());
+        reader >> n;
+        std::cout << "read past end: " << (reader ? "ok" : "failed")
+            << std::endl;
+
+        std::vector<int> ints2(3);
+        reader.seek(0);
+        reader.read_array(&ints2[0], ints2.size());
+        std::cout << "after seek(0): " << ints2[0] << " " << ints2[1] << " "
+            << ints2[2] << std::endl;
+    }
+
+    unlink("baz");
+
+    {
+        std::cout << "Testing portable values..." << std::endl;
+
+        {
+            herdstat::io::BinaryOStream stream("qux");
+            stream << 1L << -2 << static_cast<short>(3);
+            stream.write_varint(300);
+            const bool closed = stream.close();
+            assert(closed);
+        }
+
+        herdstat::io::MappedBinaryReader reader("qux");
+        std::cout << "file size " << reader.size() << ", first bytes "
+            << static_cast<int>(reader.data()[0]) << " "
+            << static_cast<int>(reader.data()[7]) << std::endl;
+
+        long l = 0;
+        int i = 0;
+        short sh = 0;
+        std::size_t v = 0;
+        reader >> l >> i >> sh;
+        reader.read_varint(v);
+        std::cout << "read " << l << " " << i << " " << sh << " " << v
+            << std::endl;
+
+        unsigned char c = 0;
+        reader.seek(reader.size() - 2);
+        reader.read_varint(c);
+        std::cout << "varint too big for unsigned char: "
+            << (reader ? "ok" : "failed") << std::endl;
+
+        std::cout << "crc32c(\"123456789\") = " << std::hex
+            << herdstat::util::crc32c("123456789", 9) << std::dec
+            << std::endl;
+    }
+
+    unlink("qux");
+
+    {
+        std::cout << "Testing framed BinaryOStream..." << std::endl;
+
+        herdstat::io::BinaryOStream stream;
+        stream.set_buffer_size(61);
+        stream.open("qux", 0x54455354, 3);
+        assert(stream.is_framed());
+
+        stream.write_array(&ints[0], ints.size());
+        stream << big << s[0];
+        const bool closed = stream.close();
+        assert(closed);
+    }
+
+    {
+        std::cout << "Testing framed BinaryIStream..." << std::endl;
+
+        herdstat::io::BinaryIStream stream("qux", 0x54455354, 3);
+        stream.set_buffer_size(37);
+
+        std::vector<int> ints2(ints.size());
+        std::string big2, str;
+        stream.read_array(&ints2[0], ints2.size());
+        stream >> big2 >> str;
+        std::cout << "read back: " << (stream and ints == ints2 and
+            big2 == big and str == s[0] ? "ok" : "mismatch") << std::endl;
+
+        stream >> str;
+        std::cout << "read past end: " << (stream ? "ok" : "failed")
+            << std::endl;
+
+        herdstat::io::BinaryIStream other("qux", 0x54455354, 4);
+        std::cout << "wrong version: " << (other ? "ok" : "failed")
+            << std::endl;
+    }
+
+    {
+        /* flip a byte in the middle of the data */
+        std::FILE *fp = std::fopen("qux", "r+b");
+        assert(fp);
+        std::fseek(fp, 2000, SEEK_SET);
+        const int c = std::fgetc(fp);
+        std::fseek(fp, 2000, SEEK_SET);
+        std::fputc(c ^ 0x10, fp);
+        std::fclose(fp);
+
+        herdstat::io::BinaryIStream stream("qux", 0x54455354, 3);
+        std::vector<int> ints2(ints.size());
+        stream.read_array(&ints2[0], ints2.size());
+        std::cout << "corrupted: " << (stream ? "ok" : "failed") << std::endl;
+
+        /* cut short */
+        const int result = truncate("qux", 1000);
+        assert(result == 0);
+        herdstat::io::BinaryIStream stream2("qux", 0x54455354, 3);
+        stream2.read_array(&ints2[0], ints2.size());
+        std::cout << "truncated: " << (stream2 ? "ok" : "failed")
+            << std::endl;
+    }
+
+    unlink("qux");
 }
 
 #endif /* _HAVE_SRC_BINARYIO_TEST_HH */
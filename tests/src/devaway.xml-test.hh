@@ -27,6 +27,8 @@
 # include "config.h"
 #endif
 
+#include <fstream>
+#include <cstdio>
 #include <herdstat/util/file.hh>
 #include <herdstat/util/string.hh>
 #include <herdstat/xml/init.hh>
@@ -67,6 +69,34 @@ DevawayXMLTest::operator()(const opts_type& opts) const
     assert(i != devs.end());
     DisplayAwayDev display;
     display(*i);
+
+    /* query mode only parses the given developer */
+    herdstat::portage::DevawayXML query;
+    query.set_query("lv");
+    query.parse(path);
+    std::cout << "Query size: " << query.devs().size() << std::endl;
+    std::for_each(query.devs().begin(), query.devs().end(), DisplayAwayDev());
+
+    /* a <dev> without a nick is an error, not the end of the list */
+    const std::string bad("devaway-bad.xml");
+    {
+        std::ofstream stream(bad.c_str());
+        stream << "<devaway><dev nick=\"foo\"><reason>gone</reason></dev>"
+            "<dev><reason>gone too</reason></dev></devaway>" << std::endl;
+    }
+
+    try
+    {
+        herdstat::portage::DevawayXML bad_devaway(bad);
+        std::cout << "No nick: parsed "
+            << bad_devaway.devs().size() << std::endl;
+    }
+    catch (const herdstat::xml::ParserException& e)
+    {
+        std::cout << "No nick: " << e.error() << std::endl;
+    }
+
+    std::remove(bad.c_str());
 }
 
 #endif /* _HAVE__DEVAWAY.XML_TEST_HH */
@@ -0,0 +1,161 @@
+/*
+ * libherdstat -- tests/src/eclass_cache-test.hh
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE__ECLASS_CACHE_TEST_HH
+#define _HAVE__ECLASS_CACHE_TEST_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/stat.h>
+#include <herdstat/util/string.hh>
+#include <herdstat/portage/ebuild.hh>
+#include "test_handler.hh"
+
+DECLARE_TEST_HANDLER(EclassCacheTest)
+
+static void
+eclass_cache_write(std::vector<std::string>& files, const std::string& path,
+                   const std::string& contents)
+{
+    std::ofstream stream(path.c_str());
+    assert(stream);
+    stream << contents;
+    files.push_back(path);
+}
+
+static void
+eclass_cache_show(const std::string& path)
+{
+    const herdstat::portage::Ebuild ebuild(path);
+    std::cout << path.substr(path.rfind('/') + 1) << ":";
+
+    std::vector<std::string> names;
+    names.push_back("A");
+    names.push_back("B");
+    names.push_back("SHARED");
+    names.push_back("LOOP1");
+    names.push_back("LOOP2");
+    for (int n = 0 ; n <= 22 ; ++n)
+        names.push_back("C"+herdstat::util::stringify(n));
+
+    std::vector<std::string>::iterator i;
+    for (i = names.begin() ; i != names.end() ; ++i)
+    {
+        herdstat::portage::Ebuild::const_iterator v = ebuild.find(*i);
+        if (v != ebuild.end())
+            std::cout << " " << v->first << "=" << v->second;
+    }
+
+    std::cout << std::endl;
+}
+
+void
+EclassCacheTest::operator()(const opts_type& opts) const
+{
+    assert(opts.empty());
+
+    char cwd[PATH_MAX];
+    const char *result = getcwd(cwd, sizeof(cwd));
+    assert(result);
+
+    const std::string overlay(std::string(cwd)+"/eclass_cache.d");
+    const std::string eclassdir(overlay+"/eclass");
+    const std::string pkgdir(overlay+"/app-misc/test");
+    std::vector<std::string> files, dirs;
+
+    dirs.push_back(overlay);
+    dirs.push_back(eclassdir);
+    dirs.push_back(overlay+"/app-misc");
+    dirs.push_back(pkgdir);
+    std::vector<std::string>::iterator d;
+    for (d = dirs.begin() ; d != dirs.end() ; ++d)
+        mkdir(d->c_str(), 0755);
+
+    /* must be set before the first use of GlobalConfig() */
+    setenv("PORTDIR_OVERLAY", overlay.c_str(), 1);
+
+    /* a inherits b; loop1 and loop2 inherit each other */
+    eclass_cache_write(files, eclassdir+"/a.eclass",
+        "inherit b\nA=\"a\"\nSHARED=\"a\"\n");
+    eclass_cache_write(files, eclassdir+"/b.eclass",
+        "B=\"b1\"\nSHARED=\"b\"\n");
+    eclass_cache_write(files, eclassdir+"/loop1.eclass",
+        "inherit loop2\nLOOP1=\"1\"\n");
+    eclass_cache_write(files, eclassdir+"/loop2.eclass",
+        "inherit loop1\nLOOP2=\"2\"\n");
+
+    /* c0 inherits c1 ... inherits c22, deeper than max_depth */
+    for (int n = 0 ; n <= 22 ; ++n)
+    {
+        const std::string num(herdstat::util::stringify(n));
+        std::string contents;
+        if (n < 22)
+            contents += "inherit c"+herdstat::util::stringify(n+1)+"\n";
+        contents += "C"+num+"=\""+num+"\"\n";
+        eclass_cache_write(files, eclassdir+"/c"+num+".eclass", contents);
+    }
+
+    const std::string ebuild1(pkgdir+"/test-1.ebuild");
+    const std::string ebuild2(pkgdir+"/test-2.ebuild");
+    eclass_cache_write(files, ebuild1, "inherit a loop1 c0\n");
+    eclass_cache_write(files, ebuild2, "inherit c19 loop2\n");
+
+    /* chain stops at C19 */
+    eclass_cache_show(ebuild1);
+    /* c19 was cut short above, so it must not have been cached */
+    eclass_cache_show(ebuild2);
+
+    /* modifying b must invalidate a, which inherits it.  c19 ... c22 are
+     * cached now, but too deep to be used under c0. */
+    const std::string b(eclassdir+"/b.eclass");
+    {
+        std::ofstream stream(b.c_str());
+        assert(stream);
+        stream << "B=\"b2\"\nSHARED=\"b\"\n";
+    }
+
+    struct utimbuf times;
+    times.actime = times.modtime = std::time(NULL) + 60;
+    const int touched = utime(b.c_str(), &times);
+    assert(touched == 0);
+
+    eclass_cache_show(ebuild1);
+
+    std::vector<std::string>::iterator f;
+    for (f = files.begin() ; f != files.end() ; ++f)
+        std::remove(f->c_str());
+    std::vector<std::string>::reverse_iterator r;
+    for (r = dirs.rbegin() ; r != dirs.rend() ; ++r)
+        rmdir(r->c_str());
+}
+
+#endif /* _HAVE__ECLASS_CACHE_TEST_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,69 @@
+/*
+ * libherdstat -- tests/src/element_table-test.hh
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_SRC_ELEMENT_TABLE_TEST_HH
+#define _HAVE_SRC_ELEMENT_TABLE_TEST_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <herdstat/xml/element_table.hh>
+#include "test_handler.hh"
+
+DECLARE_TEST_HANDLER(ElementTableTest)
+
+void
+ElementTableTest::operator()(const opts_type& null LIBHERDSTAT_UNUSED) const
+{
+    enum { HERD = 1, NAME, EMAIL, DESCRIPTION, MAINTAINER, ROLE };
+    static const herdstat::xml::ElementTableEntry entries[] = {
+        { "herd",           HERD },
+        { "name",           NAME },
+        { "email",          EMAIL },
+        { "description",    DESCRIPTION },
+        { "maintainer",     MAINTAINER },
+        { "role",           ROLE }
+    };
+    const herdstat::xml::ElementTable table(entries,
+        sizeof(entries) / sizeof(entries[0]));
+
+    const char *names[] = { "herd", "name", "email", "description",
+        "maintainer", "role", "herds", "nam", "", "maintainingproject" };
+
+    for (std::size_t i = 0 ; i < sizeof(names) / sizeof(names[0]) ; ++i)
+    {
+        const herdstat::xml::element_id id = table(names[i]);
+        std::cout << "'" << names[i] << "' => " << id;
+        if (id != herdstat::xml::ElementTable::unknown)
+            std::cout << " ('" << table.name(id) << "')";
+        std::cout << std::endl;
+    }
+
+    /* lookups must not depend on NUL-termination */
+    const std::string s("emailaddress");
+    std::cout << table(herdstat::util::StringView(s.data(), 5)) << std::endl;
+}
+
+#endif /* _HAVE_SRC_ELEMENT_TABLE_TEST_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,737 @@
+/*
+ * libherdstat -- tests/src/fetcher-test.hh
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_SRC_FETCHER_TEST_HH
+#define _HAVE_SRC_FETCHER_TEST_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <fstream>
+#include <map>
+#include <vector>
+#include <sstream>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <zlib.h>
+#include <herdstat/util/file.hh>
+#include <herdstat/util/string.hh>
+#include <herdstat/util/thread.hh>
+#include <herdstat/fetchable.hh>
+#include "test_handler.hh"
+
+DECLARE_TEST_HANDLER(FetcherTest)
+
+#define FETCHER_TEST_WWW    "fetcher-test-www"
+#define FETCHER_TEST_OUT    "fetcher-test-out"
+
+/*
+ * Minimal HTTP/1.1 server standing in for the real thing.  Serves files from
+ * FETCHER_TEST_WWW on an ephemeral port of the loopback interface until
+ * stop() is called.  Connections are kept alive, and the number accepted
+ * is counted so that connection reuse can be checked.  Each file's ETag is
+ * its size, and requests with a matching If-None-Match get a 304.
+ * /redirect/x redirects to /x, and /chunked/x serves x chunked.  Every
+ * other request for /flaky/x fails with a 503 (and for /cut/x ends half
+ * way through the body), and /gzip/x is sent gzip-encoded if the client
+ * accepts an encoding.
+ */
+static std::string
+fetcher_test_gzip(const std::string& data)
+{
+    z_stream zs;
+    std::memset(&zs, 0, sizeof(zs));
+    deflateInit2(&zs, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+                 Z_DEFAULT_STRATEGY);
+
+    std::vector<char> out(deflateBound(&zs, data.size()) + 32);
+    zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+    zs.avail_in = data.size();
+    zs.next_out = reinterpret_cast<Bytef *>(&out[0]);
+    zs.avail_out = out.size();
+    deflate(&zs, Z_FINISH);
+    deflateEnd(&zs);
+
+    return std::string(&out[0], zs.total_out);
+}
+
+class FetcherTestServer : public herdstat::util::Thread
+{
+    public:
+        FetcherTestServer()
+            : _fd(socket(AF_INET, SOCK_STREAM, 0)), _port(0), _accepted(0),
+              _not_modified(0), _flaky()
+        {
+            struct sockaddr_in addr;
+            std::memset(&addr, 0, sizeof(addr));
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+            socklen_t len = sizeof(addr);
+            if (_fd < 0 or pipe(_wake) != 0 or
+                bind(_fd, reinterpret_cast<sockaddr *>(&addr), len) != 0 or
+                getsockname(_fd, reinterpret_cast<sockaddr *>(&addr),
+                            &len) != 0 or
+                listen(_fd, 16) != 0)
+                throw herdstat::ErrnoException("socket");
+
+            _port = ntohs(addr.sin_port);
+        }
+
+        ~FetcherTestServer() throw()
+        {
+            close(_fd);
+            close(_wake[0]);
+            close(_wake[1]);
+        }
+
+        unsigned short port() const { return _port; }
+
+        /* number of connections accepted so far */
+        unsigned int accepted() const
+        {
+            herdstat::util::MutexLock lock(_mutex);
+            return _accepted;
+        }
+
+        /* number of 304 responses sent so far */
+        unsigned int not_modified() const
+        {
+            herdstat::util::MutexLock lock(_mutex);
+            return _not_modified;
+        }
+
+        void stop()
+        {
+            if (write(_wake[1], "x", 1) == 1)
+                this->join();
+        }
+
+    protected:
+        virtual void run()
+        {
+            /* connection fd -> unprocessed input */
+            std::map<int, std::string> conns;
+
+            while (true)
+            {
+                std::vector<struct pollfd> fds;
+                fds.push_back(make_pollfd(_wake[0]));
+                fds.push_back(make_pollfd(_fd));
+
+                std::map<int, std::string>::iterator c;
+                for (c = conns.begin() ; c != conns.end() ; ++c)
+                    fds.push_back(make_pollfd(c->first));
+
+                if (poll(&fds[0], fds.size(), -1) < 0 or fds[0].revents)
+                    break;
+
+                if (fds[1].revents & POLLIN)
+                {
+                    const int conn = accept(_fd, NULL, NULL);
+                    if (conn >= 0)
+                    {
+                        conns[conn];
+                        herdstat::util::MutexLock lock(_mutex);
+                        ++_accepted;
+                    }
+                }
+
+                for (std::size_t i = 2 ; i < fds.size() ; ++i)
+                {
+                    if (not fds[i].revents)
+                        continue;
+
+                    const int conn = fds[i].fd;
+                    if (not this->serve(conn, conns[conn]))
+                    {
+                        close(conn);
+                        conns.erase(conn);
+                    }
+                }
+            }
+
+            std::map<int, std::string>::iterator c;
+            for (c = conns.begin() ; c != conns.end() ; ++c)
+                close(c->first);
+        }
+
+    private:
+        static struct pollfd make_pollfd(int fd)
+        {
+            struct pollfd p;
+            p.fd = fd;
+            p.events = POLLIN;
+            p.revents = 0;
+            return p;
+        }
+
+        /* read from conn and answer any complete requests.  returns false
+         * once the connection should be closed. */
+        bool serve(int conn, std::string& in)
+        {
+            char buf[1024];
+            const ssize_t n = read(conn, buf, sizeof(buf));
+            if (n <= 0)
+                return false;
+            in.append(buf, n);
+
+            std::string::size_type end;
+            while ((end = in.find("\r\n\r\n")) != std::string::npos)
+            {
+                const std::string req(in.substr(0, end));
+                in.erase(0, end + 4);
+
+                std::string path;
+                std::istringstream is(req);
+                is >> path >> path;
+
+                std::ostringstream os;
+
+                if (path.compare(0, 10, "/redirect/") == 0)
+                {
+                    os << "HTTP/1.1 302 Found\r\n"
+                       << "Location: " << path.substr(9) << "\r\n"
+                       << "Content-Length: 5\r\n\r\nmoved";
+                    if (not this->send(conn, os.str()))
+                        return false;
+                    continue;
+                }
+
+                /* every other request for /flaky/x fails */
+                if (path.compare(0, 7, "/flaky/") == 0)
+                {
+                    path.erase(0, 6);
+                    if (_flaky[path]++ % 2 == 0)
+                    {
+                        os << "HTTP/1.1 503 Service Unavailable\r\n"
+                           << "Content-Length: 4\r\n\r\nbusy";
+                        if (not this->send(conn, os.str()))
+                            return false;
+                        continue;
+                    }
+                }
+
+                bool cut = false;
+                if (path.compare(0, 5, "/cut/") == 0)
+                {
+                    cut = (_flaky[path]++ % 2 == 0);
+                    path.erase(0, 4);
+                }
+
+                const bool chunked = (path.compare(0, 9, "/chunked/") == 0);
+                if (chunked)
+                    path.erase(0, 8);
+
+                const bool gzip = (path.compare(0, 6, "/gzip/") == 0 and
+                    req.find("\r\nAccept-Encoding: ") != std::string::npos);
+                if (path.compare(0, 6, "/gzip/") == 0)
+                    path.erase(0, 5);
+
+                std::string body, status("200 OK");
+                std::ifstream f((FETCHER_TEST_WWW+path).c_str());
+                if (f)
+                    std::getline(f, body, '\0');
+                else
+                    status.assign("404 Not Found");
+
+                const std::string etag("\""+
+                    herdstat::util::stringify(body.size())+"\"");
+
+                if (f and req.find("\r\nIf-None-Match: "+etag) !=
+                        std::string::npos)
+                {
+                    os << "HTTP/1.1 304 Not Modified\r\n"
+                       << "ETag: " << etag << "\r\n\r\n";
+                    herdstat::util::MutexLock lock(_mutex);
+                    ++_not_modified;
+                }
+                else
+                {
+                    os << "HTTP/1.1 " << status << "\r\n";
+                    if (f)
+                        os << "ETag: " << etag << "\r\n";
+                    if (f and gzip)
+                    {
+                        os << "Content-Encoding: gzip\r\n";
+                        body = fetcher_test_gzip(body);
+                    }
+
+                    if (chunked)
+                    {
+                        /* in two chunks */
+                        const std::string::size_type half = body.size() / 2;
+                        os << "Transfer-Encoding: chunked\r\n\r\n"
+                           << std::hex << half << "\r\n"
+                           << body.substr(0, half) << "\r\n"
+                           << (body.size() - half) << "\r\n"
+                           << body.substr(half) << "\r\n0\r\n\r\n";
+                    }
+                    else
+                        os << "Content-Length: " << body.size()
+                           << "\r\n\r\n"
+                           << (cut ? body.substr(0, body.size() / 2) : body);
+                }
+
+                if (not this->send(conn, os.str()) or cut)
+                    return false;
+            }
+
+            return true;
+        }
+
+        static bool send(int conn, const std::string& resp)
+        {
+            return (write(conn, resp.data(), resp.size()) ==
+                    static_cast<ssize_t>(resp.size()));
+        }
+
+        int _fd;
+        int _wake[2];
+        unsigned short _port;
+        mutable herdstat::util::Mutex _mutex;
+        unsigned int _accepted;
+        unsigned int _not_modified;
+        /* requests for each /flaky/ and /cut/ path (only used by the server
+         * thread) */
+        std::map<std::string, unsigned int> _flaky;
+};
+
+static std::string
+fetcher_test_read(const std::string& path)
+{
+    std::string body;
+    std::ifstream f(path.c_str());
+    std::getline(f, body);
+    return body;
+}
+
+/* receives documents, rejecting them unless told otherwise */
+class FetcherTestSink : public herdstat::FetchSink
+{
+    public:
+        explicit FetcherTestSink(bool accept)
+            : _accept(accept), _received(0), _attempts(0) { }
+
+        virtual void begin()
+        {
+            _received = 0;
+            ++_attempts;
+        }
+
+        virtual bool write(const char *data LIBHERDSTAT_UNUSED,
+                           std::size_t len)
+        {
+            _received += len;
+            return true;
+        }
+
+        virtual bool finish() { return _accept; }
+
+        std::size_t received() const { return _received; }
+        unsigned int attempts() const { return _attempts; }
+
+    private:
+        const bool _accept;
+        std::size_t _received;
+        unsigned int _attempts;
+};
+
+/* number of files in dir whose name ends with suffix */
+static std::size_t
+fetcher_test_count(const std::string& dir, const std::string& suffix)
+{
+    std::size_t n = 0;
+    const herdstat::util::Directory d(dir);
+    herdstat::util::Directory::const_iterator i;
+    for (i = d.begin() ; i != d.end() ; ++i)
+    {
+        if (i->size() >= suffix.size() and
+            i->compare(i->size() - suffix.size(), suffix.size(), suffix) == 0)
+            ++n;
+    }
+    return n;
+}
+
+/* fetches a URL to a path, like a project XML */
+class FetcherTestFetchable : public herdstat::Fetchable
+{
+    public:
+        FetcherTestFetchable(const std::string& url,
+                             const herdstat::FetcherOptions& opts)
+            : _url(url), _mutex(), _calls(0) { this->set_options(opts); }
+
+        ~FetcherTestFetchable() throw() { this->wait_fetch(); }
+
+        /* number of do_fetch() calls so far */
+        unsigned int calls() const
+        {
+            herdstat::util::MutexLock lock(_mutex);
+            return _calls;
+        }
+
+    protected:
+        virtual void do_fetch(const std::string& path) const
+            throw (herdstat::FetchException)
+        {
+            {
+                herdstat::util::MutexLock lock(_mutex);
+                ++_calls;
+            }
+
+            this->fetcher()(_url, path);
+        }
+
+    private:
+        void set_options(const herdstat::FetcherOptions& opts)
+        { const_cast<herdstat::Fetcher&>(this->fetcher()).set_options(opts); }
+
+        const std::string _url;
+        mutable herdstat::util::Mutex _mutex;
+        mutable unsigned int _calls;
+};
+
+/* calls fetch() from another thread */
+class FetcherTestCaller : public herdstat::util::Thread
+{
+    public:
+        FetcherTestCaller(const herdstat::Fetchable& f, const std::string& p)
+            : _fetchable(f), _path(p) { }
+
+        ~FetcherTestCaller() throw() { }
+
+    protected:
+        virtual void run() { _fetchable.fetch(_path); }
+
+    private:
+        const herdstat::Fetchable& _fetchable;
+        const std::string _path;
+};
+
+/* does path start with the gzip magic? */
+static bool
+gzip_magic(const std::string& path)
+{
+    char magic[2] = { 0, 0 };
+    std::ifstream f(path.c_str(), std::ios::binary);
+    f.read(magic, sizeof(magic));
+    return (magic[0] == '\x1f' and magic[1] == '\x8b');
+}
+
+static void
+fetcher_test_run(const std::string& imp)
+{
+    std::cout << "=== " << imp << " ===" << std::endl;
+
+    const char * const files[] = { "a", "b", "c", "d", "e", "f" };
+    const std::size_t nfiles = sizeof(files) / sizeof(files[0]);
+
+    for (std::size_t i = 0 ; i < nfiles ; ++i)
+    {
+        std::ofstream f((std::string(FETCHER_TEST_WWW"/")+files[i]).c_str());
+        f << "contents of " << files[i] << std::endl;
+    }
+
+    FetcherTestServer server;
+    server.start();
+
+    std::ostringstream base;
+    base << "http://127.0.0.1:" << server.port() << "/";
+
+    herdstat::FetcherOptions opts(imp);
+
+    /* one Fetcher per file, like one Fetchable per project XML */
+    for (std::size_t i = 0 ; i < nfiles ; ++i)
+    {
+        const herdstat::Fetcher fetcher(opts);
+        const std::string path(std::string(FETCHER_TEST_OUT"/")+files[i]);
+        fetcher(base.str()+files[i], path);
+    }
+
+    std::cout << "Connections for " << nfiles << " fetches: "
+        << server.accepted() << std::endl;
+
+    /* refetch; nothing has changed, so all should be kept and touched */
+    const std::time_t old = std::time(NULL) - 3600;
+    bool touched = true, kept = true;
+    for (std::size_t i = 0 ; i < nfiles ; ++i)
+    {
+        const std::string path(std::string(FETCHER_TEST_OUT"/")+files[i]);
+        struct utimbuf times = { old, old };
+        utime(path.c_str(), &times);
+
+        const herdstat::Fetcher fetcher(opts);
+        fetcher(base.str()+files[i], path);
+
+        touched = touched and herdstat::util::Stat(path).mtime() > old;
+        kept = kept and (fetcher_test_read(path) ==
+            std::string("contents of ")+files[i]);
+    }
+
+    std::cout << "Not modified on refetch: " << server.not_modified()
+        << std::endl;
+    std::cout << "Touched: " << (touched ? "yes" : "no") << std::endl;
+    std::cout << "Kept: " << (kept ? "yes" : "no") << std::endl;
+
+    /* change one on the server */
+    {
+        std::ofstream f(FETCHER_TEST_WWW"/c");
+        f << "new contents of c" << std::endl;
+    }
+
+    {
+        const herdstat::Fetcher fetcher(opts);
+        fetcher(base.str()+"c", FETCHER_TEST_OUT"/c");
+    }
+
+    std::cout << "Changed: " << fetcher_test_read(FETCHER_TEST_OUT"/c")
+        << std::endl;
+
+    /* a receiver that rejects the document keeps the old copy */
+    {
+        std::ofstream f(FETCHER_TEST_OUT"/e");
+        f << "stale contents of e" << std::endl;
+    }
+
+    for (int accept = 0 ; accept < 2 ; ++accept)
+    {
+        const std::string path(FETCHER_TEST_OUT"/e");
+        unlink(herdstat::Validators::path_for(path).c_str());
+
+        FetcherTestSink sink(accept);
+        herdstat::FetchRequest req(base.str()+"e", path);
+        req.sink = &sink;
+
+        const herdstat::Fetcher fetcher(opts);
+        fetcher(req);
+
+        std::cout << (accept ? "Accepted: " : "Rejected: ")
+            << (req.ok ? "ok" : "failed") << ", received "
+            << sink.received() << " bytes, " << fetcher_test_read(path)
+            << std::endl;
+    }
+
+    std::cout << "Temporary files left: "
+        << fetcher_test_count(FETCHER_TEST_OUT, ".tmp") << std::endl;
+
+    for (std::size_t i = 0 ; i < nfiles ; ++i)
+    {
+        const std::string path(std::string(FETCHER_TEST_OUT"/")+files[i]);
+        unlink(path.c_str());
+        unlink(herdstat::Validators::path_for(path).c_str());
+    }
+
+    herdstat::FetchRequests requests;
+    for (std::size_t i = 0 ; i < nfiles ; ++i)
+        requests.push_back(herdstat::FetchRequest(base.str()+files[i],
+            std::string(FETCHER_TEST_OUT"/")+files[i]));
+    requests.push_back(herdstat::FetchRequest(base.str()+"chunked/b",
+        FETCHER_TEST_OUT"/chunked"));
+    requests.push_back(herdstat::FetchRequest(base.str()+"redirect/d",
+        FETCHER_TEST_OUT"/redirect"));
+    requests.push_back(herdstat::FetchRequest(base.str()+"gzip/e",
+        FETCHER_TEST_OUT"/gzip"));
+    requests.push_back(herdstat::FetchRequest(base.str()+"missing",
+        FETCHER_TEST_OUT"/missing"));
+    requests.push_back(herdstat::FetchRequest(base.str()+"a",
+        "fetcher-test-nonexistent/a"));
+
+    opts.set_max_parallel(2);
+
+    const herdstat::Fetcher fetcher(opts);
+    fetcher.fetch_all(requests);
+
+    /* where the time went */
+    {
+        const herdstat::FetchStat total(fetcher.stats().total());
+        herdstat::FetchStats::container_type urls(fetcher.stats().by_url());
+        std::ostringstream json;
+        fetcher.stats().dump_json(json);
+
+        std::cout << "Stats: " << total.fetches << " fetches, "
+            << total.failures << " failures, " << urls.size() << " URLs, "
+            << urls[base.str()+"a"].timing.bytes << " bytes of a, timed: "
+            << (total.timing.total > 0 and
+                total.slowest <= total.timing.total ? "yes" : "no")
+            << ", JSON: "
+            << (json.str().compare(0, 14, "{\"fetches\":11,") == 0 and
+                json.str().find("\"url\":\""+base.str()+"missing\"") !=
+                    std::string::npos ? "yes" : "no") << std::endl;
+    }
+
+    herdstat::FetchRequests::iterator r;
+
+    /* duplicates are fetched once, and transient failures retried */
+    herdstat::FetchScheduler& scheduler(herdstat::GlobalFetchScheduler());
+    scheduler.reset_counters();
+    opts.set_retry_delay(10);
+
+    herdstat::FetchRequests dups;
+    dups.push_back(herdstat::FetchRequest(base.str()+"flaky/f",
+        FETCHER_TEST_OUT"/flaky"));
+    dups.push_back(herdstat::FetchRequest(base.str()+"flaky/f",
+        FETCHER_TEST_OUT"/flaky.copy"));
+    herdstat::Fetcher(opts).fetch_all(dups);
+
+    const herdstat::FetchCounters counters(scheduler.counters());
+    std::cout << "Scheduler: " << counters.requests << " requests, "
+        << counters.retries << " retries, " << counters.coalesced
+        << " coalesced, " << counters.bytes << " bytes" << std::endl;
+
+    for (r = dups.begin() ; r != dups.end() ; ++r)
+    {
+        std::cout << r->path << ": " << (r->ok ? "ok, " : "failed, ")
+            << fetcher_test_read(r->path) << std::endl;
+        unlink(r->path.c_str());
+        unlink(herdstat::Validators::path_for(r->path).c_str());
+    }
+
+    /* a retry after the body was cut short starts the sink over */
+    {
+        FetcherTestSink sink(true);
+        herdstat::FetchRequests cut;
+        cut.push_back(herdstat::FetchRequest(base.str()+"cut/f",
+            FETCHER_TEST_OUT"/cut"));
+        cut.front().sink = &sink;
+        herdstat::Fetcher(opts).fetch_all(cut);
+
+        std::cout << "Cut short: " << (cut.front().ok ? "ok" : "failed")
+            << ", " << sink.attempts() << " attempts, received "
+            << sink.received() << " bytes, "
+            << fetcher_test_read(cut.front().path) << std::endl;
+        unlink(cut.front().path.c_str());
+        unlink(herdstat::Validators::path_for(cut.front().path).c_str());
+    }
+
+    /* fetched in the background */
+    {
+        FetcherTestFetchable good(base.str()+"a", opts);
+        FetcherTestFetchable bad(base.str()+"missing", opts);
+        const herdstat::FetchHandle g(good.fetch_async(FETCHER_TEST_OUT"/async"));
+        const herdstat::FetchHandle b(bad.fetch_async(FETCHER_TEST_OUT"/bad"));
+
+        g.wait();
+        std::cout << "Async: " << (good.fetched() ? "fetched" : "not fetched")
+            << ", " << fetcher_test_read(FETCHER_TEST_OUT"/async") << std::endl;
+
+        try
+        {
+            b.wait();
+            std::cout << "Async failure: none" << std::endl;
+        }
+        catch (const herdstat::FetchException&)
+        {
+            std::cout << "Async failure: "
+                << (bad.fetched() ? "fetched" : "not fetched") << std::endl;
+        }
+
+        unlink(FETCHER_TEST_OUT"/async");
+        unlink(herdstat::Validators::path_for(FETCHER_TEST_OUT"/async").c_str());
+    }
+
+    /* fetches from several threads at once share one do_fetch() */
+    {
+        const std::string path(FETCHER_TEST_OUT"/shared");
+        FetcherTestFetchable shared(base.str()+"b", opts);
+        FetcherTestCaller caller(shared, path);
+        caller.start();
+        shared.fetch(path);
+        shared.fetch_async(path).wait();
+        caller.join();
+
+        std::cout << "Shared: " << shared.calls() << " do_fetch(), "
+            << fetcher_test_read(path) << std::endl;
+        unlink(path.c_str());
+        unlink(herdstat::Validators::path_for(path).c_str());
+    }
+
+    /* stored compressed */
+    {
+        const std::string path(FETCHER_TEST_OUT"/compressed");
+        herdstat::FetcherOptions copts(opts);
+        copts.set_compress(true);
+        const herdstat::Fetcher cfetcher(copts);
+        cfetcher(base.str()+"f", path);
+
+        char line[64] = "";
+        gzFile gz = gzopen(path.c_str(), "rb");
+        gzgets(gz, line, sizeof(line));
+        gzclose(gz);
+
+        std::cout << "Compressed: " << (gzip_magic(path) ? "yes" : "no")
+            << ", " << line;
+        unlink(path.c_str());
+        unlink(herdstat::Validators::path_for(path).c_str());
+    }
+
+    server.stop();
+
+    for (r = requests.begin() ; r != requests.end() ; ++r)
+    {
+        std::cout << r->path << ": ";
+
+        if (not r->ok)
+        {
+            std::cout << "failed (" <<
+                (r->error.empty() ? "no" : "has") << " error)" << std::endl;
+            if (herdstat::util::is_file(r->path))
+                std::cout << "  left behind" << std::endl;
+            continue;
+        }
+
+        std::cout << "ok, " << fetcher_test_read(r->path) << std::endl;
+
+        unlink(r->path.c_str());
+        unlink(herdstat::Validators::path_for(r->path).c_str());
+    }
+
+    for (std::size_t i = 0 ; i < nfiles ; ++i)
+        unlink((std::string(FETCHER_TEST_WWW"/")+files[i]).c_str());
+}
+
+void
+FetcherTest::operator()(const opts_type& null LIBHERDSTAT_UNUSED) const
+{
+    mkdir(FETCHER_TEST_WWW, 0755);
+    mkdir(FETCHER_TEST_OUT, 0755);
+
+    fetcher_test_run("http");
+#ifdef HAVE_LIBCURL
+    fetcher_test_run("curl");
+#endif
+
+    rmdir(FETCHER_TEST_WWW);
+    rmdir(FETCHER_TEST_OUT);
+}
+
+#endif /* _HAVE_SRC_FETCHER_TEST_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -27,6 +27,8 @@
 # include "config.h"
 #endif
 
+#include <fstream>
+#include <iterator>
 #include <herdstat/util/algorithm.hh>
 #include <herdstat/util/functional.hh>
 #include <herdstat/util/file.hh>
@@ -96,6 +98,14 @@ struct ShowDirectory
     }
 };
 
+static std::string
+file_test_read(const char *path)
+{
+    std::ifstream f(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(f),
+                       std::istreambuf_iterator<char>());
+}
+
 void
 FileTest::operator()(const opts_type& opts) const 
 {
@@ -117,6 +127,30 @@ FileTest::operator()(const opts_type& opts) const
     const herdstat::util::Directory copy(dir);
     assert(copy.size() == dir.size());
     show(copy, portdir);
+
+    /* contents must survive copying/moving byte for byte */
+    const std::string contents("line 1\r\nline 2\n\n\tno newline");
+    {
+        std::ofstream f("file-test.orig", std::ios::binary);
+        f << contents;
+    }
+
+    herdstat::util::copy_file("file-test.orig", "file-test.copy");
+    herdstat::util::copy_file_atomic("file-test.orig", "file-test.atomic");
+    herdstat::util::move_file("file-test.atomic", "file-test.moved");
+
+    std::cout << std::endl << "Testing util::copy_file/move_file:"
+        << std::endl
+        << " copy: " << (file_test_read("file-test.copy") == contents ?
+            "identical" : "differs") << std::endl
+        << " atomic copy + move: " << (file_test_read("file-test.moved") ==
+            contents ? "identical" : "differs") << std::endl
+        << " source moved: " << (herdstat::util::file_exists(
+            "file-test.atomic") ? "no" : "yes") << std::endl;
+
+    unlink("file-test.orig");
+    unlink("file-test.copy");
+    unlink("file-test.moved");
 }
 
 #endif /* _HAVE_SRC_FILE_TEST_HH */
@@ -62,6 +62,35 @@ HerdsXMLTest::operator()(const opts_type& opts) const
 
     std::cout << i->name() << "(" << i->size() << ")" << std::endl;
     std::for_each(i->begin(), i->end(), DisplayDev());
+
+    herdstat::portage::Developer dev("ka0ttic");
+    herds_xml.fill_developer(dev);
+    std::cout << "ka0ttic in shell-tools: " <<
+        (std::find(dev.herds().begin(), dev.herds().end(),
+            "shell-tools") != dev.herds().end() ? "yes" : "no") << std::endl;
+
+    herdstat::portage::Developer nobody("nobody-at-all");
+    herds_xml.fill_developer(nobody);
+    std::cout << "nobody-at-all herds: " << nobody.herds().size() << std::endl;
+
+    /* the developer index doesn't point into herds(), so erasing a herd
+     * leaves it intact (until the next parse()) */
+    herds_xml.herds().erase(herds_xml.herds().find("shell-tools"));
+    herdstat::portage::Developer dev2("ka0ttic");
+    herds_xml.fill_developer(dev2);
+    std::cout << "ka0ttic in shell-tools after erasing it: " <<
+        (std::find(dev2.herds().begin(), dev2.herds().end(),
+            "shell-tools") != dev2.herds().end() ? "yes" : "no") << std::endl;
+
+    /* query mode only parses the given herd */
+    herdstat::portage::HerdsXML query;
+    query.set_query("shell-tools");
+    query.parse(opts.front());
+    std::cout << "Query size: " << query.herds().size() << std::endl;
+
+    i = query.herds().find("shell-tools");
+    assert(i != query.herds().end());
+    std::cout << i->name() << "(" << i->size() << ")" << std::endl;
 }
 
 #endif /* _HAVE__HERDS.XML_TEST_HH */
@@ -0,0 +1,126 @@
+/*
+ * libherdstat -- tests/src/metadata_index-test.hh
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE__METADATA_INDEX_TEST_HH
+#define _HAVE__METADATA_INDEX_TEST_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cstdio>
+#include <herdstat/portage/metadata_index.hh>
+#include "test_handler.hh"
+
+DECLARE_TEST_HANDLER(MetadataIndexTest)
+
+void
+MetadataIndexTest::operator()(const opts_type& null LIBHERDSTAT_UNUSED) const
+{
+    herdstat::portage::MetadataIndex index(false);
+    index.fill(4);
+
+    const herdstat::portage::MetadataIndex::const_iterator i =
+        index.find("app-misc/foo");
+    assert(i != index.end());
+
+    std::cout << i->pkg << std::endl;
+    std::cout << "herds: ";
+    std::copy(i->herds.begin(), i->herds.end(),
+        std::ostream_iterator<std::string>(std::cout, " "));
+    std::cout << std::endl << "devs: ";
+    std::copy(i->devs.begin(), i->devs.end(),
+        std::ostream_iterator<std::string>(std::cout, " "));
+    std::cout << std::endl;
+
+    std::cout << "app-misc/nonexistent: "
+        << (index.find("app-misc/nonexistent") == index.end() ?
+            "not found" : "found") << std::endl;
+
+    /* a single worker must produce the same table */
+    herdstat::portage::MetadataIndex serial(false);
+    serial.fill(1);
+
+    bool same = (serial.size() == index.size());
+    for (std::size_t n = 0 ; same and n < index.size() ; ++n)
+        same = (serial[n].pkg == index[n].pkg and
+                serial[n].herds == index[n].herds and
+                serial[n].devs == index[n].devs);
+
+    std::cout << "serial/parallel match: " << (same ? "yes" : "no")
+        << std::endl;
+
+    /* reverse lookups */
+    const std::size_t id = i - index.begin();
+    const herdstat::portage::MetadataIndex::ids_type&
+        herd(index.herd_packages("foo")),
+        dev(index.dev_packages("ka0ttic@gentoo.org"));
+
+    std::cout << "herd foo maintains app-misc/foo: "
+        << (std::binary_search(herd.begin(), herd.end(), id) ? "yes" : "no")
+        << std::endl;
+    std::cout << "dev ka0ttic maintains app-misc/foo: "
+        << (std::binary_search(dev.begin(), dev.end(), id) ? "yes" : "no")
+        << std::endl;
+
+    /* a maintainer elsewhere with the same user name is someone else */
+    const herdstat::portage::MetadataIndex::ids_type&
+        user(index.user_packages("ka0ttic")),
+        other(index.dev_packages("KA0TTIC@example.org"));
+    std::cout << "user ka0ttic maintains app-misc/foo: "
+        << (std::binary_search(user.begin(), user.end(), id) ? "yes" : "no")
+        << std::endl;
+    std::cout << "ka0ttic@example.org maintains app-misc/foo: "
+        << (std::binary_search(other.begin(), other.end(), id) ? "yes" : "no")
+        << std::endl;
+
+    /* the first fill writes the cache, the second parses nothing */
+    const std::string cache("metadata_index.cache");
+    std::remove(cache.c_str());
+
+    herdstat::portage::MetadataIndex first(false);
+    first.set_cache(cache);
+    first.fill();
+    std::cout << "parsed everything without cache: "
+        << (first.parsed() == first.size() ? "yes" : "no") << std::endl;
+
+    herdstat::portage::MetadataIndex second(false);
+    second.set_cache(cache);
+    second.fill();
+    std::cout << "parsed with up-to-date cache: " << second.parsed()
+        << std::endl;
+
+    same = (second.size() == index.size());
+    for (std::size_t n = 0 ; same and n < index.size() ; ++n)
+        same = (second[n].pkg == index[n].pkg and
+                second[n].herds == index[n].herds and
+                second[n].devs == index[n].devs);
+
+    std::cout << "cached/parsed match: " << (same ? "yes" : "no")
+        << std::endl;
+
+    std::remove(cache.c_str());
+}
+
+#endif /* _HAVE__METADATA_INDEX_TEST_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
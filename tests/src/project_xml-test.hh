@@ -0,0 +1,200 @@
+/*
+ * libherdstat -- tests/src/project_xml-test.hh
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_SRC_PROJECT_XML_TEST_HH
+#define _HAVE_SRC_PROJECT_XML_TEST_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <fstream>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <utime.h>
+#include <herdstat/xml/init.hh>
+#include <herdstat/portage/project_xml.hh>
+#include <herdstat/portage/project_resolver.hh>
+#include <herdstat/portage/project_cache.hh>
+#include "test_handler.hh"
+
+DECLARE_TEST_HANDLER(ProjectXMLTest)
+
+#define PROJECT_XML_TEST_CVSDIR "project_xml-test-cvs"
+#define PROJECT_XML_TEST_HTDOCS PROJECT_XML_TEST_CVSDIR"/gentoo/xml/htdocs"
+
+static const char * const project_xml_test_files[][2] = {
+    /* a inherits b and c; d is not inherited */
+    { "a.xml",
+      "<project>\n"
+      "  <dev description=\"Lead\">Alice</dev>\n"
+      "  <subproject inheritmembers=\"yes\" ref=\"/b.xml\"/>\n"
+      "  <subproject inheritmembers=\"yes\" ref=\"/c.xml\"/>\n"
+      "  <subproject ref=\"/d.xml\"/>\n"
+      "  <task><dev>taskdev</dev></task>\n"
+      "  <dev>bob</dev>\n"
+      "</project>\n" },
+    /* b inherits a (cycle) and e */
+    { "b.xml",
+      "<project>\n"
+      "  <dev description=\"B member\">bob</dev>\n"
+      "  <dev description=\"B role\">alice</dev>\n"
+      "  <subproject inheritmembers=\"yes\" ref=\"/a.xml\"/>\n"
+      "  <subproject inheritmembers=\"yes\" ref=\"/e.xml\"/>\n"
+      "</project>\n" },
+    /* c inherits e too (diamond) and a missing project; its <dev> text may
+     * be delivered in several chunks */
+    { "c.xml",
+      "<project>\n"
+      "  <dev>car&#111;l</dev>\n"
+      "  <subproject inheritmembers=\"yes\" ref=\"/e.xml\"/>\n"
+      "  <subproject inheritmembers=\"yes\" ref=\"/missing.xml\"/>\n"
+      "</project>\n" },
+    { "d.xml",
+      "<project>\n"
+      "  <dev>dave</dev>\n"
+      "</project>\n" },
+    { "e.xml",
+      "<project>\n"
+      "  <dev description=\"E\">eve</dev>\n"
+      "</project>\n" }
+};
+
+static const std::size_t project_xml_test_nfiles =
+    sizeof(project_xml_test_files) / sizeof(project_xml_test_files[0]);
+
+static void
+project_xml_test_dump(const herdstat::portage::Herd& devs)
+{
+    herdstat::portage::Herd::const_iterator i;
+    for (i = devs.begin() ; i != devs.end() ; ++i)
+        std::cout << "  " << i->user() << " '" << i->role() << "'" << std::endl;
+}
+
+void
+ProjectXMLTest::operator()(const opts_type& null LIBHERDSTAT_UNUSED) const
+{
+    herdstat::xml::GlobalInit();
+
+    mkdir(PROJECT_XML_TEST_CVSDIR, 0755);
+    mkdir(PROJECT_XML_TEST_CVSDIR"/gentoo", 0755);
+    mkdir(PROJECT_XML_TEST_CVSDIR"/gentoo/xml", 0755);
+    mkdir(PROJECT_XML_TEST_HTDOCS, 0755);
+
+    std::size_t n;
+    for (n = 0 ; n < project_xml_test_nfiles ; ++n)
+    {
+        const std::string path(std::string(PROJECT_XML_TEST_HTDOCS"/")+
+            project_xml_test_files[n][0]);
+        std::ofstream f(path.c_str());
+        f << project_xml_test_files[n][1];
+    }
+
+    const std::string cvsdir(PROJECT_XML_TEST_CVSDIR);
+
+    {
+        const herdstat::portage::ProjectXML project("/a.xml", cvsdir, false,
+                                                    false);
+        std::cout << "a.xml (not inherited):" << std::endl;
+        project_xml_test_dump(project.devs());
+
+        std::cout << "members:" << std::endl;
+        herdstat::portage::ProjectXML::members_type::const_iterator i;
+        for (i = project.members().begin() ;
+             i != project.members().end() ; ++i)
+        {
+            if (i->subproject.empty())
+                std::cout << "  dev " << i->dev.user() << std::endl;
+            else
+                std::cout << "  subproject " << i->subproject << std::endl;
+        }
+    }
+
+    {
+        const herdstat::portage::ProjectXML project("/a.xml", cvsdir, false);
+        std::cout << "a.xml:" << std::endl;
+        project_xml_test_dump(project.devs());
+    }
+
+    /* same result no matter how many workers */
+    const unsigned int jobs[] = { 1, 4 };
+    for (n = 0 ; n < 2 ; ++n)
+    {
+        herdstat::portage::ProjectResolver resolver(cvsdir, false);
+        resolver.add("/c.xml");
+        resolver.add("/b.xml");
+        resolver.add("/c.xml");
+        resolver.resolve(jobs[n]);
+
+        std::cout << "resolver (" << jobs[n] << " jobs):" << std::endl;
+
+        herdstat::portage::Herd b, c;
+        resolver.merge("/b.xml", b);
+        resolver.merge("/c.xml", c);
+        std::cout << " b.xml:" << std::endl;
+        project_xml_test_dump(b);
+        std::cout << " c.xml:" << std::endl;
+        project_xml_test_dump(c);
+    }
+
+    /* everything but missing.xml should be cached by now */
+    herdstat::portage::ProjectCache& cache(
+        herdstat::portage::GlobalProjectCache());
+    std::cout << "cached: " << cache.size() << std::endl;
+
+    /* modified files are parsed again */
+    {
+        const std::string path(PROJECT_XML_TEST_HTDOCS"/e.xml");
+        const herdstat::util::Stat st(path);
+
+        std::ofstream f(path.c_str());
+        f << "<project>\n"
+          << "  <dev description=\"E changed\">eve</dev>\n"
+          << "  <dev>frank</dev>\n"
+          << "</project>\n";
+        f.close();
+
+        struct utimbuf times;
+        times.actime = times.modtime = st.mtime() + 10;
+        utime(path.c_str(), &times);
+
+        const herdstat::portage::ProjectXML project("/c.xml", cvsdir, false);
+        std::cout << "c.xml (e.xml modified):" << std::endl;
+        project_xml_test_dump(project.devs());
+    }
+
+    cache.clear();
+    std::cout << "cached after clear(): " << cache.size() << std::endl;
+
+    for (n = 0 ; n < project_xml_test_nfiles ; ++n)
+        unlink((std::string(PROJECT_XML_TEST_HTDOCS"/")+
+            project_xml_test_files[n][0]).c_str());
+    rmdir(PROJECT_XML_TEST_HTDOCS);
+    rmdir(PROJECT_XML_TEST_CVSDIR"/gentoo/xml");
+    rmdir(PROJECT_XML_TEST_CVSDIR"/gentoo");
+    rmdir(PROJECT_XML_TEST_CVSDIR);
+}
+
+#endif /* _HAVE_SRC_PROJECT_XML_TEST_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
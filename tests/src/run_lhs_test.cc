@@ -44,6 +44,7 @@
 #include "keyword-test.hh"
 #include "license-test.hh"
 #include "ebuild-test.hh"
+#include "eclass_cache-test.hh"
 #include "email-test.hh"
 #include "package_list-test.hh"
 #include "package_finder-test.hh"
@@ -53,6 +54,13 @@
 #include "devaway.xml-test.hh"
 #include "userinfo.xml-test.hh"
 #include "metadata.xml-test.hh"
+#include "metadata_index-test.hh"
+#include "element_table-test.hh"
+#include "saxparser-test.hh"
+#include "snapshot-test.hh"
+#include "serialize-test.hh"
+#include "project_xml-test.hh"
+#include "fetcher-test.hh"
 
 int
 main(int argc, char **argv)
@@ -84,6 +92,7 @@ main(int argc, char **argv)
         tests["keyword"] = new KeywordTest();
         tests["license"] = new LicenseTest();
         tests["ebuild"] = new EbuildTest();
+        tests["eclass_cache"] = new EclassCacheTest();
         tests["email"] = new EmailTest();
         tests["package_list"] = new PackageListTest();
         tests["package_finder"] = new PackageFinderTest();
@@ -93,6 +102,13 @@ main(int argc, char **argv)
         tests["devaway.xml"] = new DevawayXMLTest();
         tests["userinfo.xml"] = new UserinfoXMLTest();
         tests["metadata.xml"] = new MetadataXMLTest();
+        tests["metadata_index"] = new MetadataIndexTest();
+        tests["element_table"] = new ElementTableTest();
+        tests["saxparser"] = new SAXParserTest();
+        tests["snapshot"] = new SnapshotTest();
+        tests["serialize"] = new SerializeTest();
+        tests["project_xml"] = new ProjectXMLTest();
+        tests["fetcher"] = new FetcherTest();
 
         TestHandler *test = tests[test_id];
         if (not test)
@@ -0,0 +1,215 @@
+/*
+ * libherdstat -- tests/src/saxparser-test.hh
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE_SRC_SAXPARSER_TEST_HH
+#define _HAVE_SRC_SAXPARSER_TEST_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <map>
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+#include <zlib.h>
+#include <herdstat/xml/init.hh>
+#include <herdstat/xml/saxparser.hh>
+#include "test_handler.hh"
+
+DECLARE_TEST_HANDLER(SAXParserTest)
+
+/* Prints events.  Adjacent text is joined since backends may deliver it in
+ * several chunks. */
+class EventPrinter : public herdstat::xml::SAXHandler
+{
+    public:
+        EventPrinter(bool stop) : _stop(stop), _text() { }
+
+    protected:
+        enum { HERDS = 1, HERD, NAME, DESC, STOP };
+
+        virtual const herdstat::xml::ElementTable& elements() const
+        {
+            static const herdstat::xml::ElementTableEntry entries[] = {
+                { "herds", HERDS }, { "herd", HERD }, { "name", NAME },
+                { "desc", DESC }, { "stop", STOP }
+            };
+            static const herdstat::xml::ElementTable table(entries, 5);
+            return table;
+        }
+
+        virtual bool start_element(herdstat::xml::element_id id,
+                                   const attrs_type& attrs)
+        {
+            flush();
+            std::cout << "start " << id;
+
+            std::map<std::string, std::string> sorted;
+            attrs_type::const_iterator i;
+            for (i = attrs.begin() ; i != attrs.end() ; ++i)
+                sorted[i->first.str()] = i->second.str();
+            std::map<std::string, std::string>::iterator a;
+            for (a = sorted.begin() ; a != sorted.end() ; ++a)
+                std::cout << " " << a->first << "='" << a->second << "'";
+            std::cout << std::endl;
+
+            return not (_stop and id == STOP);
+        }
+
+        virtual bool end_element(herdstat::xml::element_id id)
+        {
+            flush();
+            std::cout << "end " << id << std::endl;
+            return true;
+        }
+
+        virtual bool do_text(const herdstat::util::StringView& text)
+        {
+            text.append_to(_text);
+            return true;
+        }
+
+    private:
+        void flush()
+        {
+            if (not _text.empty())
+                std::cout << "text '" << _text << "'" << std::endl;
+            _text.clear();
+        }
+
+        bool _stop;
+        std::string _text;
+};
+
+static void
+parse_with(const std::string& backend, const std::string& path, bool stop)
+{
+    EventPrinter printer(stop);
+    const std::auto_ptr<herdstat::xml::SAXParser>
+        parser(herdstat::xml::SAXParser::create(&printer, backend));
+
+    try
+    {
+        parser->parse(path);
+        std::cout << "ok" << std::endl;
+    }
+    catch (const herdstat::xml::ParserException&)
+    {
+        std::cout << "parser error" << std::endl;
+    }
+}
+
+/* feed the document a byte at a time; events that arrive before
+ * parse_finish() are printed before "finish" */
+static void
+parse_chunks_with(const std::string& backend, const std::string& doc,
+                  bool stop)
+{
+    EventPrinter printer(stop);
+    const std::auto_ptr<herdstat::xml::SAXParser>
+        parser(herdstat::xml::SAXParser::create(&printer, backend));
+    parser->set_document("chunked");
+
+    try
+    {
+        std::string::size_type i;
+        for (i = 0 ; i < doc.size() ; ++i)
+        {
+            if (not parser->parse_chunk(doc.data() + i, 1))
+                break;
+        }
+
+        std::cout << "finish" << std::endl;
+        parser->parse_finish();
+        std::cout << "ok" << std::endl;
+    }
+    catch (const herdstat::xml::ParserException& e)
+    {
+        std::cout << "parser error in " << e.file() << std::endl;
+    }
+}
+
+void
+SAXParserTest::operator()(const opts_type& null LIBHERDSTAT_UNUSED) const
+{
+    herdstat::xml::GlobalInit();
+
+    const std::string good("saxparser-test.xml");
+    const std::string bad("saxparser-test-bad.xml");
+    const std::string compressed("saxparser-test.xml.gz");
+
+    std::ostringstream goodf;
+    goodf
+        << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        << "<!DOCTYPE herds [ <!ELEMENT herds ANY> ]>\n"
+        << "<!-- a comment -->\n"
+        << "<herds>\n"
+        << "  <herd name=\"a &amp; b\" empty=''/>\n"
+        << "  <herd>\n"
+        << "    <name>Tom &lt;&#65;&#x42;&gt;</name>\n"
+        << "    <desc><![CDATA[<raw> & stuff]]></desc>\n"
+        << "    <unknown>x</unknown>\n"
+        << "    <stop/>\n"
+        << "  </herd>\n"
+        << "</herds>\n";
+
+    std::ofstream plain(good.c_str());
+    plain << goodf.str();
+    plain.close();
+
+    /* the same document, gzip-compressed */
+    gzFile gz = gzopen(compressed.c_str(), "wb");
+    gzwrite(gz, goodf.str().data(), goodf.str().size());
+    gzclose(gz);
+
+    const std::string baddoc("<herds>\n  <herd>\n  </herds>\n</herd>\n");
+    std::ofstream badf(bad.c_str());
+    badf << baddoc;
+    badf.close();
+
+    const char *backends[] = { "xmlwrapp", "fast" };
+    for (std::size_t i = 0 ; i < 2 ; ++i)
+    {
+        std::cout << "Backend: " << backends[i] << std::endl;
+        parse_with(backends[i], good, false);
+        parse_with(backends[i], good, true);
+        parse_with(backends[i], bad, false);
+        parse_with(backends[i], compressed, false);
+        parse_with(backends[i], compressed, true);
+    }
+
+    std::cout << "Backend: fast (chunked)" << std::endl;
+    parse_chunks_with("fast", goodf.str(), false);
+    parse_chunks_with("fast", goodf.str(), true);
+    parse_chunks_with("fast", baddoc, false);
+    parse_chunks_with("fast", "<herds><herd>", false);
+
+    unlink(good.c_str());
+    unlink(bad.c_str());
+    unlink(compressed.c_str());
+}
+
+#endif /* _HAVE_SRC_SAXPARSER_TEST_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,182 @@
+/*
+ * libherdstat -- tests/src/serialize-test.hh
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE__SERIALIZE_TEST_HH
+#define _HAVE__SERIALIZE_TEST_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cstdio>
+#include <map>
+#include <herdstat/util/container_base.hh>
+#include <herdstat/portage/serialize.hh>
+#include "test_handler.hh"
+
+DECLARE_TEST_HANDLER(SerializeTest)
+
+class SerializeTestList : public herdstat::util::VectorBase<std::string>
+{
+    public:
+        SerializeTestList() { }
+        virtual ~SerializeTestList() { }
+};
+
+static herdstat::portage::Developer
+serialize_test_dev(const std::string& user, bool away)
+{
+    herdstat::portage::Developer dev(user, user+"@gentoo.org", "Some One");
+    dev.set_pgpkey("0xDEADBEEF");
+    dev.set_location("Somewhere");
+    dev.set_away(away);
+    if (away)
+        dev.set_awaymsg("On vacation.");
+    dev.append_herd("foo");
+    dev.append_herd("bar");
+    return dev;
+}
+
+void
+SerializeTest::operator()(const opts_type& null LIBHERDSTAT_UNUSED) const
+{
+    namespace io = herdstat::io;
+    namespace portage = herdstat::portage;
+
+    const std::string path("serialize.bin");
+    const uint32_t magic = 0x53455254;
+
+    portage::Herds herds;
+    {
+        portage::Herd herd("foo", "foo@gentoo.org", "The foo herd");
+        herd.insert(serialize_test_dev("alice", false));
+        herd.insert(serialize_test_dev("bob", true));
+        herds.insert(herd);
+        herds.insert(portage::Herd("bar"));
+    }
+
+    portage::Metadata metadata("app-misc/foo");
+    metadata.set_longdesc("Foo does things.");
+    metadata.herds().insert(portage::Herd("foo"));
+    metadata.devs().insert(serialize_test_dev("carol", false));
+
+    const portage::Package pkg("app-misc/foo", "/usr/portage");
+    const portage::VersionString version(
+        "/usr/portage/app-misc/foo-bar/foo-bar-1.2_rc3-r1.ebuild");
+
+    portage::Versions versions;
+    versions.insert(portage::VersionString(
+        "/usr/portage/app-misc/foo/foo-1.2-r0.ebuild"));
+    versions.insert(portage::VersionString(
+        "/usr/portage/app-misc/foo/foo-1.0.ebuild"));
+
+    std::map<std::string, std::vector<int> > map;
+    map["odd"].push_back(1);
+    map["odd"].push_back(3);
+    map["even"].push_back(2);
+
+    SerializeTestList list;
+    list.push_back("first");
+    list.push_back("second");
+
+    {
+        io::BinaryOStream stream(path, magic, 1);
+        io::serialize(stream, herds);
+        io::serialize(stream, metadata);
+        io::serialize(stream, pkg);
+        io::serialize(stream, version);
+        io::serialize(stream, versions);
+        io::serialize(stream, map);
+        io::serialize(stream, std::make_pair(std::string("pair"), 42));
+        io::serialize<herdstat::util::VectorBase<std::string> >(stream, list);
+        const bool closed = stream.close();
+        assert(closed);
+    }
+
+    io::BinaryIStream stream(path, magic, 1);
+    assert(stream);
+
+    portage::Herds herds2;
+    io::deserialize(stream, herds2);
+    std::cout << "herds: " << herds2.size() << std::endl;
+
+    portage::Herds::const_iterator h;
+    for (h = herds2.begin() ; h != herds2.end() ; ++h)
+    {
+        std::cout << "  " << h->name() << " <" << h->email() << "> '"
+            << h->desc() << "': " << h->size() << " developers" << std::endl;
+
+        portage::Herd::const_iterator d;
+        for (d = h->begin() ; d != h->end() ; ++d)
+        {
+            std::cout << "    " << d->user() << " <" << d->email() << "> "
+                << d->name() << ", " << d->pgpkey() << ", " << d->location()
+                << ", away: " << (d->is_away() ? d->awaymsg() : "no")
+                << ", herds: " << d->herds().size() << std::endl;
+        }
+    }
+
+    portage::Metadata metadata2;
+    io::deserialize(stream, metadata2);
+    std::cout << "metadata: " << metadata2.pkg() << " '"
+        << metadata2.longdesc() << "' herds: " << metadata2.herds().size()
+        << " devs: " << metadata2.devs().size() << " ("
+        << metadata2.devs().begin()->user() << ")" << std::endl;
+
+    portage::Package pkg2("dummy/dummy", "/tmp");
+    io::deserialize(stream, pkg2);
+    std::cout << "package: " << pkg2.full() << " in " << pkg2.portdir()
+        << ": " << (pkg2 == pkg ? "equal" : "differs") << std::endl;
+
+    portage::VersionString version2;
+    io::deserialize(stream, version2);
+    std::cout << "version: " << version2.str() << " " << version2.ebuild()
+        << ": " << (version2 == version ? "equal" : "differs") << std::endl;
+
+    portage::Versions versions2;
+    io::deserialize(stream, versions2);
+    std::cout << "versions: " << versions2.front().ebuild() << " "
+        << versions2.back().ebuild() << std::endl;
+
+    std::map<std::string, std::vector<int> > map2;
+    io::deserialize(stream, map2);
+    std::cout << "map: " << (map2 == map ? "equal" : "differs") << std::endl;
+
+    std::pair<std::string, int> pair;
+    io::deserialize(stream, pair);
+    std::cout << "pair: " << pair.first << " " << pair.second << std::endl;
+
+    SerializeTestList list2;
+    io::deserialize<herdstat::util::VectorBase<std::string> >(stream, list2);
+    std::cout << "list: " << list2.size() << " " << list2.front() << " "
+        << list2.back() << std::endl;
+
+    assert(stream);
+    stream >> pair.first;
+    std::cout << "read past end: " << (stream ? "ok" : "failed") << std::endl;
+
+    std::remove(path.c_str());
+}
+
+#endif /* _HAVE__SERIALIZE_TEST_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
@@ -0,0 +1,152 @@
+/*
+ * libherdstat -- tests/src/snapshot-test.hh
+ * $Id$
+ * Copyright (c) 2006 Aaron Walker <ka0ttic@gentoo.org>
+ *
+ * This file is part of libherdstat.
+ *
+ * libherdstat is free software; you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software
+ * Foundation; either version 2 of the License, or (at your option) any later
+ * version.
+ *
+ * libherdstat is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * libherdstat; if not, write to the Free Software Foundation, Inc., 59 Temple
+ * Place, Suite 325, Boston, MA  02111-1257  USA
+ */
+
+#ifndef _HAVE__SNAPSHOT_TEST_HH
+#define _HAVE__SNAPSHOT_TEST_HH 1
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <cstdio>
+#include <herdstat/util/file.hh>
+#include <herdstat/portage/herds_xml.hh>
+#include <herdstat/portage/userinfo_xml.hh>
+#include <herdstat/portage/devaway_xml.hh>
+#include "test_handler.hh"
+
+DECLARE_TEST_HANDLER(SnapshotTest)
+
+static bool
+snapshot_same_devs(const herdstat::portage::Developers& a,
+                   const herdstat::portage::Developers& b)
+{
+    if (a.size() != b.size())
+        return false;
+
+    herdstat::portage::Developers::const_iterator i, j;
+    for (i = a.begin(), j = b.begin() ; i != a.end() ; ++i, ++j)
+    {
+        if (i->user() != j->user() or i->email() != j->email() or
+            i->name() != j->name() or i->pgpkey() != j->pgpkey() or
+            i->joined() != j->joined() or i->birthday() != j->birthday() or
+            i->status() != j->status() or i->role() != j->role() or
+            i->location() != j->location() or i->awaymsg() != j->awaymsg() or
+            i->is_away() != j->is_away() or i->herds() != j->herds())
+            return false;
+    }
+
+    return true;
+}
+
+static bool
+snapshot_same_herds(const herdstat::portage::Herds& a,
+                    const herdstat::portage::Herds& b)
+{
+    if (a.size() != b.size())
+        return false;
+
+    herdstat::portage::Herds::const_iterator i, j;
+    for (i = a.begin(), j = b.begin() ; i != a.end() ; ++i, ++j)
+    {
+        if (i->name() != j->name() or i->email() != j->email() or
+            i->desc() != j->desc() or not snapshot_same_devs(*i, *j))
+            return false;
+    }
+
+    return true;
+}
+
+static void
+snapshot_report(const std::string& path, const std::string& snapshot,
+                bool same)
+{
+    std::cout << path.substr(path.rfind('/') + 1) << ": written: "
+        << (herdstat::util::is_file(snapshot) ? "yes" : "no")
+        << ", loaded matches parsed: " << (same ? "yes" : "no")
+        << std::endl;
+}
+
+void
+SnapshotTest::operator()(const opts_type& opts) const
+{
+    assert(opts.size() == 3);
+
+    herdstat::xml::GlobalInit();
+
+    const std::string snapshot("snapshot.bin");
+    opts_type::const_iterator i = opts.begin();
+
+    /* herds.xml */
+    {
+        std::remove(snapshot.c_str());
+
+        herdstat::portage::HerdsXML parsed;
+        parsed.set_snapshot(snapshot);
+        parsed.parse(*i);
+
+        herdstat::portage::HerdsXML loaded;
+        loaded.set_snapshot(snapshot);
+        loaded.parse(*i);
+
+        snapshot_report(*i++, snapshot,
+            snapshot_same_herds(parsed.herds(), loaded.herds()));
+    }
+
+    /* userinfo.xml */
+    {
+        std::remove(snapshot.c_str());
+
+        herdstat::portage::UserinfoXML parsed;
+        parsed.set_snapshot(snapshot);
+        parsed.parse(*i);
+
+        herdstat::portage::UserinfoXML loaded;
+        loaded.set_snapshot(snapshot);
+        loaded.parse(*i);
+
+        snapshot_report(*i++, snapshot,
+            snapshot_same_devs(parsed.devs(), loaded.devs()));
+    }
+
+    /* devaway.xml */
+    {
+        std::remove(snapshot.c_str());
+
+        herdstat::portage::DevawayXML parsed;
+        parsed.set_snapshot(snapshot);
+        parsed.parse(*i);
+
+        herdstat::portage::DevawayXML loaded;
+        loaded.set_snapshot(snapshot);
+        loaded.parse(*i);
+
+        snapshot_report(*i++, snapshot,
+            snapshot_same_devs(parsed.devs(), loaded.devs()));
+    }
+
+    std::remove(snapshot.c_str());
+}
+
+#endif /* _HAVE__SNAPSHOT_TEST_HH */
+
+/* vim: set tw=80 sw=4 fdm=marker et : */
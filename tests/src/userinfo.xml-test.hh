@@ -59,6 +59,18 @@ UserinfoXMLTest::operator()(const opts_type& opts) const
     std::cout << "Status:     " << i->status() << std::endl;
     std::cout << "Roles:      " << i->role() << std::endl;
     std::cout << "Location:   " << i->location() << std::endl;
+
+    /* query mode only parses the given developer */
+    herdstat::portage::UserinfoXML query;
+    query.set_query(dev);
+    query.parse(path);
+    std::cout << "Query size: " << query.devs().size() << std::endl;
+
+    herdstat::portage::Developers::const_iterator q = query.devs().find(dev);
+    std::cout << "Query matches: " <<
+        (q != query.devs().end() and q->name() == i->name() and
+         q->role() == i->role() and q->location() == i->location() ?
+         "yes" : "no") << std::endl;
 }
 
 #endif /* _HAVE__USERINFO.XML_TEST_HH */